@@ -0,0 +1,106 @@
+import os
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+# Binary download of a logger file over USB CDC (see xfer.h)
+# usage: BaixaArquivo.py <port> <file on the SD> [local file]
+# An existing local file is treated as a partial download and resumed.
+port = sys.argv[1] if len(sys.argv) > 1 else '/dev/ttyACM0'
+remote = sys.argv[2] if len(sys.argv) > 2 else 'mpu_data.bin'
+local = sys.argv[3] if len(sys.argv) > 3 else os.path.basename(remote)
+
+SYNC = b'\xa5\x5a'
+FRAME_FORMAT = '<2sBBII'
+FRAME_SIZE = struct.calcsize(FRAME_FORMAT)
+MAX_FRAME_DATA = 64 * 1024
+MAX_RETRIES = 10
+
+
+class FrameError(Exception):
+    pass
+
+
+def read_exact(ser, n):
+    data = ser.read(n)
+    if len(data) != n:
+        raise FrameError('timeout')
+    return data
+
+
+def read_frame(ser):
+    """Scan for the sync bytes and return (type, offset, data) of a CRC-valid frame."""
+    window = b''
+    while window != SYNC:
+        b = ser.read(1)
+        if not b:
+            raise FrameError('timeout waiting for frame')
+        window = (window + b)[-2:]
+    rest = read_exact(ser, FRAME_SIZE - 2)
+    header = SYNC + rest
+    _, ftype, _, offset, length = struct.unpack(FRAME_FORMAT, header)
+    if length > MAX_FRAME_DATA:
+        raise FrameError(f'bad length {length}')
+    data = read_exact(ser, length)
+    crc, = struct.unpack('<I', read_exact(ser, 4))
+    if zlib.crc32(data, zlib.crc32(header)) != crc:
+        raise FrameError(f'CRC mismatch at offset {offset}')
+    return chr(ftype), offset, data
+
+
+def cancel(ser):
+    """Stop an ongoing transfer and discard whatever is still in flight."""
+    ser.write(b'\x18')
+    time.sleep(0.2)
+    while ser.read(4096):
+        pass
+
+
+def download(ser, out, offset):
+    """Transfer from offset to the end; returns the final offset."""
+    # Leading space: keeps the command's letters from acting as one-key shortcuts
+    ser.reset_input_buffer()
+    ser.write(f' xfer {remote} {offset}\r'.encode())
+    size = None
+    while True:
+        ftype, foffset, data = read_frame(ser)
+        if ftype == 'X':
+            code, = struct.unpack('<I', data)
+            sys.exit(f'device error: FRESULT {code}')
+        if ftype == 'S':
+            size, = struct.unpack('<I', data)
+            if foffset != offset:
+                raise FrameError('start offset mismatch')
+            total = size - offset
+            t0 = time.monotonic()
+        elif size is None:
+            continue
+        elif ftype == 'D':
+            if foffset != offset:
+                raise FrameError(f'expected offset {offset}, got {foffset}')
+            out.write(data)
+            offset += len(data)
+            rate = (offset - (size - total)) / max(time.monotonic() - t0, 1e-6)
+            print(f'\r{offset}/{size} bytes  {rate / 1024:.0f} KiB/s', end='', flush=True)
+        elif ftype == 'E':
+            print()
+            return offset
+
+
+with serial.Serial(port, timeout=2) as ser:
+    offset = os.path.getsize(local) if os.path.exists(local) else 0
+    with open(local, 'ab') as out:
+        for attempt in range(MAX_RETRIES):
+            try:
+                offset = download(ser, out, offset)
+                break
+            except FrameError as e:
+                print(f'\n{e}; resuming from {offset}')
+                cancel(ser)
+                out.flush()
+        else:
+            sys.exit('too many errors')
+    print(f'{local}: {offset} bytes')
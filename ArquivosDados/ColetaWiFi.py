@@ -0,0 +1,99 @@
+import socket
+import struct
+import sys
+import time
+
+# Collects the UDP sample stream of one or more loggers over Wi-Fi (see wifi.h)
+# usage: ColetaWiFi.py <unit IP> [<unit IP> ...]
+# Each unit is written to wifi_<unit id>.csv, in the same columns as PlotaDados.py.
+units = sys.argv[1:]
+if not units:
+    sys.exit('usage: ColetaWiFi.py <unit IP> [<unit IP> ...]')
+
+STREAM_PORT = 4243
+RESUBSCRIBE_S = 2.0
+REPORT_S = 5.0
+
+HEADER_FORMAT = '<4sBBHIII'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+SAMPLE_FORMAT = '<I7h'
+SAMPLE_SIZE = struct.calcsize(SAMPLE_FORMAT)
+
+# Same scales as mpu_log.h
+ACCEL_LSB_PER_G = 16384.0
+GYRO_LSB_PER_DPS = 131.0
+TEMP_LSB_PER_C = 340.0
+TEMP_OFFSET_C = 36.53
+
+
+class Unit:
+    def __init__(self, unit_id, rate_hz):
+        self.out = open(f'wifi_{unit_id:08x}.csv', 'w')
+        self.out.write('Sample,Time,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Temp\n')
+        self.rate_hz = rate_hz
+        self.next_seq = None
+        self.first_us = self.last_us = None
+        self.elapsed_s = 0.0
+        self.samples = self.lost = self.packets = 0
+
+    # The logger ends a packet at any gap in the sequence, so the samples
+    # of one packet are always first_seq, first_seq + 1, ...
+    def add(self, first_seq, body, count):
+        if self.next_seq is not None and first_seq != self.next_seq:
+            self.lost += (first_seq - self.next_seq) & 0xFFFFFFFF
+        self.next_seq = (first_seq + count) & 0xFFFFFFFF
+        self.packets += 1
+        for i in range(count):
+            t_us, ax, ay, az, gx, gy, gz, temp = struct.unpack_from(SAMPLE_FORMAT, body, i * SAMPLE_SIZE)
+            # time_us_32 wraps every ~71 minutes
+            if self.last_us is not None:
+                self.elapsed_s += ((t_us - self.last_us) & 0xFFFFFFFF) / 1e6
+            self.last_us = t_us
+            self.out.write(f'{first_seq + i},{self.elapsed_s:.6f},'
+                           f'{ax / ACCEL_LSB_PER_G:.4f},{ay / ACCEL_LSB_PER_G:.4f},{az / ACCEL_LSB_PER_G:.4f},'
+                           f'{gx / GYRO_LSB_PER_DPS:.3f},{gy / GYRO_LSB_PER_DPS:.3f},{gz / GYRO_LSB_PER_DPS:.3f},'
+                           f'{temp / TEMP_LSB_PER_C + TEMP_OFFSET_C:.2f}\n')
+        self.samples += count
+
+
+sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock.bind(('', 0))
+sock.settimeout(0.5)
+by_id = {}
+last_subscribe = last_report = 0.0
+
+try:
+    while True:
+        now = time.monotonic()
+        if now - last_subscribe >= RESUBSCRIBE_S:
+            for ip in units:
+                sock.sendto(b'subscribe', (ip, STREAM_PORT))
+            last_subscribe = now
+        if now - last_report >= REPORT_S:
+            for uid, u in by_id.items():
+                print(f'unit {uid:08x}: {u.samples} samples, {u.lost} lost, {u.packets} packets')
+            last_report = now
+        try:
+            data, addr = sock.recvfrom(2048)
+        except socket.timeout:
+            continue
+        if len(data) < HEADER_SIZE:
+            continue
+        magic, version, count, sample_size, unit_id, first_seq, rate_hz = struct.unpack_from(HEADER_FORMAT, data)
+        if magic != b'MPUW' or version != 1 or sample_size != SAMPLE_SIZE:
+            continue
+        body = data[HEADER_SIZE:]
+        if len(body) < count * SAMPLE_SIZE:
+            continue
+        if unit_id not in by_id:
+            by_id[unit_id] = Unit(unit_id, rate_hz)
+            print(f'unit {unit_id:08x} at {addr[0]}, {rate_hz} Hz')
+        by_id[unit_id].add(first_seq, body, count)
+except KeyboardInterrupt:
+    pass
+finally:
+    for ip in units:
+        sock.sendto(b'stop', (ip, STREAM_PORT))
+    for uid, u in by_id.items():
+        u.out.close()
+        print(f'unit {uid:08x}: {u.samples} samples, {u.lost} lost -> wifi_{uid:08x}.csv')
@@ -0,0 +1,170 @@
+import struct
+import sys
+import threading
+import time
+import zlib
+from collections import deque
+
+import numpy as np
+import matplotlib.pyplot as plt
+from matplotlib.animation import FuncAnimation
+import serial
+
+# Live plot of the telemetry stream ("stream on", see telemetry.h)
+# usage: PlotaAoVivo.py <port> [window seconds]
+port = sys.argv[1] if len(sys.argv) > 1 else '/dev/ttyACM0'
+window_s = float(sys.argv[2]) if len(sys.argv) > 2 else 10.0
+
+# Same scales and attitude filter as PlotaDados.py / mpu_log.h
+ACCEL_LSB_PER_G = 16384.0
+GYRO_LSB_PER_DPS = 131.0
+TEMP_LSB_PER_C = 340.0
+TEMP_OFFSET_C = 36.53
+ATT_TAU_S = 0.5
+ATT_MAX_GAP_S = 0.5
+
+SYNC = b'\xa5\x5a'
+FRAME_FORMAT = '<2sBBII'
+FRAME_SIZE = struct.calcsize(FRAME_FORMAT)
+PAYLOAD_FORMAT = '<I7h'
+PAYLOAD_SIZE = struct.calcsize(PAYLOAD_FORMAT)
+MAX_POINTS = 20000
+
+
+class Stream:
+    """Reads telemetry frames in a background thread and keeps the last window."""
+
+    def __init__(self, ser):
+        self.ser = ser
+        self.lock = threading.Lock()
+        self.t = deque(maxlen=MAX_POINTS)
+        self.accel = deque(maxlen=MAX_POINTS)
+        self.gyro = deque(maxlen=MAX_POINTS)
+        self.att = deque(maxlen=MAX_POINTS)
+        self.frames = self.lost = self.bad = 0
+        self.last_seq = None
+        self.t0_us = self.last_us = None
+        self.elapsed_s = 0.0
+        self.roll = self.pitch = 0.0
+        self.buf = bytearray()
+
+    def run(self):
+        self.ser.write(b' stream on\r')
+        while True:
+            self.buf += self.ser.read(max(1, self.ser.in_waiting))
+            self.parse()
+
+    def parse(self):
+        buf = self.buf
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                del buf[:-1]
+                return
+            del buf[:i]
+            if len(buf) < FRAME_SIZE:
+                return
+            _, ftype, _, seq, length = struct.unpack_from(FRAME_FORMAT, buf)
+            if ftype != ord('T') or length != PAYLOAD_SIZE:
+                del buf[:2]
+                continue
+            end = FRAME_SIZE + length + 4
+            if len(buf) < end:
+                return
+            crc, = struct.unpack_from('<I', buf, end - 4)
+            if zlib.crc32(bytes(buf[:end - 4])) != crc:
+                self.bad += 1
+                del buf[:2]
+                continue
+            self.add(seq, struct.unpack_from(PAYLOAD_FORMAT, buf, FRAME_SIZE))
+            del buf[:end]
+
+    def add(self, seq, fields):
+        t_us, raw = fields[0], np.array(fields[1:7], dtype=float)
+        if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFFFFFF:
+            self.lost += (seq - self.last_seq - 1) & 0xFFFFFFFF
+        self.last_seq = seq
+        self.frames += 1
+
+        # time_us_32 wraps every ~71 minutes
+        dt = 0.0 if self.last_us is None else ((t_us - self.last_us) & 0xFFFFFFFF) / 1e6
+        self.last_us = t_us
+        self.elapsed_s += dt
+        ax, ay, az = raw[:3] / ACCEL_LSB_PER_G
+        gx, gy, _ = raw[3:] / GYRO_LSB_PER_DPS
+
+        # Incremental form of complementary_filter() in PlotaDados.py
+        roll_acc = np.degrees(np.arctan2(ay, az))
+        pitch_acc = np.degrees(np.arctan2(-ax, np.sqrt(ay**2 + az**2)))
+        if dt <= 0 or dt > ATT_MAX_GAP_S:
+            self.roll, self.pitch = roll_acc, pitch_acc
+        else:
+            a = ATT_TAU_S / (ATT_TAU_S + dt)
+            self.roll += gx * dt
+            self.pitch += gy * dt
+            e = (roll_acc - self.roll + 180.0) % 360.0 - 180.0
+            self.roll = (self.roll + (1 - a) * e + 180.0) % 360.0 - 180.0
+            self.pitch += (1 - a) * (pitch_acc - self.pitch)
+
+        with self.lock:
+            self.t.append(self.elapsed_s)
+            self.accel.append(raw[:3] / ACCEL_LSB_PER_G)
+            self.gyro.append(raw[3:] / GYRO_LSB_PER_DPS)
+            self.att.append((self.roll, self.pitch))
+
+    def snapshot(self):
+        with self.lock:
+            if not self.t:
+                return None
+            t = np.array(self.t)
+            keep = t >= t[-1] - window_s
+            return t[keep], np.array(self.accel)[keep], np.array(self.gyro)[keep], np.array(self.att)[keep]
+
+
+ser = serial.Serial(port, timeout=0.1)
+stream = Stream(ser)
+threading.Thread(target=stream.run, daemon=True).start()
+
+fig, axes = plt.subplots(3, 1, figsize=(12, 9), sharex=True)
+fig.suptitle('MPU6050 Live Telemetry', fontsize=16, fontweight='bold')
+colors = 'rgb'
+accel_lines = [axes[0].plot([], [], c + '-', label=f'Accel{a}')[0] for c, a in zip(colors, 'XYZ')]
+gyro_lines = [axes[1].plot([], [], c + '-', label=f'Gyro{a}')[0] for c, a in zip(colors, 'XYZ')]
+att_lines = [axes[2].plot([], [], c + '-', label=n)[0] for c, n in zip('mc', ('Roll', 'Pitch'))]
+for ax, title in zip(axes, ('Acceleration (g)', 'Gyroscope (deg/s)', 'Attitude (deg)')):
+    ax.set_title(title)
+    ax.legend(loc='upper left')
+    ax.grid(True, alpha=0.3)
+axes[2].set_xlabel('Time (s)')
+status = fig.text(0.01, 0.01, '')
+last_report = [time.monotonic(), 0]
+
+
+def update(_):
+    snap = stream.snapshot()
+    if snap is None:
+        return []
+    t, accel, gyro, att = snap
+    for lines, data in ((accel_lines, accel), (gyro_lines, gyro), (att_lines, att)):
+        for i, line in enumerate(lines):
+            line.set_data(t, data[:, i])
+    for ax in axes:
+        ax.relim()
+        ax.autoscale_view()
+    axes[0].set_xlim(max(0.0, t[-1] - window_s), max(window_s, t[-1]))
+
+    now = time.monotonic()
+    rate = (stream.frames - last_report[1]) / max(now - last_report[0], 1e-6)
+    if now - last_report[0] >= 1.0:
+        last_report[:] = [now, stream.frames]
+        status.set_text(f'{rate:.0f} frames/s   lost {stream.lost}   CRC errors {stream.bad}')
+    return []
+
+
+anim = FuncAnimation(fig, update, interval=100, cache_frame_data=False)
+try:
+    plt.show()
+finally:
+    ser.write(b'\r stream off\r')
+    ser.close()
+    print(f'{stream.frames} frames, {stream.lost} lost, {stream.bad} CRC errors')
@@ -1,18 +1,295 @@
+import binascii
+import struct
+
 import numpy as np
 import matplotlib.pyplot as plt
 import pandas as pd
 
-# Load CSV file from microcontroller
-filename = 'mpu_data.csv'
+# Load data file from microcontroller (binary .bin, legacy .csv, or a
+# segmented capture's .idx index)
+filename = 'mpu_data.bin'
+# Time range to load from a segmented capture, in seconds (None = all)
+time_range = None
+# Striped capture (MPU_LOG_SECOND_SD=2): the file of the same name copied
+# from the second card
+stripe_file = None
+
+# Binary log format (see mpu_log.h): 64-byte header + 16-byte records, little-endian
+# Version 2 replaced half of the firmware string with start_unix_us
+HEADER_FORMAT = {1: '<4sBBBBIIIffff16sfIHBB', 2: '<4sBBBBIIIffff8sqfIHBB'}
+RECORD_DTYPE = np.dtype([('dt', '<u2'), ('accel', '<i2', 3), ('gyro', '<i2', 3), ('temp', '<i2')])
+DT_OVERFLOW = 0xFFFF
+FLAG_EVENT = 0x01
+FLAG_PACKED = 0x02
+FLAG_DUAL = 0x04
+FLAG_JOURNAL = 0x08
+# Journaled logs (see journal.h): the header fills sector 0, then 512-byte
+# sectors of a 16-byte header and up to 31 records
+SECTOR_SIZE = 512
+SECTOR_HEADER_FORMAT = '<4sIIHH'
+SECTOR_HEADER_SIZE = struct.calcsize(SECTOR_HEADER_FORMAT)
+
+
+def unpack_records(body, first_block):
+    """Expand delta/zigzag-varint blocks (see mpu_pack.h) back into 16-byte records."""
+    out = bytearray()
+    pos, size = 0, first_block
+    while pos + 4 <= len(body):
+        block = body[pos:pos + size]
+        count, used = struct.unpack_from('<HH', block)
+        if count == 0:
+            # Zero padding: extracted ranges restart on a block boundary
+            pos += size
+            size = 512
+            continue
+        prev = list(struct.unpack_from('<H7h', block, 4))
+        out += block[4:20]
+        i = 20
+        for _ in range(count - 1):
+            vals, n = [], 8
+            while len(vals) < n:
+                v = shift = 0
+                while True:
+                    b = block[i]
+                    i += 1
+                    v |= (b & 0x7F) << shift
+                    shift += 7
+                    if b < 0x80:
+                        break
+                if not vals:
+                    raw, v = v & 1, v >> 1
+                    if raw:
+                        n = 1
+                        fields = struct.unpack_from('<7h', block, i)
+                        i += 14
+                vals.append((v >> 1) ^ -(v & 1))
+            dt = (prev[0] + vals[0]) & 0xFFFF
+            if n == 1:
+                rec = [dt, *fields]
+            else:
+                rec = [dt] + [((p + d + 0x8000) & 0xFFFF) - 0x8000 for p, d in zip(prev[1:], vals[1:])]
+            out += struct.pack('<H7h', *rec)
+            prev = rec
+        if i != used:
+            raise ValueError(f"corrupt block at offset {pos}")
+        pos += size
+        size = 512
+    return bytes(out)
+
+
+ATT_MAX_GAP_S = 0.5
+
+
+def complementary_filter(dt_s, gyro_dps, roll_acc, pitch_acc, tau_s):
+    """Same fusion as attitude.c, so the plot matches the on-device attitude."""
+    roll = np.empty_like(roll_acc)
+    pitch = np.empty_like(pitch_acc)
+    r = p = 0.0
+    for i in range(len(roll_acc)):
+        dt = dt_s[i]
+        if i == 0 or dt <= 0 or dt > ATT_MAX_GAP_S:
+            r, p = roll_acc[i], pitch_acc[i]
+        else:
+            a = tau_s / (tau_s + dt)
+            r += gyro_dps[i, 0] * dt
+            p += gyro_dps[i, 1] * dt
+            e = (roll_acc[i] - r + 180.0) % 360.0 - 180.0
+            r = (r + (1 - a) * e + 180.0) % 360.0 - 180.0
+            p += (1 - a) * (pitch_acc[i] - p)
+        roll[i], pitch[i] = r, p
+    return roll, pitch
+
+
+def unjournal_records(body):
+    """Collect the records of consecutive valid journal sectors, stopping at the first invalid one."""
+    out = bytearray()
+    capture_id = seq = None
+    sectors = 0
+    for pos in range(0, len(body) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        sector = body[pos:pos + SECTOR_SIZE]
+        magic, cid, sseq, count, crc = struct.unpack_from(SECTOR_HEADER_FORMAT, sector)
+        if capture_id is None:
+            capture_id, seq = cid, sseq
+        # CRC16-CCITT of every byte except the crc field itself
+        if (magic != b'MPUJ' or cid != capture_id or sseq != seq or count > 31 or
+                binascii.crc_hqx(sector[:14] + sector[16:], 0) != crc):
+            break
+        out += sector[SECTOR_HEADER_SIZE:SECTOR_HEADER_SIZE + count * RECORD_DTYPE.itemsize]
+        seq += 1
+        sectors += 1
+    dropped = len(body) // SECTOR_SIZE - sectors
+    if dropped:
+        print(f"Journaled log: {sectors} valid sectors, {dropped} trailing sector(s) ignored")
+    return bytes(out)
+
+
+def join_stripes(first, second, chunk):
+    """Rebuild a striped log: even chunks come from the first card, odd ones from the second."""
+    out = bytearray()
+    for i in range(0, max(len(first), len(second) + chunk), chunk):
+        out += first[i:i + chunk] + second[i:i + chunk]
+    return bytes(out)
+
+
+def print_start(start_unix_us):
+    """Show the RTC time of Time = 0 (as set with setrtc; 0 = RTC not set)."""
+    import datetime
+    if start_unix_us:
+        start = datetime.datetime(1970, 1, 1) + datetime.timedelta(microseconds=int(start_unix_us))
+        print(f"Started at {start.isoformat(sep=' ', timespec='microseconds')} (RTC)")
+
+
+def report_timing(time_s, rate_hz=None):
+    """Flag samples that arrived late or were missed, from the recorded timestamps."""
+    dt = np.diff(np.asarray(time_s, dtype=float))
+    if not len(dt):
+        return
+    period = 1.0 / rate_hz if rate_hz else float(np.median(dt))
+    late = dt > 1.5 * period
+    if late.any():
+        missed = int(np.sum(np.round(dt[late & np.isfinite(dt)] / period) - 1))
+        print(f"WARNING: {int(late.sum())} gap(s) longer than 1.5 periods, ~{missed} sample(s) missing"
+              f" (worst {np.max(dt) * 1e3:.2f} ms)")
+    print(f"Interval: mean {np.mean(dt[np.isfinite(dt)]) * 1e6:.1f} us, jitter (std) {np.std(dt[np.isfinite(dt)]) * 1e6:.1f} us")
+
+
+def load_csv(path):
+    """Read a CSV log; the optional first line '# start_unix_us=...' anchors Time to the RTC."""
+    with open(path) as f:
+        first = f.readline()
+    start_unix_us = 0
+    if first.startswith('# start_unix_us='):
+        start_unix_us = int(first.split('=', 1)[1])
+    data = pd.read_csv(path, comment='#')
+    print_start(start_unix_us)
+    if 'Time' in data:
+        report_timing(data['Time'])
+        if start_unix_us:
+            data['UnixTime'] = start_unix_us / 1e6 + data['Time']
+    return data
+
+
+def load_binary(path):
+    """Decode a binary MPU log into the same columns as the CSV format."""
+    with open(path, 'rb') as f:
+        raw = f.read()
+
+    magic, version = struct.unpack_from('<4sB', raw)
+    if magic != b'MPUL':
+        raise ValueError(f"not an MPU log file (magic {magic!r})")
+    if version not in HEADER_FORMAT:
+        raise ValueError(f"unsupported log version {version}")
+    fields = list(struct.unpack_from(HEADER_FORMAT[version], raw))
+    if version == 1:
+        fields.insert(13, 0)        # No RTC anchor
+    (magic, version, header_size, record_size, flags, rate_hz, dt_unit_us,
+     _start_us, accel_scale, gyro_scale, temp_scale, temp_offset, firmware, start_unix_us, att_tau_s, pre_samples,
+     block_size, stripe_sectors, _) = fields
+    if record_size != RECORD_DTYPE.itemsize:
+        raise ValueError(f"unsupported log version {version} (record size {record_size})")
+    print(f"Binary log v{version}, firmware {firmware.rstrip(bytes(1)).decode()}, {rate_hz} Hz")
+    print_start(start_unix_us)
+    if flags & FLAG_EVENT:
+        print(f"Event capture: trigger at record {pre_samples}")
+
+    if stripe_sectors:
+        if not stripe_file:
+            raise ValueError("striped log: set stripe_file to the copy from the second card")
+        with open(stripe_file, 'rb') as f:
+            raw = join_stripes(raw, f.read(), stripe_sectors * 512)
+        print(f"Striped log: joined with {stripe_file}")
+
+    body = raw[header_size:]
+    if flags & FLAG_JOURNAL:
+        body = unjournal_records(raw[SECTOR_SIZE:])
+    if flags & FLAG_PACKED:
+        packed = len(body)
+        body = unpack_records(body, block_size - header_size)
+        print(f"Compressed log: {packed} bytes -> {len(body)} bytes")
+    count = len(body) // record_size
+    rec = np.frombuffer(body, dtype=RECORD_DTYPE, count=count)
+    # Two sensors: each sample is followed by the second sensor's record (dt = 0)
+    second = None
+    if flags & FLAG_DUAL:
+        count //= 2
+        rec, second = rec[0:2 * count:2], rec[1:2 * count:2]
+        print("Two sensors: second one read half a period after the first")
+
+    accel = rec['accel'] / accel_scale
+    gyro = rec['gyro'] / gyro_scale
+    ax, ay, az = accel[:, 0], accel[:, 1], accel[:, 2]
+    # Time from start_us: each record holds the delta since the previous one,
+    # stamped by the hardware timer when the sample was read
+    dt_s = rec['dt'].astype(np.int64) * dt_unit_us / 1e6
+    time_s = np.cumsum(dt_s)
+    gaps = int(np.count_nonzero(rec['dt'] == DT_OVERFLOW))
+    if gaps:
+        print(f"WARNING: {gaps} interval(s) longer than the dt field can hold; later times are a lower bound")
+        dt_s[rec['dt'] == DT_OVERFLOW] = np.inf
+    if not flags & FLAG_EVENT:
+        report_timing(time_s, rate_hz)
+
+    roll = np.degrees(np.arctan2(ay, az))
+    pitch = np.degrees(np.arctan2(-ax, np.sqrt(ay**2 + az**2)))
+    if att_tau_s > 0:
+        roll, pitch = complementary_filter(dt_s, gyro, roll, pitch, att_tau_s)
+
+    columns = {
+        'Sample': np.arange(count),
+        'Time': time_s - (time_s[0] if count else 0),
+        'AccelX': ax, 'AccelY': ay, 'AccelZ': az,
+        'GyroX': gyro[:, 0], 'GyroY': gyro[:, 1], 'GyroZ': gyro[:, 2],
+        'Temp': rec['temp'] / temp_scale + temp_offset,
+        'Roll': roll,
+        'Pitch': pitch,
+    }
+    if start_unix_us:
+        columns['UnixTime'] = start_unix_us / 1e6 + time_s
+    if second is not None:
+        for i, axis in enumerate('XYZ'):
+            columns[f'Accel2{axis}'] = second['accel'][:, i] / accel_scale
+            columns[f'Gyro2{axis}'] = second['gyro'][:, i] / gyro_scale
+        columns['Temp2'] = second['temp'] / temp_scale + temp_offset
+    return pd.DataFrame(columns)
+
+
+def load_segments(index_path, t_range=None):
+    """Load the segments listed in a capture index, optionally only those overlapping t_range."""
+    import os
+    index = pd.read_csv(index_path)
+    folder = os.path.dirname(index_path)
+    # start_us is time_us_32 and wraps every ~71 minutes
+    start_s = np.cumsum(np.diff(index['start_us'].astype(np.int64), prepend=index['start_us'][0]) % 2**32) / 1e6
+    end_s = np.append(start_s[1:], np.inf)
+    frames = []
+    for seg, name, t0, t1 in zip(index['segment'], index['file'], start_s, end_s):
+        if t_range and (t1 < t_range[0] or t0 > t_range[1]):
+            continue
+        path = os.path.join(folder, name)
+        part = load_binary(path) if name.endswith('.bin') else load_csv(path)
+        if 'Time' in part:
+            part['Time'] += t0
+        frames.append(part)
+        print(f"Segment {seg}: {name} at {t0:.1f} s")
+    data = pd.concat(frames, ignore_index=True)
+    if t_range and 'Time' in data:
+        data = data[(data['Time'] >= t_range[0]) & (data['Time'] <= t_range[1])].reset_index(drop=True)
+    return data
+
 
 try:
-    # Read CSV data
-    data = pd.read_csv(filename)
+    if filename.endswith('.idx'):
+        data = load_segments(filename, time_range)
+        time = data['Time'] if 'Time' in data else data.index * 0.1
+    elif filename.endswith('.bin'):
+        data = load_binary(filename)
+        time = data['Time']
+    else:
+        data = load_csv(filename)
+        # Files from before the Time column: 10 Hz, 0.1 s per sample
+        time = data['Time'] if 'Time' in data else data['Sample'] * 0.1
     print(f"Data loaded: {len(data)} samples")
     
-    # Calculate time (10Hz = 0.1s per sample)
-    time = data['Sample'] * 0.1
-    
     # Create 4 subplots
     fig, axes = plt.subplots(2, 2, figsize=(15, 10))
     fig.suptitle('MPU6050 Data Analysis', fontsize=16, fontweight='bold')
@@ -93,13 +370,13 @@ except FileNotFoundError:
 except KeyError as e:
     print(f"ERROR: Column not found: {e}")
     print("Check if CSV has correct header:")
-    print("Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch")
+    print("Sample,Time,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch")
     
 except Exception as e:
     print(f"ERROR: {e}")
 
 print("\nUSAGE INSTRUCTIONS:")
-print("1. On microcontroller: press 't' -> type 'mpu_data.csv'")
+print("1. Copy 'mpu_data.bin' from the SD card (or 'mpu_data.csv' for CSV builds)")
 print("2. Copy data between markers")
 print("3. Paste in text file and save as 'mpu_data.csv'")
 print("4. Run: python PlotaDados.py")
\ No newline at end of file
@@ -0,0 +1,84 @@
+import struct
+import sys
+
+import numpy as np
+import matplotlib.pyplot as plt
+
+# Spectral summary written by the logger (USE_SPECTRUM=1 or 2, see spectrum.h)
+filename = sys.argv[1] if len(sys.argv) > 1 else 'mpu_spec.bin'
+
+# 64-byte header + one record per window, little-endian
+HEADER_FORMAT = '<4sBBBBHHBBHIIff16s16s'
+AXES = 'XYZ'
+
+
+def load_spectrum(path):
+    """Decode a spectral summary file into per-window arrays."""
+    with open(path, 'rb') as f:
+        raw = f.read()
+
+    (magic, version, header_size, record_size, axis, fft_n, hop, bands, _window, _,
+     rate_hz, _start_us, unit_mg, unit_hz, firmware, _) = struct.unpack_from(HEADER_FORMAT, raw)
+    if magic != b'MPUS':
+        raise ValueError(f"not a spectrum file (magic {magic!r})")
+    dtype = np.dtype([('t_us', '<u4'), ('rms', '<u2'), ('peak', '<u2'), ('band', '<u2', bands)])
+    if version != 1 or record_size != dtype.itemsize:
+        raise ValueError(f"unsupported spectrum version {version} (record size {record_size})")
+    print(f"Spectrum v{version}, firmware {firmware.rstrip(bytes(1)).decode()}, "
+          f"{rate_hz} Hz, N={fft_n}, hop={hop}, axis {AXES[axis]}")
+
+    body = raw[header_size:]
+    rec = np.frombuffer(body, dtype=dtype, count=len(body) // record_size)
+
+    # Band edges: bins 1..N/2 split into equal-width bands
+    bin_hz = rate_hz / fft_n
+    width = fft_n // 2 // bands
+    edges = [(1 + b * width) * bin_hz for b in range(bands + 1)]
+
+    # t_us wraps every ~71 minutes
+    t = np.cumsum(np.diff(rec['t_us'].astype(np.int64), prepend=rec['t_us'][:1]) % 2**32) / 1e6
+    return {
+        'time': t,
+        'rms_mg': rec['rms'] * unit_mg,
+        'peak_hz': rec['peak'] * unit_hz,
+        'band_mg': rec['band'] * unit_mg,
+        'edges_hz': edges,
+        'axis': AXES[axis],
+    }
+
+
+try:
+    spec = load_spectrum(filename)
+    print(f"Windows loaded: {len(spec['time'])}")
+
+    fig, axes = plt.subplots(3, 1, figsize=(15, 12), sharex=True)
+    fig.suptitle(f"Vibration spectrum - accel {spec['axis']}", fontsize=16, fontweight='bold')
+
+    axes[0].plot(spec['time'], spec['rms_mg'], 'k-', linewidth=1.5)
+    axes[0].set_ylabel('RMS (mg)')
+    axes[0].grid(True, alpha=0.3)
+
+    axes[1].plot(spec['time'], spec['peak_hz'], 'r.', markersize=3)
+    axes[1].set_ylabel('Peak frequency (Hz)')
+    axes[1].grid(True, alpha=0.3)
+
+    # Each window spans from its start to the next window's start
+    t = spec['time']
+    step = t[-1] - t[-2] if len(t) > 1 else 1.0
+    mesh = axes[2].pcolormesh(np.append(t, t[-1] + step), spec['edges_hz'], spec['band_mg'].T,
+                              shading='flat', cmap='viridis')
+    fig.colorbar(mesh, ax=axes[2], label='Band RMS (mg)')
+    axes[2].set_ylabel('Frequency (Hz)')
+    axes[2].set_xlabel('Time (s)')
+
+    plt.tight_layout()
+    plt.savefig('mpu6050_spectrum.png', dpi=300, bbox_inches='tight')
+    print("Plot saved as: mpu6050_spectrum.png")
+    plt.show()
+
+except FileNotFoundError:
+    print(f"ERROR: File '{filename}' not found!")
+    print("Copy 'mpu_spec.bin' from the SD card to this folder or pass its path.")
+
+except Exception as e:
+    print(f"ERROR: {e}")
@@ -23,14 +23,152 @@
 #include "hardware/adc.h"
 #include "hardware/rtc.h"
 #include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "hardware/watchdog.h"
 #include "hardware/i2c.h"
 #include "pico/binary_info.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
 #include "math.h"
 
+// Pipeline dual-core: ncleo 1 grava no SD, ncleo 0 faz a aquisio
+#ifndef USE_DUAL_CORE
+#define USE_DUAL_CORE 1
+#endif
+
+#if USE_DUAL_CORE
+#include "pico/multicore.h"
+#endif
+
+// Formato do arquivo de dados: 1 = binrio (mpu_log.h), 0 = CSV legvel
+#ifndef MPU_LOG_BINARY
+#define MPU_LOG_BINARY 1
+#endif
+
+// Compresso sem perdas dos registros binrios em blocos de setor (mpu_pack.h)
+#ifndef MPU_LOG_COMPRESS
+#define MPU_LOG_COMPRESS 0
+#endif
+
+#if MPU_LOG_COMPRESS && !MPU_LOG_BINARY
+#error "MPU_LOG_COMPRESS requer MPU_LOG_BINARY"
+#endif
+
+// Captura em setores brutos: a extenso pr-alocada  gravada por uma nica
+// sesso CMD25, sem o FatFs; o tamanho e a FAT s so atualizados no fim
+#ifndef USE_RAW_SECTORS
+#define USE_RAW_SECTORS 0
+#endif
+
+// Aquisio pela FIFO interna do MPU6050 (requer o pino INT ligado a MPU_INT_PIN)
+// Com 0, o timer do Pico l o sensor a cada perodo
+#ifndef USE_MPU_FIFO
+#define USE_MPU_FIFO 0
+#endif
+
+// Envio do quadro ao display por DMA, sem bloquear o lao principal
+#ifndef USE_DISPLAY_DMA
+#define USE_DISPLAY_DMA 1
+#endif
+
+// Incio automtico: no boot monta o carto e inicia a captura assim que o
+// MPU6050 estiver pronto, sem esperar boto nem terminal. Se o carto no
+// montar, o boot segue com a interface e o estado de erro
+#ifndef AUTO_START
+#define AUTO_START 0
+#endif
+
+// Modo de baixo consumo para captura em bateria: clock reduzido, display
+// apagado e gravao em lotes, com estimativa de consumo ao final
+#ifndef USE_LOW_POWER
+#define USE_LOW_POWER 0
+#endif
+
+// Espectro de vibrao por janela (spectrum.h): 0 = desabilitado,
+// 1 = arquivo de espectro ao lado das amostras, 2 = s o espectro
+#ifndef USE_SPECTRUM
+#define USE_SPECTRUM 0
+#endif
+
+// Captura por evento (trigger.h): em vez do fluxo contnuo, grava apenas o
+// pr e o ps-gatilho de cada choque, cada evento em um arquivo evt_NNNN
+#ifndef USE_TRIGGER
+#define USE_TRIGGER 0
+#endif
+
+#if USE_TRIGGER && USE_SPECTRUM
+#error "USE_TRIGGER e USE_SPECTRUM so modos de gravao alternativos"
+#endif
+#if USE_SPECTRUM == 1 && USE_RAW_SECTORS
+#error "USE_SPECTRUM=1 grava um segundo arquivo pelo FatFs; incompatvel com USE_RAW_SECTORS"
+#endif
+
+// Segundo carto SD ("1:", mesmo SPI com outro CS; SD_SECOND_CARD=1 em
+// hw_config.c): 0 = no usa, 1 = espelho (cpia de cada bloco),
+// 2 = faixas (blocos alternados entre os cartes)
+#ifndef MPU_LOG_SECOND_SD
+#define MPU_LOG_SECOND_SD 0
+#endif
+
+#if MPU_LOG_SECOND_SD && USE_RAW_SECTORS
+#error "MPU_LOG_SECOND_SD grava pelo FatFs; incompatvel com USE_RAW_SECTORS"
+#endif
+
+// Registros binrios em setores com dirio (journal.h): o arquivo pr-alocado
+// s  sincronizado na abertura e, aps uma queda de energia, o tamanho 
+// recuperado ao montar o carto. Ativo por padro onde o formato permite
+#ifndef MPU_LOG_JOURNAL
+#define MPU_LOG_JOURNAL (MPU_LOG_BINARY && !MPU_LOG_COMPRESS && USE_SPECTRUM != 2 && MPU_LOG_SECOND_SD != 2)
+#endif
+
+#if MPU_LOG_JOURNAL && (!MPU_LOG_BINARY || MPU_LOG_COMPRESS || USE_SPECTRUM == 2)
+#error "MPU_LOG_JOURNAL requer registros binrios sem compresso"
+#endif
+#if MPU_LOG_JOURNAL && MPU_LOG_SECOND_SD == 2
+#error "MPU_LOG_JOURNAL no suporta faixas: cada carto teria s metade dos setores"
+#endif
+
+// Amostras ainda no gravadas preservadas em reset (crash.h): depois de um
+// reset do watchdog ou de uma falha durante a captura, o boot completa o
+// arquivo com o que ficou no buffer de aquisio. O watchdog fica ativo s
+// durante a captura. Requer o dirio, que diz quantos registros chegaram ao
+// carto; capturas por evento gravam a partir do buffer do gatilho
+#ifndef USE_CRASH_BUFFER
+#define USE_CRASH_BUFFER (MPU_LOG_JOURNAL && !USE_TRIGGER && ACQ_RETAIN_RING)
+#endif
+
+#if ACQ_SECOND_MPU && USE_MPU_FIFO
+#error "ACQ_SECOND_MPU requer a aquisio por timer"
+#endif
+#if ACQ_SECOND_MPU && MPU_LOG_COMPRESS
+#error "MPU_LOG_COMPRESS no suporta os registros do segundo sensor"
+#endif
+
 // Bibliotecas especficas do projeto
 #include "ssd1306.h"      // Driver do display OLED
 #include "font.h"         // Fontes para o display
 #include "MPU6050.h"      // Driver do sensor MPU6050
+#include "acquisition.h"  // Amostragem peridica do MPU6050
+#include "indicators.h"   // Bipes e LEDs sem bloqueio
+#include "events.h"       // Fila de eventos do lao principal
+#include "mpu_log.h"      // Formato binrio do arquivo de dados
+#include "mpu_pack.h"     // Compresso diferencial dos registros
+#include "log_index.h"    // ndice esparso e extrao por intervalo de tempo
+#include "xfer.h"         // Transferncia binria de arquivos pela USB
+#include "usb_msc.h"      // Carto SD como disco USB
+#include "telemetry.h"    // Amostras ao vivo pela USB
+#include "wifi.h"         // Terminal remoto e amostras por Wi-Fi (Pico W)
+#include "log_writer.h"   // Gravao em blocos alinhados a setores
+#include "lowpower.h"     // Clock reduzido e estimativa de consumo
+#include "attitude.h"     // Filtro complementar de roll/pitch
+#include "spectrum.h"     // FFT em janelas e resumo espectral
+#include "trigger.h"      // Captura disparada por limiar
+#include "prof.h"         // Cronmetros dos caminhos crticos (comando stats)
+#include "bench.h"        // Vazo e latncia do carto SD (comando bench)
+#include "journal.h"      // Setores com dirio e recuperao aps queda de energia
+#include "crash.h"        // Amostras preservadas em reset do watchdog
+#include "config.h"       // config.ini do carto
+#include "console.h"      // Terminal USB com buffer, sem bloqueio
 
 // Bibliotecas para SD Card (FatFS)
 #include "ff.h"
@@ -40,6 +178,12 @@
 #include "my_debug.h"
 #include "rtc.h"
 #include "sd_card.h"
+#include "sd_spi.h"
+
+// ACQ_RETAIN_RING vem de acquisition.h
+#if USE_CRASH_BUFFER && (!MPU_LOG_JOURNAL || USE_TRIGGER || !ACQ_RETAIN_RING)
+#error "USE_CRASH_BUFFER requer MPU_LOG_JOURNAL e ACQ_RETAIN_RING, sem USE_TRIGGER"
+#endif
 
 // ================================================================================
 // DEFINIES DE HARDWARE - MAPEAMENTO DOS PINOS
@@ -65,21 +209,88 @@
 #define buzzer 21                     // Buzzer para sinais sonoros
 #define botaoA 5                      // Boto A - controle de captura
 #define botaoB 6                      // Boto B - controle de SD
+#define MPU_INT_PIN 7                 // Pino INT do MPU6050 (dado pronto)
 
 // ================================================================================
 // CONSTANTES E CONFIGURAES DO SISTEMA
 // ================================================================================
 
-// Configuraes do MPU6050
-static int addr = 0x68;               // Endereo padro do MPU6050
-
-// Configuraes de logging do MPU6050
-static const uint32_t mpu_log_period = 100;  // 100ms = 10Hz
-static char mpu_filename[20] = "mpu_data2.csv"; // Nome do arquivo CSV
+// Sensores no barramento I2C0: o segundo, com AD0 em nvel alto, s 
+// procurado com ACQ_SECOND_MPU
+static mpu6050_t mpu = {
+    .port = I2C_PORT, .addr = MPU6050_ADDR,
+    .accel_range = MPU_LOG_ACCEL_RANGE, .gyro_range = MPU_LOG_GYRO_RANGE,
+};
+#if ACQ_SECOND_MPU
+static mpu6050_t mpu2 = {
+    .port = I2C_PORT, .addr = MPU6050_ADDR_ALT,
+    .accel_range = MPU_LOG_ACCEL_RANGE, .gyro_range = MPU_LOG_GYRO_RANGE,
+};
+static bool mpu2_presente = false;            // Segundo sensor respondeu no reset
+#endif
+
+// Configuraes de logging do MPU6050 (valores padro; o config.ini do
+// carto, lido ao montar, pode alterar taxa, filtro, faixas, nome do
+// arquivo, pr-alocao, segmentos e intervalo de f_sync)
+static uint32_t mpu_sample_rate_hz = 10;      // Taxa de amostragem (at 1 kHz)
+#if USE_SPECTRUM == 2
+static char mpu_filename[32] = "mpu_spec.bin";  // S o resumo espectral
+#elif MPU_LOG_BINARY
+static char mpu_filename[32] = "mpu_data.bin";  // Nome do arquivo binrio
+#else
+static char mpu_filename[32] = "mpu_data2.csv"; // Nome do arquivo CSV
+#endif
+
+// Espera no boot pelo terminal, s com um computador na USB: at usb_enum_ms
+// para o computador enumerar o dispositivo e at boot_wait_ms para abrir a
+// porta serial. Sem VBUS (bateria) o boot no espera
+#if !AUTO_START
+static const uint32_t usb_enum_ms = 1000;
+static const uint32_t boot_wait_ms = 5000;
+#endif
+
+// Pr-alocao contgua do arquivo (f_expand): durao mxima prevista da
+// captura, em segundos. O arquivo  truncado ao tamanho real no fim. 0 = desabilita
+static uint32_t mpu_prealloc_s = 600;
+
+// Apaga a extenso pr-alocada (CMD38) antes da primeira amostra: o carto
+// grava nela sem copiar dados antigos das AUs, e setores no gravados leem
+// como apagados (invlidos para o dirio)
+#ifndef MPU_LOG_PREERASE
+#define MPU_LOG_PREERASE 1
+#endif
+
+// Intervalo de f_sync durante a captura (0 = s no fim); dispensado com
+// setores brutos ou com o dirio
+static uint32_t mpu_sync_s = USE_LOW_POWER ? 60 : 5;
+
+// Segmentao da captura contnua: novo arquivo, nomeado pelo RTC, a cada
+// intervalo ou tamanho (0 = critrio desabilitado), com um ndice por captura
+// (.idx) listando a primeira amostra e o instante de cada segmento
+#define MPU_SEGMENTS (!USE_TRIGGER && USE_SPECTRUM != 1)
+
+// ndice esparso (.six) de cada arquivo de amostras, para o comando extract
+#define MPU_SEEK_INDEX (USE_SPECTRUM != 2)
+#if MPU_SEGMENTS
+static uint32_t mpu_segment_s = 600;          // Durao mxima de um segmento
+static uint32_t mpu_segment_mb = 64;          // Tamanho mximo de um segmento
+#endif
+
+#if USE_TRIGGER
+// Captura por evento
+static const uint32_t trg_pre_ms = 200;       // Gravado antes do disparo
+static const uint32_t trg_post_ms = 800;      // Gravado aps o ltimo disparo
+static const uint32_t trg_max_ms = 10000;     // Durao mxima de um evento
+static const float trg_accel_g = 0.5f;        // Desvio de |a| em relao a 1 g
+static const float trg_gyro_dps = 150.0f;     // Velocidade angular em qualquer eixo
+#endif
 
 // Configuraes gerais de logging
 static const uint32_t period = 1000;  // Perodo geral de 1 segundo
 
+// Perodo de atualizao do display (independente da amostragem)
+static const uint32_t ui_period_ms = 500;
+
 // ================================================================================
 // VARIVEIS GLOBAIS - CONTROLE DE ESTADO DO SISTEMA
 // ================================================================================
@@ -97,15 +308,82 @@ bool Estado_led_vermelho = false;
 bool Estado_coleta_dados = false;     // Flag de coleta de dados ativa
 bool Estado_montar_cartao = false;   // Flag de carto SD montado
 
-// Estados anteriores para deteco de mudanas
-bool Estado_coleta_dados_prev = false;
-bool Estado_montar_cartao_prev = false;
-
 // Variveis de controle do logging MPU6050
-static bool mpu_logging_enabled = false;      // Flag de logging ativo
-static absolute_time_t next_mpu_log_time;     // Prximo tempo de log
-static FIL mpu_file;                          // Handle do arquivo CSV
+static volatile bool mpu_logging_enabled = false; // Flag de logging ativo
+static FIL mpu_file;                          // Handle do arquivo de dados
+#if MPU_SEGMENTS
+static char mpu_ext[4];                       // Extenso dos segmentos (do nome padro)
+static char mpu_index_filename[32];           // ndice da captura atual
+static uint32_t segment_num = 0;              // Segmento em gravao (1, 2, ...)
+static uint32_t segment_first_sample = 0;     // Primeira amostra do segmento
+#endif
+#if MPU_LOG_COMPRESS
+static mpu_pack_t mpu_pack;                   // Bloco comprimido em montagem
+#endif
+#if MPU_SEEK_INDEX
+static lidx_t mpu_index;                      // Pontos de reincio do arquivo atual
+#endif
+#if USE_TRIGGER
+static trg_t gatilho;                         // Pr-gatilho e estatsticas contnuas
+static bool evento_aberto = false;            // Arquivo de evento em gravao
+static uint32_t evento_num = 0;               // Nmero do prximo arquivo de evento
+static uint32_t evento_pre = 0;               // Amostras de pr-gatilho do evento atual
+static volatile uint32_t eventos_gravados = 0;// Eventos disparados (alerta no ncleo 0)
+#endif
+#if USE_SPECTRUM
+static spec_t espectro;                       // Janela e rea de trabalho da FFT
+#endif
+#if USE_SPECTRUM == 1
+static const char spec_filename[] = "mpu_spec.bin";
+static FIL spec_file;
+static log_writer_t spec_writer;
+#endif
+static log_writer_t mpu_writer;               // Buffers de setores do arquivo
+#if MPU_LOG_SECOND_SD
+static FIL mpu_file2;                         // Mesmo arquivo no segundo carto
+static bool mpu_file2_aberto = false;
+#endif
+static bool mpu_file_prealloc = false;        // Arquivo pr-alocado com f_expand
+static bool mpu_file_raw = false;             // Extenso gravada em setores brutos
+static bool mpu_file_journaled = false;       // Dirio com a extenso j no diretrio (sem f_sync peridico)
+#if MPU_LOG_JOURNAL
+static jrnl_t mpu_jrnl;                       // Setor do dirio em montagem
+#endif
+#if USE_CRASH_BUFFER
+static mpu_log_header_t mpu_header;           // Cabealho do arquivo, para refaz-lo aps um reset
+// Sem alimentar o watchdog por este tempo durante a captura, o Pico reinicia
+// (mximo ~8,3 s). No baixo consumo o consumidor dorme por vrios segundos
+static const uint32_t capture_watchdog_ms = USE_LOW_POWER ? 0 : 8000;
+#endif
 static uint32_t sample_counter = 0;           // Contador de amostras
+#if !MPU_LOG_BINARY
+static mpu_log_scale_t csv_escala;            // LSB -> unidades do CSV, pela faixa de cada sensor
+#if ACQ_SECOND_MPU
+static mpu_log_scale_t csv_escala2;
+#endif
+static mpu_log_clock_t csv_relogio;          // Coluna Time: instante das amostras desde o incio do arquivo
+#endif
+// Hora do RTC (s desde 1970) menos time_us_64, medida na virada de um
+// segundo do RTC; 0 = sem setrtc desde a partida (um RTC que sobreviveu ao
+// reset pode estar parado ou atrasado). O RTC e o temporizador vm do mesmo
+// cristal, ento a diferena no deriva durante a captura
+static int64_t rtc_ancora_us = 0;
+static attitude_t atitude;                    // Roll/pitch filtrados, atualizados a cada amostra
+static uint32_t sync_interval = 50;           // Amostras entre f_sync (~5 s)
+
+// Amostras acumuladas antes de acordar o consumidor: no baixo consumo, cerca
+// de um buffer do gravador, para o SD ser acessado em rajadas
+#define LOTE_GRAVACAO (USE_LOW_POWER ? LOG_WRITER_BUF_SIZE / sizeof(mpu_log_record_t) : 1)
+_Static_assert(LOTE_GRAVACAO < ACQ_RING_SIZE / 2, "lote maior que meio buffer de aquisio");
+
+#if USE_LOW_POWER
+static lp_meter_t lp_meter;                   // Janela de medio do consumo
+#endif
+#if MPU_LOG_BINARY
+static uint32_t log_last_us;                  // Referncia do dt do prximo registro
+static uint32_t log_dt_unit_us;               // Resoluo do dt (do cabealho)
+#endif
+static uint32_t last_overruns = 0;            // Descartes j informados
 
 // Variveis de controle geral
 static bool logger_enabled;
@@ -125,7 +403,8 @@ typedef enum {
     Som_iniciando_captura,  // 1 bipe longo - incio da captura
     Som_encerrando_captura, // 2 bipes (curto + longo) - fim da captura
     som_leitura,           // 3 bipes curtos - leitura de dados
-    Som_erro               // 3 bipes longos - erro no sistema
+    Som_erro,              // 3 bipes longos - erro no sistema
+    Som_evento             // 1 bipe curto - evento disparado na captura por limiar
 } Evento_buzzer;
 
 // ================================================================================
@@ -177,13 +456,108 @@ static FATFS *sd_get_fs_by_name(const char *name)
     return NULL;
 }
 
+/**
+ * Verifica se o carto SD est reservado para o gravador do ncleo 1
+ * O FatFs  reentrante (FF_FS_REENTRANT), mas montagem, formatao e os
+ * comandos que alocam ou varrem o carto inteiro seguem bloqueados durante a
+ * captura: seguram o volume por tempo demais para o gravador
+ * @return true se o comando deve ser recusado
+ */
+static bool sd_reservado_para_gravador()
+{
+    if (msc_is_active()) {
+        printf("[ERRO] Carto SD exportado pela USB. Use 'msc off' ou ejete o disco.\n");
+        return true;
+    }
+#if USE_DUAL_CORE
+    if (mpu_logging_enabled) {
+        printf("[ERRO] Carto SD em uso pela captura. Pare a captura ('i') primeiro.\n");
+        return true;
+    }
+#endif
+    return false;
+}
+
+/**
+ * Verifica se a captura grava em setores brutos (USE_RAW_SECTORS)
+ * O gravador mantm uma sesso CMD25 aberta no carto; qualquer leitura pelo
+ * FatFs encerra a sesso e o prximo bloco da captura falha (FR_DISK_ERR).
+ * Vale para a captura inteira, inclusive entre segmentos
+ * @return true se o comando deve ser recusado
+ */
+static bool sd_reservado_setores_brutos()
+{
+#if USE_DUAL_CORE && USE_RAW_SECTORS
+    if (mpu_logging_enabled) {
+        printf("[ERRO] Captura em setores brutos: o carto fica com o gravador. Pare a captura ('i') primeiro.\n");
+        return true;
+    }
+#endif
+    return false;
+}
+
+/**
+ * Verifica se o carto SD est disponvel para leitura de arquivos
+ * Durante a captura o ncleo 0 l pelo FatFs enquanto o ncleo 1 grava: o
+ * volume fica travado s durante cada f_read, e o arquivo em gravao 
+ * recusado pelo FatFs (FR_LOCKED). Capturas em setores brutos seguem
+ * recusando as leituras
+ * @return true se o comando deve ser recusado
+ */
+static bool sd_reservado_para_leitura()
+{
+#if FF_FS_REENTRANT
+    if (msc_is_active()) {
+        printf("[ERRO] Carto SD exportado pela USB. Use 'msc off' ou ejete o disco.\n");
+        return true;
+    }
+    return sd_reservado_setores_brutos();
+#else
+    return sd_reservado_para_gravador();
+#endif
+}
+
 // ================================================================================
 // FUNES DE COMANDO - INTERFACE DO TERMINAL
 // ================================================================================
 
+/**
+ * Mede rtc_ancora_us: espera a prxima virada de segundo do RTC (at 1 s) e
+ * a associa ao time_us_64 do mesmo instante, com a resoluo da leitura do
+ * RTC (dezenas de s) em vez de 1 s
+ */
+static void rtc_ancorar()
+{
+    datetime_t dt;
+    rtc_ancora_us = 0;
+    if (!rtc_get_datetime(&dt) || dt.year < 2000)
+        return;
+    time_t s0 = time(NULL), s;
+    absolute_time_t limite = make_timeout_time_ms(1100);
+    while ((s = time(NULL)) == s0)
+    {
+        if (time_reached(limite))
+            return;         // RTC parado
+    }
+    rtc_ancora_us = (int64_t)s * 1000000 - (int64_t)time_us_64();
+}
+
+/**
+ * Hora do RTC de um instante recente de time_us_32 (amostras), em s desde
+ * 1970; 0 sem o RTC ajustado
+ */
+static int64_t rtc_unix_us(uint32_t t_us)
+{
+    if (!rtc_ancora_us)
+        return 0;
+    uint64_t agora = time_us_64();
+    return rtc_ancora_us + (int64_t)(agora - (uint32_t)((uint32_t)agora - t_us));
+}
+
 /**
  * Configura o RTC (Real Time Clock) do sistema
  * Formato: setrtc DD MM YY hh mm ss
+ * Tambm ancora o tempo das amostras na hora do RTC (start_unix_us)
  */
 static void run_setrtc()
 {
@@ -248,13 +622,22 @@ static void run_setrtc()
     
     // Aplica a configurao no RTC
     rtc_set_datetime(&t);
+    rtc_ancorar();
 }
 
 /**
  * Formata o carto SD com sistema de arquivos FAT
+ * rea de dados e clusters alinhados  unidade de alocao (AU) do carto,
+ * lida do registrador de estado (ACMD13): cada AU guarda clusters inteiros e
+ * a gravao sequencial ocupa AUs completas, sem coleta de lixo no carto.
+ * Clusters de 32 KiB em FAT32 e 128 KiB em exFAT (a partir de 32 GiB), como
+ * o formatador da SD Association, limitados a uma AU. Com FF_USE_TRIM o
+ * f_mkfs apaga o carto inteiro antes de gravar a FAT
  */
 static void run_format()
 {
+    if (sd_reservado_para_gravador())
+        return;
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -266,17 +649,140 @@ static void run_format()
         return;
     }
     
-    /* Formata o drive com parmetros padro */
-    FRESULT fr = f_mkfs(arg1, 0, 0, FF_MAX_SS * 2);
+    sd_card_t *pSD = sd_get_by_name(arg1);
+    myASSERT(pSD);
+    if (pSD->init(pSD) & STA_NOINIT)
+    {
+        printf("[ERRO] Carto SD no inicializado\n");
+        Estado = 'E';
+        return;
+    }
+    MKFS_PARM opt = {FM_ANY, 0, 0, 0, 0};
+    DWORD au_bytes = pSD->au_sectors * FF_MIN_SS;
+    opt.au_size = pSD->sectors >= 0x4000000 ? 128 * 1024 : 32 * 1024;
+    if (au_bytes && opt.au_size > au_bytes)
+        opt.au_size = au_bytes;
+    if (pSD->au_sectors)
+        printf("AU do carto: %lu KiB; clusters de %lu KiB\n",
+               (unsigned long)(au_bytes / 1024), (unsigned long)(opt.au_size / 1024));
+    else
+        printf("[AVISO] Carto no informa a AU; formatando com alinhamento padro\n");
+
+    FRESULT fr = f_mkfs(arg1, &opt, 0, FF_MAX_SS * 2);
+    if (FR_MKFS_ABORTED == fr)
+    {
+        // Carto pequeno demais para o cluster escolhido: tamanho automtico
+        opt.au_size = 0;
+        fr = f_mkfs(arg1, &opt, 0, FF_MAX_SS * 2);
+    }
     if (FR_OK != fr)
         printf("f_mkfs error: %s (%d)\n", FRESULT_str(fr), fr);
 }
 
+#if !USE_DUAL_CORE
+static void on_samples_ready(void);
+#endif
+
+/**
+ * Inicia a amostragem na taxa configurada, pela FIFO do sensor ou pelo timer
+ */
+static bool start_acquisition() {
+#if USE_WIFI
+    wifi_set_sample_rate(mpu_sample_rate_hz);
+#endif
+#if !USE_DUAL_CORE
+    // O lao principal consome as amostras: acorda a cada ~50 ms de dados
+    acq_set_ready_callback(on_samples_ready, USE_LOW_POWER ? ACQ_RING_SIZE / 2 : mpu_sample_rate_hz / 20);
+#endif
+#if USE_MPU_FIFO
+    return acq_start_fifo(mpu_sample_rate_hz);
+#else
+    return acq_start(mpu_sample_rate_hz);
+#endif
+}
+
+/**
+ * L o config.ini do carto recm-montado e aplica o que mudou
+ * Taxa, filtro e faixas reiniciam a aquisio (e o reset dos sensores); o
+ * formato do arquivo  escolhido na compilao e apenas conferido
+ * @param drive Unidade do carto (ex.: "0:")
+ */
+static void load_config(const char *drive) {
+    cfg_t atual = {
+        .sample_rate_hz = mpu_sample_rate_hz,
+        .dlpf = mpu.dlpf,
+        .accel_range = mpu.accel_range,
+        .gyro_range = mpu.gyro_range,
+        .format = MPU_LOG_COMPRESS ? CFG_FORMAT_COMPRESSED : MPU_LOG_BINARY ? CFG_FORMAT_BINARY : CFG_FORMAT_CSV,
+        .sync_s = mpu_sync_s,
+        .prealloc_s = mpu_prealloc_s,
+#if MPU_SEGMENTS
+        .segment_s = mpu_segment_s,
+        .segment_mb = mpu_segment_mb,
+#endif
+    };
+    snprintf(atual.filename, sizeof atual.filename, "%s", mpu_filename);
+
+    char path[16];
+    snprintf(path, sizeof path, "%s%s", drive, CFG_FILE);
+    cfg_t cfg = atual;
+    FRESULT fr = cfg_load(path, &cfg);
+    if (fr == FR_NO_FILE)
+        return;                 // Sem arquivo: valores da compilao
+    if (fr != FR_OK) {
+        printf("[AVISO] No foi possvel ler %s (%s)\n", path, FRESULT_str(fr));
+        return;
+    }
+
+    if (cfg.format != atual.format) {
+        printf("[AVISO] %s: o formato do arquivo  escolhido na compilao (MPU_LOG_BINARY, MPU_LOG_COMPRESS); mantido o atual\n", path);
+        cfg.format = atual.format;
+    }
+    mpu_sync_s = cfg.sync_s;
+    mpu_prealloc_s = cfg.prealloc_s;
+#if MPU_SEGMENTS
+    mpu_segment_s = cfg.segment_s;
+    mpu_segment_mb = cfg.segment_mb;
+    if (strcmp(cfg.filename, mpu_filename))
+        mpu_ext[0] = '\0';     // Segmentos herdam a nova extenso
+#endif
+    snprintf(mpu_filename, sizeof mpu_filename, "%s", cfg.filename);
+
+    bool sensor = cfg.dlpf != atual.dlpf || cfg.accel_range != atual.accel_range ||
+                  cfg.gyro_range != atual.gyro_range;
+    if (sensor || cfg.sample_rate_hz != atual.sample_rate_hz) {
+        acq_stop();
+        if (sensor) {
+            mpu.dlpf = cfg.dlpf;
+            mpu.accel_range = cfg.accel_range;
+            mpu.gyro_range = cfg.gyro_range;
+            mpu6050_reset(&mpu);
+            atitude.gyro_lsb_per_dps = mpu.gyro_lsb_per_dps;
+#if ACQ_SECOND_MPU
+            mpu2.dlpf = cfg.dlpf;
+            mpu2.accel_range = cfg.accel_range;
+            mpu2.gyro_range = cfg.gyro_range;
+            if (mpu2_presente)
+                mpu6050_reset(&mpu2);
+#endif
+        }
+        mpu_sample_rate_hz = cfg.sample_rate_hz;
+        if (!start_acquisition()) {
+            printf("[ERRO] No foi possvel reiniciar a aquisio a %lu Hz\n", mpu_sample_rate_hz);
+            Estado = 'E';
+        }
+    }
+    printf("Configurao lida de %s:\n", path);
+    cfg_print(&cfg);
+}
+
 /**
  * Monta o carto SD no sistema de arquivos
  */
 static void run_mount()
 {
+    if (sd_reservado_para_gravador())
+        return;
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -302,6 +808,28 @@ static void run_mount()
     myASSERT(pSD);
     pSD->mounted = true;
     printf("Processo de montagem do SD ( %s ) concludo\n", pSD->pcName);
+    printf("Clock SPI negociado: %u kHz\n", sd_get_baud_rate(pSD) / 1000);
+
+    // Capturas interrompidas por queda de energia voltam ao tamanho gravado
+    fr = jrnl_recover_dir(pSD->pcName);
+    if (FR_OK != fr)
+        printf("[AVISO] Verificao de capturas interrompidas: %s\n", FRESULT_str(fr));
+
+    // Contagem de clusters livres ainda sem captura: com a FSINFO vlida 
+    // imediata; sem ela (carto desligado sem desmontar) a FAT  varrida uma
+    // vez aqui, e no no meio de uma captura. Depois o FatFs a mantm a cada
+    // alocao e a grava de volta na FSINFO no f_sync
+    DWORD livres;
+    FATFS *fs;
+    uint32_t t0 = time_us_32();
+    fr = f_getfree(pSD->pcName, &livres, &fs);
+    if (FR_OK == fr)
+        printf("Espao livre: %llu KiB (%lu ms)\n", (unsigned long long)livres * fs->csize / 2,
+               (unsigned long)((time_us_32() - t0) / 1000));
+    else
+        printf("[AVISO] f_getfree: %s\n", FRESULT_str(fr));
+
+    load_config(pSD->pcName);
 }
 
 /**
@@ -309,6 +837,8 @@ static void run_mount()
  */
 static void run_unmount()
 {
+    if (sd_reservado_para_gravador())
+        return;
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = sd_get_by_num(0)->pcName;
@@ -338,6 +868,10 @@ static void run_unmount()
 
 /**
  * Obtm informaes de espao livre no carto SD
+ * Usa a contagem de clusters livres que o FatFs mantm em RAM (lida da
+ * FSINFO ou contada na montagem e atualizada a cada alocao): no l o
+ * carto e funciona tambm durante a captura. f_getfree s varre a FAT se
+ * a contagem ainda no for conhecida.
  */
 static void run_getfree()
 {
@@ -353,12 +887,18 @@ static void run_getfree()
         return;
     }
     
-    FRESULT fr = f_getfree(arg1, &fre_clust, &p_fs);
-    if (FR_OK != fr)
+    fre_clust = p_fs->free_clst;
+    if (!p_fs->fs_type || fre_clust > p_fs->n_fatent - 2)
     {
-        printf("f_getfree error: %s (%d)\n", FRESULT_str(fr), fr);
-        Estado = 'E';  // Define estado de erro
-        return;
+        if (sd_reservado_para_gravador())
+            return;
+        FRESULT fr = f_getfree(arg1, &fre_clust, &p_fs);
+        if (FR_OK != fr)
+        {
+            printf("f_getfree error: %s (%d)\n", FRESULT_str(fr), fr);
+            Estado = 'E';  // Define estado de erro
+            return;
+        }
     }
     
     // Calcula espao total e livre
@@ -369,25 +909,40 @@ static void run_getfree()
 
 /**
  * Lista arquivos e diretrios no carto SD
+ * A listagem sai em pginas, tambm durante a captura (lidas pelo ncleo 1
+ * sem pausar a gravao); qualquer tecla a interrompe
  */
+static void ls_start(const char *dir);
+
 static void run_ls()
 {
+    if (msc_is_active()) {
+        printf("[ERRO] Carto SD exportado pela USB. Use 'msc off' ou ejete o disco.\n");
+        return;
+    }
+    if (sd_reservado_setores_brutos())
+        return;
     const char *arg1 = strtok(NULL, " ");
     if (!arg1)
         arg1 = "";
     
     char cwdbuf[FF_LFN_BUF] = {0};
-    FRESULT fr;
     char const *p_dir;
     
     if (arg1[0])
     {
         p_dir = arg1;
     }
+#if USE_DUAL_CORE && !FF_FS_REENTRANT
+    else if (mpu_logging_enabled)
+    {
+        p_dir = "";     // f_getcwd l o carto: o ncleo 1 abre o diretrio atual
+    }
+#endif
     else
     {
         // Obtm diretrio atual se no especificado
-        fr = f_getcwd(cwdbuf, sizeof cwdbuf);
+        FRESULT fr = f_getcwd(cwdbuf, sizeof cwdbuf);
         if (FR_OK != fr)
         {
             printf("f_getcwd error: %s (%d)\n", FRESULT_str(fr), fr);
@@ -398,40 +953,7 @@ static void run_ls()
     }
     
     printf("Directory Listing: %s\n", p_dir);
-    DIR dj;
-    FILINFO fno;
-    memset(&dj, 0, sizeof dj);
-    memset(&fno, 0, sizeof fno);
-    
-    // Busca primeiro arquivo/diretrio
-    fr = f_findfirst(&dj, &fno, p_dir, "*");
-    if (FR_OK != fr)
-    {
-        printf("f_findfirst error: %s (%d)\n", FRESULT_str(fr), fr);
-        Estado = 'E';
-        return;
-    }
-    
-    // Lista todos os arquivos encontrados
-    while (fr == FR_OK && fno.fname[0])
-    {
-        const char *pcWritableFile = "writable file",
-                   *pcReadOnlyFile = "read only file",
-                   *pcDirectory = "directory";
-        const char *pcAttrib;
-        
-        // Determina o tipo do item
-        if (fno.fattrib & AM_DIR)
-            pcAttrib = pcDirectory;
-        else if (fno.fattrib & AM_RDO)
-            pcAttrib = pcReadOnlyFile;
-        else
-            pcAttrib = pcWritableFile;
-        
-        printf("%s [%s] [size=%llu]\n", fno.fname, pcAttrib, fno.fsize);
-        fr = f_findnext(&dj, &fno);
-    }
-    f_closedir(&dj);
+    ls_start(p_dir);
 }
 
 /**
@@ -439,6 +961,8 @@ static void run_ls()
  */
 static void run_cat()
 {
+    if (sd_reservado_para_leitura())
+        return;
     char *arg1 = strtok(NULL, " ");
     if (!arg1)
     {
@@ -468,6 +992,170 @@ static void run_cat()
         Estado = 'E';
 }
 
+/**
+ * Copia para um novo arquivo o trecho entre ini_s e fim_s (segundos desde o
+ * incio) de um arquivo de amostras, usando o ndice .six gravado ao fech-lo
+ */
+static void run_extract()
+{
+    if (sd_reservado_para_gravador())
+        return;
+    char *arquivo = strtok(NULL, " ");
+    char *ini = strtok(NULL, " ");
+    char *fim = strtok(NULL, " ");
+    char *saida = strtok(NULL, " ");
+    if (!arquivo || !ini || !fim)
+    {
+        printf("Uso: extract <arquivo> <ini_s> <fim_s> [saida]\n");
+        return;
+    }
+
+    // Sada padro: <base>_x.<ext>
+    char nome[40];
+    if (!saida)
+    {
+        const char *ext = strrchr(arquivo, '.');
+        int base = ext ? (int)(ext - arquivo) : (int)strlen(arquivo);
+        snprintf(nome, sizeof nome, "%.*s_x%s", base, arquivo, ext ? ext : "");
+        saida = nome;
+    }
+
+    FRESULT fr = lidx_extract(arquivo, saida, (float)atof(ini), (float)atof(fim));
+    if (FR_OK != fr)
+    {
+        printf("[ERRO] extract: %s (%d)\n", FRESULT_str(fr), fr);
+        Estado = 'E';
+    }
+}
+
+/**
+ * Envia um arquivo em quadros binrios com CRC (ver xfer.h); usado pelo
+ * script ArquivosDados/BaixaArquivo.py, que retoma a partir do offset
+ */
+static void run_xfer()
+{
+    if (sd_reservado_para_leitura())
+        return;
+    char *arquivo = strtok(NULL, " ");
+    char *offset = strtok(NULL, " ");
+    if (!arquivo)
+    {
+        printf("Uso: xfer <arquivo> [offset]\n");
+        return;
+    }
+
+    FRESULT fr = xfer_send_file(arquivo, offset ? strtoul(offset, NULL, 0) : 0);
+    if (FR_OK != fr)
+    {
+        printf("[ERRO] xfer: %s (%d)\n", FRESULT_str(fr), fr);
+        Estado = 'E';
+    }
+}
+
+static void set_modo_usb(bool ativar);
+
+#if USE_WIFI
+/**
+ * Mostra o estado do Wi-Fi, do terminal remoto e do envio por UDP
+ */
+static void run_wifi()
+{
+    wifi_print_status();
+}
+#endif
+
+/**
+ * Liga ou desliga a telemetria binria pela USB: stream on|off
+ * Independe da captura; com ela ativa a gravao no SD continua normalmente
+ */
+static void run_stream()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1 || (strcmp(arg1, "on") && strcmp(arg1, "off")))
+    {
+        printf("Uso: stream on|off\n");
+        return;
+    }
+    if (0 == strcmp(arg1, "on"))
+    {
+        printf("Telemetria ligada (%lu Hz). Use ArquivosDados/PlotaAoVivo.py.\n", mpu_sample_rate_hz);
+        tlm_set_enabled(true);
+    }
+    else
+    {
+        tlm_set_enabled(false);
+        tlm_print_stats();
+    }
+}
+
+/**
+ * Liga ou desliga o modo USB Mass Storage: msc on|off
+ */
+static void run_msc()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (!arg1 || (strcmp(arg1, "on") && strcmp(arg1, "off")))
+    {
+        printf("Uso: msc on|off\n");
+        return;
+    }
+    set_modo_usb(0 == strcmp(arg1, "on"));
+}
+
+/**
+ * Exibe os cronmetros dos caminhos crticos, as amostras descartadas e a
+ * gravao; "stats reset" zera os cronmetros e contadores
+ */
+static void run_stats()
+{
+    const char *arg1 = strtok(NULL, " ");
+    if (arg1 && 0 == strcmp(arg1, "reset"))
+    {
+        prof_reset();
+        printf("Estatsticas zeradas\n");
+        return;
+    }
+    prof_print();
+    acq_stats_t st;
+    acq_get_stats(&st);
+    printf("%-34s %lu\n", "Amostras descartadas", (unsigned long)st.overruns);
+    printf("%-34s %lu\n", "Transbordos da FIFO do sensor", (unsigned long)st.fifo_overflows);
+    log_writer_print_stats(&mpu_writer);
+    console_print_stats();
+}
+
+/**
+ * Mede vazo e latncia do carto: "bench [<drive#:>] [KiB]"
+ * Grava um arquivo de teste temporrio e salva a tabela em bench.csv
+ */
+static void run_bench()
+{
+    if (sd_reservado_para_gravador())
+        return;
+    const char *arg1 = strtok(NULL, " ");
+    const char *drive = sd_get_by_num(0)->pcName;
+    if (arg1 && strchr(arg1, ':'))
+    {
+        drive = arg1;
+        arg1 = strtok(NULL, " ");
+    }
+    uint32_t file_kb = arg1 ? (uint32_t)strtoul(arg1, NULL, 10) : BENCH_FILE_KB;
+
+    sd_card_t *pSD = sd_get_by_name(drive);
+    if (!pSD)
+    {
+        printf("Unknown logical drive number: \"%s\"\n", drive);
+        return;
+    }
+    if (!pSD->mounted)
+    {
+        printf("[ERRO] Carto %s no montado. Use 'a' ou 'mount'.\n", drive);
+        return;
+    }
+    if (FR_OK != bench_run(pSD, file_kb))
+        Estado = 'E';  // Define estado de erro
+}
+
 /**
  * Exibe a lista de comandos disponveis
  */
@@ -490,114 +1178,781 @@ static void run_help()
 // FUNES DE GERENCIAMENTO DE ARQUIVOS MPU6050
 // ================================================================================
 
+#if MPU_LOG_PREERASE
+// S o primeiro arquivo da captura  apagado, antes de as amostras correrem:
+// no meio da captura (novo segmento, disparo) o apagamento atrasaria o gravador
+static bool mpu_preerase_pendente = false;
+
 /**
- * Inicializa o arquivo CSV para armazenar dados do MPU6050
- * Cria o arquivo e escreve o cabealho com as colunas de dados
+ * Apaga as unidades de alocao (AU) inteiras da extenso contgua
+ * recm-reservada por f_expand, como o CTRL_TRIM do glue.c: apagar parte de
+ * uma AU no poupa nada ao carto
+ * Uma falha no impede a captura: o carto s perde a vantagem do apagamento
+ */
+static void preerase_extent(FIL *fp, FSIZE_t size) {
+    FATFS *fs = fp->obj.fs;
+    sd_card_t *sd = sd_get_by_num(fs->pdrv);
+    LBA_t lba = fs->database + (LBA_t)fs->csize * (fp->obj.sclust - 2);
+    LBA_t au = sd->au_sectors;
+    if (!au)
+        return;
+    LBA_t first = (lba + au - 1) / au * au;
+    LBA_t end = (lba + size / FF_MIN_SS) / au * au;    // Exclusivo
+    if (first >= end)
+        return;
+    uint32_t t0 = time_us_32();
+    int rc = sd_erase_blocks(sd, first, end - 1);
+    if (rc != SD_BLOCK_DEVICE_ERROR_NONE)
+        printf("[AVISO] Apagamento prvio da extenso falhou (%d)\n", rc);
+    else
+        printf("Extenso apagada em %lu ms\n", (unsigned long)((time_us_32() - t0) / 1000));
+}
+#endif
+
+#if MPU_LOG_SECOND_SD
+/**
+ * Cria no segundo carto o arquivo com o nome do principal e o associa ao
+ * gravador (espelho ou faixas), montando o carto se preciso
+ * Sem o segundo carto a captura segue apenas no principal
+ * @param prealloc Tamanho pr-alocado do arquivo principal (0 = sem)
+ */
+static void open_second_card_file(FSIZE_t prealloc) {
+    if (sd_get_num() < 2) {
+        printf("[AVISO] Segundo carto no configurado (SD_SECOND_CARD em hw_config.c).\n");
+        return;
+    }
+    sd_card_t *sd2 = sd_get_by_num(1);
+    FRESULT fr = FR_OK;
+    if (!sd2->mounted) {
+        fr = f_mount(&sd2->fatfs, sd2->pcName, 1);
+        sd2->mounted = (fr == FR_OK);
+    }
+    char path[40];
+    snprintf(path, sizeof path, "%s%s", sd2->pcName, mpu_filename);
+    if (fr == FR_OK)
+        fr = f_open(&mpu_file2, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK) {
+        printf("[AVISO] Segundo carto indisponvel (%s). Gravando s em %s.\n",
+               FRESULT_str(fr), sd_get_by_num(0)->pcName);
+        return;
+    }
+
+    // Nas faixas cada carto recebe metade dos blocos
+    if (MPU_LOG_SECOND_SD == 2)
+        prealloc = (prealloc / 2 + LOG_WRITER_BUF_SIZE - 1) / LOG_WRITER_BUF_SIZE * LOG_WRITER_BUF_SIZE;
+    if (prealloc && f_expand(&mpu_file2, prealloc, 1) != FR_OK)
+        printf("[AVISO] Sem espao contguo no segundo carto; gravando sem pr-alocao.\n");
+#if MPU_LOG_JOURNAL
+    else if (prealloc)
+        f_sync(&mpu_file2);     // Cpia tambm recupervel aps queda de energia
+#endif
+
+    log_writer_set_second(&mpu_writer, &mpu_file2,
+                          MPU_LOG_SECOND_SD == 1 ? LOG_WRITER_MIRROR : LOG_WRITER_STRIPE);
+    mpu_file2_aberto = true;
+    printf("%s em %s\n", MPU_LOG_SECOND_SD == 1 ? "Espelho" : "Faixas (blocos alternados)", path);
+}
+
+/**
+ * Ajusta o tamanho e fecha o arquivo do segundo carto
+ */
+static void close_second_card_file(void) {
+    if (!mpu_file2_aberto)
+        return;
+    if (f_truncate(&mpu_file2) != FR_OK || f_close(&mpu_file2) != FR_OK)
+        printf("[AVISO] Falha ao fechar o arquivo no segundo carto.\n");
+    mpu_file2_aberto = false;
+}
+#endif
+
+/**
+ * Inicializa o arquivo de dados do MPU6050
+ * Cria o arquivo e escreve o cabealho (binrio ou colunas do CSV)
+ * @param prealloc_samples Amostras previstas, para a pr-alocao (0 = sem)
+ * @param start_us Instante de referncia do primeiro registro
  * @return true se inicializado com sucesso, false caso contrrio
  */
-bool init_mpu_csv_file() {
+bool init_mpu_log_file(uint32_t prealloc_samples, uint32_t start_us) {
     FRESULT res = f_open(&mpu_file, mpu_filename, FA_WRITE | FA_CREATE_ALWAYS);
     if (res != FR_OK) {
-        printf("[ERRO] No foi possvel criar o arquivo CSV do MPU6050. Verifique se o carto est montado.\n");
+        printf("[ERRO] No foi possvel criar o arquivo de dados do MPU6050. Verifique se o carto est montado.\n");
         Estado = 'E';
         return false;
     }
+    log_writer_init(&mpu_writer, &mpu_file);
+    mpu_file_prealloc = false;
+    mpu_file_raw = false;
+    mpu_file_journaled = false;
+#if MPU_LOG_PREERASE
+    bool apagar = mpu_preerase_pendente;
+    mpu_preerase_pendente = false;
+#endif
+
+    // Reserva clusters contguos para toda a captura: durante a gravao s
+    // setores de dados so escritos, sem acessos  FAT a cada novo cluster
+    if (prealloc_samples) {
+#if USE_SPECTRUM == 2
+        FSIZE_t bytes_per_sample = (sizeof(spec_record_t) + SPEC_HOP - 1) / SPEC_HOP;
+#elif MPU_LOG_COMPRESS
+        FSIZE_t bytes_per_sample = MPU_PACK_MAX_RECORD;     // Pior caso
+#elif MPU_LOG_BINARY
+        FSIZE_t bytes_per_sample = sizeof(mpu_log_record_t) * (ACQ_SECOND_MPU ? 2 : 1);
+#elif USE_RAW_SECTORS
+        FSIZE_t bytes_per_sample = MPU_LOG_CSV_LINE_MAX * (ACQ_SECOND_MPU ? 2 : 1);  // A extenso  o limite
+#else
+        FSIZE_t bytes_per_sample = 64;      // Linha CSV tpica
+#endif
+#if MPU_LOG_JOURNAL
+        // Setor do cabealho e setores de 31 registros (15 amostras com dois sensores)
+        FSIZE_t size = ((FSIZE_t)prealloc_samples / (JRNL_RECORDS / (ACQ_SECOND_MPU ? 2 : 1)) + 2) * JRNL_SECTOR_SIZE;
+        (void)bytes_per_sample;
+#else
+        FSIZE_t size = (FSIZE_t)prealloc_samples * bytes_per_sample;
+#endif
+        size = (size + LOG_WRITER_BUF_SIZE - 1) / LOG_WRITER_BUF_SIZE * LOG_WRITER_BUF_SIZE;
+        res = f_expand(&mpu_file, size, 1);
+        if (res == FR_OK) {
+            mpu_file_prealloc = true;
+            printf("Arquivo pr-alocado: %lu KiB contguos\n", (unsigned long)(size / 1024));
+#if MPU_LOG_PREERASE
+            if (apagar)
+                preerase_extent(&mpu_file, size);
+#endif
+#if MPU_LOG_JOURNAL
+            // Extenso e tamanho no diretrio desde j: depois de uma queda
+            // de energia basta achar o ltimo setor vlido do dirio
+            mpu_file_journaled = (f_sync(&mpu_file) == FR_OK);
+            if (!mpu_file_journaled)
+                printf("[AVISO] No foi possvel registrar a pr-alocao; mantendo f_sync peridico.\n");
+#endif
+        } else {
+            printf("[AVISO] Sem espao contguo para pr-alocar o arquivo (%s). Gravando sem pr-alocao.\n",
+                   FRESULT_str(res));
+        }
+
+#if USE_RAW_SECTORS
+        // Setor inicial da extenso, resolvido uma nica vez
+        if (mpu_file_prealloc) {
+            FATFS *fs = mpu_file.obj.fs;
+            LBA_t lba = fs->database + (LBA_t)fs->csize * (mpu_file.obj.sclust - 2);
+            res = log_writer_init_raw(&mpu_writer, &mpu_file, sd_get_by_num(fs->pdrv),
+                                      lba, (uint32_t)(size / FF_MIN_SS));
+            mpu_file_raw = (res == FR_OK);
+            if (mpu_file_raw)
+                printf("Captura em setores brutos a partir do LBA %lu\n", (unsigned long)lba);
+        }
+        if (!mpu_file_raw) {
+            printf("[ERRO] No foi possvel iniciar a gravao em setores brutos.\n");
+            Estado = 'E';
+            f_close(&mpu_file);
+            return false;
+        }
+#endif
+    }
+#if MPU_LOG_SECOND_SD
+    open_second_card_file(mpu_file_prealloc ? f_size(&mpu_file) : 0);
+#endif
     
-    // Escreve o cabealho do arquivo CSV
-    const char* header = "Sample,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch\n";
-    UINT bw;
-    res = f_write(&mpu_file, header, strlen(header), &bw);
+#if USE_SPECTRUM
+    spec_init(&espectro, mpu_sample_rate_hz, mpu.accel_lsb_per_g);
+#endif
+#if USE_SPECTRUM == 2
+    // Cabealho com o tamanho da janela, faixas e unidades
+    spec_header_t header;
+    spec_header_init(&header, &espectro, start_us);
+    res = log_writer_append(&mpu_writer, &header, sizeof header);
+#elif MPU_LOG_BINARY
+    // Cabealho com escalas, taxa e verso do firmware
+    mpu_log_header_t header;
+    log_last_us = start_us;
+    mpu_log_header_init(&header, mpu_sample_rate_hz, log_last_us);
+    header.start_unix_us = rtc_unix_us(log_last_us);
+    header.att_tau_s = ATT_TAU_S;   // O decodificador refaz o mesmo filtro
+    header.accel_lsb_per_g = mpu.accel_lsb_per_g;
+    header.gyro_lsb_per_dps = mpu.gyro_lsb_per_dps;
+#if ACQ_SECOND_MPU
+    if (mpu2_presente)
+        header.flags |= MPU_LOG_FLAG_DUAL;
+#endif
+#if MPU_LOG_SECOND_SD
+    if (mpu_writer.split == LOG_WRITER_STRIPE)
+        header.stripe_sectors = LOG_WRITER_SECTORS;
+#endif
+#if USE_TRIGGER
+    header.flags |= MPU_LOG_FLAG_EVENT;
+    header.pre_samples = evento_pre;
+#endif
+#if MPU_LOG_COMPRESS
+    // O primeiro bloco termina na fronteira de setor aps o cabealho
+    header.flags |= MPU_LOG_FLAG_PACKED;
+    header.block_size = MPU_PACK_BLOCK_SIZE;
+    mpu_pack_init(&mpu_pack, MPU_PACK_BLOCK_SIZE - sizeof header);
+#endif
+#if MPU_LOG_JOURNAL
+    header.flags |= MPU_LOG_FLAG_JOURNAL;
+    jrnl_init(&mpu_jrnl, get_rand_32());
+#endif
+    log_dt_unit_us = header.dt_unit_us;
+#if USE_CRASH_BUFFER
+    mpu_header = header;
+#endif
+    res = log_writer_append(&mpu_writer, &header, sizeof header);
+#if MPU_LOG_JOURNAL
+    // O cabealho ocupa sozinho o primeiro setor
+    static const uint8_t zeros[JRNL_SECTOR_SIZE - sizeof header];
+    if (res == FR_OK)
+        res = log_writer_append(&mpu_writer, zeros, sizeof zeros);
+#endif
+#else
+    // Recprocos das escalas em ponto fixo: a linha do CSV sai sem divises
+    mpu_log_scale_init(&csv_escala, mpu.accel_lsb_per_g, mpu.gyro_lsb_per_dps);
+#if ACQ_SECOND_MPU
+    mpu_log_scale_init(&csv_escala2, mpu2.accel_lsb_per_g, mpu2.gyro_lsb_per_dps);
+#endif
+
+    mpu_log_clock_init(&csv_relogio, start_us);
+
+    // Escreve o cabealho do arquivo CSV; a linha de comentrio leva a hora
+    // do RTC no instante zero da coluna Time
+    char inicio[48] = "";
+    int64_t unix_us = rtc_unix_us(start_us);
+    if (unix_us)
+        snprintf(inicio, sizeof inicio, "# start_unix_us=%lld\n", (long long)unix_us);
+    res = log_writer_append(&mpu_writer, inicio, strlen(inicio));
+#if ACQ_SECOND_MPU
+    const char* header = mpu2_presente
+        ? "Sample,Time,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch,Accel2X,Accel2Y,Accel2Z,Gyro2X,Gyro2Y,Gyro2Z\n"
+        : "Sample,Time,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch\n";
+#else
+    const char* header = "Sample,Time,AccelX,AccelY,AccelZ,GyroX,GyroY,GyroZ,Roll,Pitch\n";
+#endif
+    if (res == FR_OK)
+        res = log_writer_append(&mpu_writer, header, strlen(header));
+#endif
+    if (res != FR_OK) {
+        printf("[ERRO] No foi possvel escrever o cabealho no arquivo de dados.\n");
+        Estado = 'E';
+        f_close(&mpu_file);
+#if MPU_LOG_SECOND_SD
+        close_second_card_file();
+#endif
+        return false;
+    }
+#if MPU_SEEK_INDEX
+    // Uma entrada por segundo de captura, a comear logo aps o cabealho
+    lidx_init(&mpu_index, mpu_sample_rate_hz);
+    lidx_mark(&mpu_index, sample_counter, start_us, (uint32_t)mpu_writer.bytes);
+#endif
+
+#if USE_SPECTRUM == 1
+    // Resumo espectral em arquivo prprio, ao lado das amostras
+    spec_header_t spec_header;
+    spec_header_init(&spec_header, &espectro, time_us_32());
+    res = f_open(&spec_file, spec_filename, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res == FR_OK) {
+        log_writer_init(&spec_writer, &spec_file);
+        res = log_writer_append(&spec_writer, &spec_header, sizeof spec_header);
+        if (res != FR_OK)
+            f_close(&spec_file);
+    }
     if (res != FR_OK) {
-        printf("[ERRO] No foi possvel escrever o cabealho no arquivo CSV.\n");
+        printf("[ERRO] No foi possvel criar o arquivo de espectro (%s).\n", FRESULT_str(res));
         Estado = 'E';
         f_close(&mpu_file);
+#if MPU_LOG_SECOND_SD
+        close_second_card_file();
+#endif
         return false;
     }
+#endif
     
-    printf("Arquivo CSV do MPU6050 inicializado: %s\n", mpu_filename);
+    printf("Arquivo de dados do MPU6050 inicializado: %s\n", mpu_filename);
     return true;
 }
 
 /**
- * Inicia a captura contnua de dados do MPU6050
- * Configura o sistema para logging automtico a 10Hz
+ * Grava o que resta nos buffers e fecha o arquivo de dados
+ * Com pr-alocao, o arquivo  truncado ao tamanho efetivamente gravado
  */
-void start_mpu_logging() {
-    if (mpu_logging_enabled) {
-        printf("Captura do MPU6050 j est ativa!\n");
+static void close_mpu_log_file() {
+#if USE_CRASH_BUFFER
+    // Daqui em diante o buffer de aquisio volta a ser descartvel
+    crash_disarm();
+#endif
+#if MPU_LOG_COMPRESS
+    uint32_t len;
+    const uint8_t *bloco = mpu_pack_finish(&mpu_pack, &len);
+    if (bloco && log_writer_append(&mpu_writer, bloco, len) != FR_OK) {
+        printf("[ERRO] Falha ao gravar o ltimo bloco comprimido.\n");
         Estado = 'E';
-        return;
     }
-    
-    if (!init_mpu_csv_file()) {
-        return;
+    if (mpu_pack.packed_bytes)
+        printf("Compresso: %llu -> %llu bytes (%.2fx)\n", mpu_pack.raw_bytes, mpu_pack.packed_bytes,
+               (double)mpu_pack.raw_bytes / mpu_pack.packed_bytes);
+#endif
+#if MPU_LOG_JOURNAL
+    const jrnl_sector_t *setor = jrnl_finish(&mpu_jrnl);
+    if (setor && log_writer_append(&mpu_writer, setor, sizeof *setor) != FR_OK) {
+        printf("[ERRO] Falha ao gravar o ltimo setor do dirio.\n");
+        Estado = 'E';
     }
-    
-    // Configura variveis de controle do logging
-    mpu_logging_enabled = true;
-    sample_counter = 0;
-    next_mpu_log_time = make_timeout_time_ms(mpu_log_period);
-    
-    printf("Iniciada captura contnua do MPU6050 (10Hz)\n");
-    printf("Pressione 'i' para parar a captura.\n");
-}
+#endif
+    if (log_writer_flush(&mpu_writer) != FR_OK) {
+        printf("[ERRO] Falha ao gravar o final da captura no arquivo.\n");
+        Estado = 'E';
+    }
+    // Setores brutos: o ponteiro do FatFs no acompanhou a gravao
+    if (mpu_file_raw && f_lseek(&mpu_file, mpu_writer.bytes) != FR_OK) {
+        printf("[ERRO] No foi possvel posicionar o fim do arquivo.\n");
+        Estado = 'E';
+    }
+    mpu_file_raw = false;
 
-/**
- * Para a captura de dados do MPU6050
- * Fecha o arquivo e exibe estatsticas da captura
- */
-void stop_mpu_logging() {
-    if (!mpu_logging_enabled) {
-        printf("Captura do MPU6050 no est ativa!\n");
+    // Descarta a parte pr-alocada que no chegou a ser usada
+    if (mpu_file_prealloc && f_truncate(&mpu_file) != FR_OK) {
+        printf("[ERRO] No foi possvel ajustar o tamanho final do arquivo.\n");
         Estado = 'E';
-        return;
     }
-    
-    mpu_logging_enabled = false;
+    mpu_file_prealloc = false;
+    mpu_file_journaled = false;
     f_close(&mpu_file);
+#if MPU_LOG_SECOND_SD
+    close_second_card_file();
+#endif
+#if MPU_SEEK_INDEX
+    FRESULT fr = lidx_save(&mpu_index, mpu_filename, (uint32_t)mpu_writer.bytes);
+    if (fr != FR_OK)
+        printf("[AVISO] No foi possvel gravar o ndice de %s (%s)\n", mpu_filename, FRESULT_str(fr));
+#endif
+#if USE_SPECTRUM == 1
+    if (log_writer_flush(&spec_writer) != FR_OK) {
+        printf("[ERRO] Falha ao gravar o final do arquivo de espectro.\n");
+        Estado = 'E';
+    }
+    f_close(&spec_file);
+    printf("Espectro salvo em: %s\n", spec_filename);
+#endif
+}
+
+/**
+ * Primeiro nmero sem arquivo no carto para o padro de nome informado
+ * Evita sobrescrever arquivos de capturas anteriores
+ * @param fmt Padro com um nico %lu (ou %04lu)
+ */
+static uint32_t next_free_number(const char *fmt) {
+    char nome[32];
+    FILINFO fno;
+    uint32_t n = 1;
+    for (; n < 10000; n++) {
+        snprintf(nome, sizeof nome, fmt, n);
+        if (f_stat(nome, &fno) == FR_NO_FILE)
+            break;
+    }
+    return n;
+}
+
+#if MPU_SEGMENTS
+/**
+ * Abre o prximo segmento da captura contnua e o registra no ndice
+ * O nome vem do RTC (AAMMDD_hhmmss); sem o RTC ajustado, usa o nome do
+ * ndice seguido do nmero do segmento
+ * @param start_us Instante de referncia do primeiro registro do segmento
+ */
+static bool open_segment(uint32_t start_us) {
+    datetime_t t;
+    bool rtc_ok = rtc_get_datetime(&t) && t.year >= 2000;
+    char quando[20] = "-";
+    if (rtc_ok)
+        snprintf(quando, sizeof quando, "%04d-%02d-%02d %02d:%02d:%02d",
+                 t.year, t.month, t.day, t.hour, t.min, t.sec);
+
+    segment_num++;
+    if (segment_num == 1) {
+        // ndice da captura, com o nome da captura
+        if (rtc_ok)
+            snprintf(mpu_index_filename, sizeof mpu_index_filename, "%02d%02d%02d_%02d%02d%02d.idx",
+                     t.year % 100, t.month, t.day, t.hour, t.min, t.sec);
+        else
+            snprintf(mpu_index_filename, sizeof mpu_index_filename, "mpu_%04lu.idx",
+                     next_free_number("mpu_%04lu.idx"));
+    }
+    if (rtc_ok)
+        snprintf(mpu_filename, sizeof mpu_filename, "%02d%02d%02d_%02d%02d%02d.%s",
+                 t.year % 100, t.month, t.day, t.hour, t.min, t.sec, mpu_ext);
+    else
+        snprintf(mpu_filename, sizeof mpu_filename, "%.8s_%03lu.%s",
+                 mpu_index_filename, segment_num, mpu_ext);
+
+    // O ndice  gravado antes de abrir o segmento: no modo de setores
+    // brutos o FatFs no pode ser usado com a sesso de escrita aberta
+    FIL idx;
+    FRESULT res = f_open(&idx, mpu_index_filename,
+                         FA_WRITE | (segment_num == 1 ? FA_CREATE_ALWAYS : FA_OPEN_APPEND));
+    if (res == FR_OK) {
+        if (segment_num == 1)
+            f_puts("segment,file,first_sample,start_us,rtc\n", &idx);
+        char linha[96];
+        snprintf(linha, sizeof linha, "%lu,%s,%lu,%lu,%s\n",
+                 segment_num, mpu_filename, sample_counter, start_us, quando);
+        if (f_puts(linha, &idx) < 0)
+            res = FR_DISK_ERR;
+        FRESULT rc = f_close(&idx);
+        if (res == FR_OK) res = rc;
+    }
+    if (res != FR_OK)
+        printf("[AVISO] No foi possvel atualizar o ndice %s (%s)\n", mpu_index_filename, FRESULT_str(res));
+
+    uint32_t seg_s = mpu_segment_s ? mpu_segment_s : mpu_prealloc_s;
+    if (!init_mpu_log_file(seg_s * mpu_sample_rate_hz, start_us))
+        return false;
+    segment_first_sample = sample_counter;
+    return true;
+}
+
+/**
+ * Indica se o segmento atual atingiu a durao ou o tamanho mximo
+ * Em setores brutos a extenso pr-alocada tambm fecha o segmento, com um
+ * buffer de folga: o gravador no passa do fim dela (FR_DENIED)
+ */
+static bool segment_full() {
+    if (mpu_segment_s && sample_counter - segment_first_sample >= mpu_segment_s * mpu_sample_rate_hz)
+        return true;
+    if (mpu_file_raw &&
+        mpu_writer.bytes + LOG_WRITER_BUF_SIZE > (FSIZE_t)mpu_writer.raw_capacity * FF_MIN_SS)
+        return true;
+    return mpu_segment_mb && mpu_writer.bytes >= (FSIZE_t)mpu_segment_mb << 20;
+}
+#endif
+
+/**
+ * Inicia a captura contnua de dados do MPU6050
+ * As amostras passam a ser gravadas conforme chegam do motor de aquisio
+ */
+void start_mpu_logging() {
+    if (mpu_logging_enabled) {
+        printf("Captura do MPU6050 j est ativa!\n");
+        Estado = 'E';
+        return;
+    }
+    if (msc_is_active()) {
+        printf("[ERRO] Carto SD exportado pela USB. Use 'msc off' antes de capturar.\n");
+        Estado = 'E';
+        return;
+    }
+    
+#if USE_TRIGGER
+    // Os arquivos s so criados nos disparos; numerao aps os existentes
+    trg_init(&gatilho, mpu_sample_rate_hz, trg_pre_ms, trg_post_ms, trg_max_ms,
+             trg_accel_g, trg_gyro_dps, mpu.accel_lsb_per_g, mpu.gyro_lsb_per_dps);
+    evento_aberto = false;
+    evento_num = next_free_number(MPU_LOG_BINARY ? "evt_%04lu.bin" : "evt_%04lu.csv");
+#elif MPU_SEGMENTS
+#if MPU_LOG_PREERASE
+    mpu_preerase_pendente = true;
+#endif
+    // Extenso herdada do nome padro do modo de gravao
+    if (!mpu_ext[0]) {
+        const char *ponto = strrchr(mpu_filename, '.');
+        snprintf(mpu_ext, sizeof mpu_ext, "%s", ponto ? ponto + 1 : "bin");
+    }
+    sample_counter = 0;
+    segment_num = 0;
+    if (!open_segment(time_us_32())) {
+        return;
+    }
+#else
+#if MPU_LOG_PREERASE
+    mpu_preerase_pendente = true;
+#endif
+    if (!init_mpu_log_file(mpu_prealloc_s * mpu_sample_rate_hz, time_us_32())) {
+        return;
+    }
+#endif
+    
+    // Configura variveis de controle do logging
+    acq_flush();            // Descarta amostras anteriores ao incio da captura
+    acq_reset_stats();
+    mpu_logging_enabled = true;
+    sample_counter = 0;
+    sync_interval = mpu_sample_rate_hz * (mpu_sync_s ? mpu_sync_s : 5);
+    last_overruns = 0;
+#if USE_CRASH_BUFFER
+    // Pausado com o depurador conectado
+    if (capture_watchdog_ms)
+        watchdog_enable(capture_watchdog_ms, true);
+#endif
+    
+#if USE_TRIGGER
+    printf("Iniciada captura por evento do MPU6050 (%lu Hz, |a-1g| > %.2f g ou > %.0f /s)\n",
+           mpu_sample_rate_hz, trg_accel_g, trg_gyro_dps);
+#else
+    printf("Iniciada captura contnua do MPU6050 (%lu Hz)\n", mpu_sample_rate_hz);
+#endif
+    printf("Pressione 'i' para parar a captura.\n");
+}
+
+/**
+ * Para a captura de dados do MPU6050
+ * Fecha o arquivo e exibe estatsticas da captura
+ */
+void stop_mpu_logging() {
+    if (!mpu_logging_enabled) {
+        printf("Captura do MPU6050 no est ativa!\n");
+        Estado = 'E';
+        return;
+    }
+    
+    mpu_logging_enabled = false;
+#if USE_CRASH_BUFFER
+    hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+#endif
+#if USE_TRIGGER
+    if (evento_aberto)
+        close_mpu_log_file();
+    evento_aberto = false;
+    printf("Captura por evento finalizada. Eventos: %lu, amostras gravadas: %lu\n",
+           gatilho.events, sample_counter);
+    trg_stats_print(&gatilho);
+#else
+    close_mpu_log_file();
     printf("Captura do MPU6050 finalizada. Total de amostras: %lu\n", sample_counter);
+#if MPU_SEGMENTS
+    printf("Dados salvos em %lu segmento(s), ndice: %s\n", segment_num, mpu_index_filename);
+#else
     printf("Dados salvos em: %s\n", mpu_filename);
+#endif
+#endif
+#if USE_SPECTRUM
+    printf("Janelas de espectro: %lu (maior clculo: %lu us)\n",
+           espectro.windows, espectro.max_us);
+#endif
+    acq_print_stats();
+    log_writer_print_stats(&mpu_writer);
 }
 
 /**
- * Captura e salva uma amostra de dados do MPU6050 em formato CSV
- * @param aceleracao Array com dados de acelerao [x, y, z]
- * @param gyro Array com dados do giroscpio [x, y, z]
- * @param roll ngulo roll calculado
- * @param pitch ngulo pitch calculado
+ * Grava uma amostra no arquivo de dados
+ * No formato binrio grava o registro bruto de 16 bytes; no CSV converte
+ * para unidades fsicas e inclui a atitude filtrada
  */
-void capture_mpu_data_to_csv(int16_t aceleracao[3], int16_t gyro[3], float roll, float pitch) {
-    if (!mpu_logging_enabled) return;
-    
-    // Converte valores brutos para unidades fsicas
-    float ax = aceleracao[0] / 16384.0f; // Acelerao em g
-    float ay = aceleracao[1] / 16384.0f; // Acelerao em g
-    float az = aceleracao[2] / 16384.0f; // Acelerao em g
+static FRESULT write_mpu_sample(const mpu_sample_t *amostra) {
+#if MPU_SEEK_INDEX
+    uint32_t ofs = (uint32_t)mpu_writer.bytes;  // Posio do registro no arquivo
+#endif
+#if MPU_LOG_BINARY
+#if MPU_SEEK_INDEX
+    uint32_t ref_us = log_last_us;              // Referncia do dt deste registro
+#endif
+    PROF_START(t_formato);
+    mpu_log_record_t rec;
+    mpu_log_encode(&rec, amostra, &log_last_us, log_dt_unit_us);
+    sample_counter++;
+    PROF_STOP(PROF_FORMAT, t_formato);
+
+#if MPU_LOG_COMPRESS
+    // S o incio de um bloco permite recomear a decodificao; o registro
+    // que fechou o bloco anterior  o primeiro do prximo
+    uint32_t len;
+    const uint8_t *bloco = mpu_pack_push(&mpu_pack, &rec, &len);
+    if (!bloco)
+        return FR_OK;
+#if MPU_SEEK_INDEX
+    lidx_mark(&mpu_index, sample_counter - 1, ref_us, ofs + len);
+#endif
+    return log_writer_append(&mpu_writer, bloco, len);
+#elif MPU_LOG_JOURNAL
+    // Registros da amostra no setor em montagem; s setores completos vo
+    // para o gravador
+    mpu_log_record_t recs[2] = {rec};
+    uint32_t n = 1;
+#if ACQ_SECOND_MPU
+    if (mpu2_presente) {
+        recs[1].dt = 0;
+        memcpy(recs[1].accel, amostra->accel2, sizeof rec.accel);
+        memcpy(recs[1].gyro, amostra->gyro2, sizeof rec.gyro);
+        recs[1].temp = amostra->temp2;
+        n = 2;
+    }
+#endif
+#if USE_CRASH_BUFFER
+    // Primeira amostra do arquivo: a partir da posio dela no buffer de
+    // aquisio o boot refaz os registros que faltarem no carto
+    if (mpu_file_journaled && mpu_jrnl.seq == 0 && jrnl_count(&mpu_jrnl) == 0)
+        crash_arm(mpu_filename, &mpu_header, mpu_jrnl.capture_id, acq_tail() - 1);
+#endif
+    const jrnl_sector_t *setor = jrnl_push(&mpu_jrnl, recs, n);
+    FRESULT fr = setor ? log_writer_append(&mpu_writer, setor, sizeof *setor) : FR_OK;
+#if MPU_SEEK_INDEX
+    // Pontos de reincio apenas no incio de um setor
+    if (jrnl_count(&mpu_jrnl) == n)
+        lidx_mark(&mpu_index, sample_counter - 1, ref_us, ofs + (setor ? sizeof *setor : 0));
+#endif
+    return fr;
+#else
+#if MPU_SEEK_INDEX
+    lidx_mark(&mpu_index, sample_counter - 1, ref_us, ofs);
+#endif
+#if ACQ_SECOND_MPU
+    // Segundo sensor: registro logo aps o do primeiro, com dt = 0
+    if (mpu2_presente) {
+        FRESULT fr = log_writer_append(&mpu_writer, &rec, sizeof rec);
+        if (fr != FR_OK)
+            return fr;
+        rec.dt = 0;
+        memcpy(rec.accel, amostra->accel2, sizeof rec.accel);
+        memcpy(rec.gyro, amostra->gyro2, sizeof rec.gyro);
+        rec.temp = amostra->temp2;
+    }
+#endif
+    return log_writer_append(&mpu_writer, &rec, sizeof rec);
+#endif
+#else
+#if MPU_SEEK_INDEX
+    lidx_mark(&mpu_index, sample_counter, amostra->t_us, ofs);
+#endif
+    PROF_START(t_formato);
+    // Converte valores brutos para unidades fsicas (g e graus/s) em linha CSV
+    char csv_line[MPU_LOG_CSV_LINE_MAX + MPU_LOG_CSV_AXES_MAX];
+    mpu_log_clock_advance(&csv_relogio, amostra->t_us);
+    int len = mpu_log_format_csv(csv_line, sizeof(csv_line), sample_counter++, &csv_relogio,
+                                 amostra->accel, amostra->gyro, &csv_escala,
+                                 atitude.roll, atitude.pitch);
+#if ACQ_SECOND_MPU
+    // Colunas do segundo sensor no lugar do fim de linha
+    if (mpu2_presente) {
+        char *p = mpu_log_put_axes(csv_line + len - 1, amostra->accel2, amostra->gyro2, &csv_escala2);
+        *p++ = '\n';
+        len = (int)(p - csv_line);
+    }
+#endif
+    PROF_STOP(PROF_FORMAT, t_formato);
     
-    float gx = gyro[0] / 131.0f; // Velocidade angular em graus/s
-    float gy = gyro[1] / 131.0f; // Velocidade angular em graus/s
-    float gz = gyro[2] / 131.0f; // Velocidade angular em graus/s
-
-    // Formata os dados em linha CSV
-    char csv_line[200];
-    snprintf(csv_line, sizeof(csv_line), 
-             "%lu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f\n",
-             sample_counter++, ax, ay, az, gx, gy, gz, roll, pitch);
+    // Acumula no buffer de setores
+    return log_writer_append(&mpu_writer, csv_line, (uint32_t)len);
+#endif
+}
+
+#if USE_TRIGGER
+/**
+ * Captura por evento: no disparo cria o arquivo do evento e grava o
+ * pr-gatilho; depois grava cada amostra at o fim do ps-gatilho
+ */
+static FRESULT capture_event_sample(const mpu_sample_t *amostra) {
+    trg_result_t r = trg_push(&gatilho, amostra);
+    if (r == TRG_IDLE)
+        return FR_OK;
+
+    FRESULT res = FR_OK;
+    if (r == TRG_START) {
+        const mpu_sample_t *inicio = trg_oldest_pre(&gatilho);
+        evento_pre = gatilho.pre_count;
+        snprintf(mpu_filename, sizeof mpu_filename, "evt_%04lu.%s", evento_num++,
+                 MPU_LOG_BINARY ? "bin" : "csv");
+        if (!init_mpu_log_file(gatilho.max_len, inicio ? inicio->t_us : amostra->t_us))
+            return FR_DISK_ERR;
+        evento_aberto = true;
+        eventos_gravados++;
+        evt_post(EVT_SD_DONE, 0);       // Alerta sonoro emitido pelo ncleo 0
+
+        mpu_sample_t anterior;
+        while (res == FR_OK && trg_pop_pre(&gatilho, &anterior))
+            res = write_mpu_sample(&anterior);
+    }
+    if (res == FR_OK)
+        res = write_mpu_sample(amostra);
+
+    if (r == TRG_LAST) {
+        close_mpu_log_file();
+        evento_aberto = false;
+        printf("Evento %lu gravado em %s\n", gatilho.events, mpu_filename);
+    }
+    return res;
+}
+#endif
+
+/**
+ * Processa uma amostra retirada do motor de aquisio conforme o modo de
+ * gravao (contnuo, por evento ou resumo espectral)
+ * @param amostra Amostra retirada do motor de aquisio
+ */
+void capture_mpu_sample(const mpu_sample_t *amostra) {
+    if (!mpu_logging_enabled) return;
+
+#if USE_SPECTRUM
+    spec_record_t spec_rec;
+    bool spec_pronto = spec_push(&espectro, amostra, &spec_rec);
+#endif
     
-    // Escreve no arquivo
-    UINT bw;
-    FRESULT res = f_write(&mpu_file, csv_line, strlen(csv_line), &bw);
+#if USE_SPECTRUM == 2
+    // Amostras brutas no so gravadas, apenas o resumo de cada janela
+    sample_counter++;
+    FRESULT res = spec_pronto ? log_writer_append(&mpu_writer, &spec_rec, sizeof spec_rec) : FR_OK;
+#elif USE_TRIGGER
+    FRESULT res = capture_event_sample(amostra);
+#else
+    FRESULT res = write_mpu_sample(amostra);
+#endif
+#if USE_SPECTRUM == 1
+    if (res == FR_OK && spec_pronto)
+        res = log_writer_append(&spec_writer, &spec_rec, sizeof spec_rec);
+#endif
     if (res != FR_OK) {
-        printf("[ERRO] Falha ao escrever dados do MPU6050 no arquivo CSV.\n");
+        printf("[ERRO] Falha ao escrever dados do MPU6050 no arquivo.\n");
         Estado = 'E';
         stop_mpu_logging();
         return;
     }
+
+#if MPU_SEGMENTS
+    // Troca de segmento; os registros seguem contnuos a partir desta amostra
+    if (segment_full()) {
+        close_mpu_log_file();
+        if (!open_segment(amostra->t_us)) {
+            stop_mpu_logging();
+            return;
+        }
+        printf("Novo segmento: %s\n", mpu_filename);
+    }
+#endif
     
-    // Sincroniza arquivo a cada 50 amostras (aproximadamente 5 segundos)
-    if (sample_counter % 50 == 0) {
+#if USE_TRIGGER
+    // Arquivos de evento so curtos e fechados ao fim de cada evento; a cada
+    // intervalo apenas exibe as estatsticas contnuas
+    if (gatilho.stats.count < sync_interval)
+        return;
+    printf("ltimas %lu amostras (%lu eventos at agora):\n", gatilho.stats.count, gatilho.events);
+    trg_stats_print(&gatilho);
+    trg_stats_reset(&gatilho.stats);
+#else
+    // Sincroniza arquivo a cada mpu_sync_s segundos de captura
+    // (s os buffers j gravados; o buffer parcial permanece na RAM para
+    // manter o alinhamento)
+    if (sample_counter % sync_interval != 0)
+        return;
+    // No modo bruto a FAT s  atualizada no fim; com o dirio o diretrio
+    // j tem a extenso inteira e os setores se validam sozinhos
+    if (mpu_sync_s && !mpu_file_raw && !mpu_file_journaled) {
+        PROF_START(t_sync);
         f_sync(&mpu_file);
-        printf("Salvos %lu amostras do MPU6050...\n", sample_counter);
+        PROF_STOP(PROF_F_SYNC, t_sync);
+    }
+#if MPU_LOG_SECOND_SD
+    if (mpu_file2_aberto)
+        f_sync(&mpu_file2);
+#endif
+#if USE_SPECTRUM == 1
+    f_sync(&spec_file);
+#endif
+    printf("Salvos %lu amostras do MPU6050...\n", sample_counter);
+#endif
+
+    // Informa se a latncia do SD excedeu a profundidade do buffer
+    acq_stats_t st;
+    acq_get_stats(&st);
+    if (st.overruns != last_overruns) {
+        printf("[AVISO] %lu amostras descartadas (buffer de aquisio cheio)\n",
+               st.overruns - last_overruns);
+        last_overruns = st.overruns;
     }
 }
 
@@ -607,6 +1962,9 @@ void capture_mpu_data_to_csv(int16_t aceleracao[3], int16_t gyro[3], float roll,
  */
 void read_file(const char *filename)
 {
+    if (sd_reservado_para_gravador())
+        return;
+
     if (!filename || strlen(filename) == 0) {
         printf("[ERRO] Nome do arquivo no fornecido.\n");
         printf("Uso: Pressione 'd' e fornea o nome do arquivo\n\n");
@@ -691,6 +2049,227 @@ void read_file(const char *filename)
     printf("\n");
 }
 
+// ================================================================================
+// PIPELINE DE GRAVAO - CONSUMIDOR DO BUFFER DE AQUISIO
+// ================================================================================
+
+// Comandos enviados ao ncleo 1 pela FIFO entre ncleos
+typedef enum {
+    CMD_GRAVADOR_INICIAR = 1,   // Abre o arquivo e inicia a gravao
+    CMD_GRAVADOR_PARAR = 2,     // Grava o restante e fecha o arquivo
+    CMD_GRAVADOR_LS_ABRIR = 3,  // Listagem (ls): abre o diretrio
+    CMD_GRAVADOR_LS_PAGINA = 4, // L a prxima pgina
+    CMD_GRAVADOR_LS_FECHAR = 5  // Fecha o diretrio
+} cmd_gravador_t;
+
+// Listagem do ls em pginas de LS_PAGE entradas: cada pgina  uma leitura
+// curta do carto, feita pelo dono do FatFs (o ncleo 1 durante a captura,
+// entre dois lotes de amostras) e exibida pelo lao principal
+#define LS_PAGE 8
+
+static DIR ls_dir;
+static FILINFO ls_page[LS_PAGE];
+static uint32_t ls_count;                     // Entradas na pgina lida
+static FRESULT ls_result;
+static char ls_path[FF_LFN_BUF + 1];
+static bool ls_ativo = false;                 // Listagem em andamento
+static bool ls_no_gravador = false;           // Pginas lidas pelo ncleo 1
+static uint32_t ls_total;
+
+/**
+ * Operao da listagem, no ncleo que acessa o carto
+ */
+static void ls_op(uint32_t cmd) {
+    if (cmd == CMD_GRAVADOR_LS_ABRIR) {
+        ls_result = f_opendir(&ls_dir, ls_path);
+    } else if (cmd == CMD_GRAVADOR_LS_PAGINA) {
+        ls_count = 0;
+        while (ls_count < LS_PAGE) {
+            ls_result = f_readdir(&ls_dir, &ls_page[ls_count]);
+            if (ls_result != FR_OK || !ls_page[ls_count].fname[0])
+                break;
+            ls_count++;
+        }
+    } else {
+        f_closedir(&ls_dir);
+    }
+}
+
+/**
+ * Consome as amostras pendentes do motor de aquisio
+ * Grava as amostras se houver captura ativa e descarta as demais.
+ * Entre cada gravao de bloco no SD o buffer de aquisio  esvaziado de
+ * novo, para que o buffer de setores seguinte se encha enquanto o anterior
+ *  gravado.
+ * Deve ser chamada sempre pelo mesmo ncleo (nico consumidor do buffer).
+ */
+static void drain_mpu_samples() {
+    mpu_sample_t amostra;
+
+    do {
+#if USE_CRASH_BUFFER
+        if (mpu_logging_enabled)
+            watchdog_update();
+#endif
+        while (acq_pop(&amostra)) {
+            att_update(&atitude, &amostra);
+            tlm_push(&amostra);
+#if USE_WIFI
+            wifi_push(&amostra);
+#endif
+            if (mpu_logging_enabled)
+                capture_mpu_sample(&amostra);
+        }
+        if (!mpu_logging_enabled)
+            return;
+        FRESULT res = log_writer_service(&mpu_writer);
+#if USE_SPECTRUM == 1
+        if (res == FR_OK)
+            res = log_writer_service(&spec_writer);
+#endif
+        if (res != FR_OK) {
+            printf("[ERRO] Falha ao escrever dados do MPU6050 no arquivo.\n");
+            Estado = 'E';
+            stop_mpu_logging();
+            evt_post(EVT_SD_DONE, 0);   // Acorda o lao principal para exibir o erro
+            return;
+        }
+#if USE_SPECTRUM == 1
+    } while (log_writer_pending(&mpu_writer) || log_writer_pending(&spec_writer));
+#else
+    } while (log_writer_pending(&mpu_writer));
+#endif
+}
+
+#if USE_DUAL_CORE
+/**
+ * Lao do ncleo 1: dono do FatFs durante a captura
+ * Atende comandos do ncleo 0 e grava as amostras no SD, de modo que
+ * f_write/f_sync e as pausas internas do carto no bloqueiem a amostragem.
+ */
+static void core1_sd_writer() {
+    while (true) {
+        if (multicore_fifo_rvalid()) {
+            uint32_t cmd = multicore_fifo_pop_blocking();
+            if (cmd == CMD_GRAVADOR_INICIAR) {
+                start_mpu_logging();
+            } else if (cmd == CMD_GRAVADOR_PARAR) {
+                drain_mpu_samples();    // No perde o final da captura
+                stop_mpu_logging();
+                evt_post(EVT_SD_DONE, 0);
+            } else {
+                ls_op(cmd);
+            }
+            multicore_fifo_push_blocking(mpu_logging_enabled);  // Confirma ao ncleo 0
+        }
+
+        drain_mpu_samples();
+
+        // Dorme at juntar um lote de amostras (__sev no timer) ou chegar
+        // comando na FIFO
+        while (acq_available() < LOTE_GRAVACAO && !multicore_fifo_rvalid())
+            __wfe();
+    }
+}
+#endif
+
+/**
+ * Executa uma operao da listagem no dono do FatFs
+ */
+static void ls_request(cmd_gravador_t cmd) {
+#if USE_DUAL_CORE
+    if (ls_no_gravador) {
+        multicore_fifo_push_blocking(cmd);
+        multicore_fifo_pop_blocking();
+        return;
+    }
+#endif
+    ls_op(cmd);
+}
+
+/**
+ * Encerra a listagem (fim, erro ou interrupo) e devolve o prompt
+ */
+static void ls_stop(const char *motivo) {
+    if (!ls_ativo)
+        return;
+    ls_request(CMD_GRAVADOR_LS_FECHAR);
+    ls_ativo = false;
+    printf("%lu itens%s\n> ", (unsigned long)ls_total, motivo);
+}
+
+/**
+ * Trabalho do lao principal: exibe a prxima pgina quando o buffer do
+ * terminal tiver espao para ela, sem esperar pelo computador
+ */
+static void ls_service(void) {
+    if (!ls_ativo || console_tx_free() < CONSOLE_TX_SIZE / 2)
+        return;
+    ls_request(CMD_GRAVADOR_LS_PAGINA);
+    for (uint32_t i = 0; i < ls_count; i++) {
+        const FILINFO *fno = &ls_page[i];
+        const char *pcAttrib;
+        
+        // Determina o tipo do item
+        if (fno->fattrib & AM_DIR)
+            pcAttrib = "directory";
+        else if (fno->fattrib & AM_RDO)
+            pcAttrib = "read only file";
+        else
+            pcAttrib = "writable file";
+        
+        printf("%s [%s] [size=%llu]\n", fno->fname, pcAttrib, fno->fsize);
+    }
+    ls_total += ls_count;
+    if (ls_result != FR_OK) {
+        printf("f_readdir error: %s (%d)\n", FRESULT_str(ls_result), ls_result);
+        Estado = 'E';
+        ls_stop("");
+    } else if (ls_count < LS_PAGE) {
+        ls_stop("");
+    } else {
+        evt_post(EVT_SD_DONE, 0);   // Acorda o lao para a prxima pgina
+    }
+}
+
+/**
+ * Inicia a listagem de um diretrio; as pginas seguem em ls_service()
+ */
+static void ls_start(const char *dir) {
+    ls_stop(" (interrompido)");
+    snprintf(ls_path, sizeof ls_path, "%s", dir);
+#if USE_DUAL_CORE
+    ls_no_gravador = mpu_logging_enabled;
+#endif
+    ls_request(CMD_GRAVADOR_LS_ABRIR);
+    if (ls_result != FR_OK) {
+        printf("f_opendir error: %s (%d)\n", FRESULT_str(ls_result), ls_result);
+        Estado = 'E';
+        return;
+    }
+    ls_total = 0;
+    ls_ativo = true;
+    ls_service();
+}
+
+/**
+ * Solicita o incio ou o fim da captura ao consumidor do buffer
+ * No modo dual-core aguarda a confirmao do ncleo 1.
+ * @param start true para iniciar, false para parar
+ */
+static void mpu_logging_request(bool start) {
+    ls_stop(" (interrompido)");     // O dono do FatFs muda de ncleo
+#if USE_DUAL_CORE
+    multicore_fifo_push_blocking(start ? CMD_GRAVADOR_INICIAR : CMD_GRAVADOR_PARAR);
+    multicore_fifo_pop_blocking();
+#else
+    if (start)
+        start_mpu_logging();
+    else
+        stop_mpu_logging();
+#endif
+}
+
 // ================================================================================
 // TABELA DE COMANDOS - MAPEAMENTO DE STRINGS PARA FUNES
 // ================================================================================
@@ -707,6 +2286,15 @@ static cmd_def_t cmds[] = {
     {"getfree", run_getfree, "getfree [<drive#:>]: Espao livre"},
     {"ls", run_ls, "ls: Lista arquivos"},
     {"cat", run_cat, "cat <filename>: Mostra contedo do arquivo"},
+    {"extract", run_extract, "extract <arquivo> <ini_s> <fim_s> [saida]: Copia um intervalo de tempo"},
+    {"msc", run_msc, "msc on|off: Expe o carto SD ao computador como disco USB"},
+    {"stream", run_stream, "stream on|off: Envia as amostras ao vivo em quadros binrios"},
+#if USE_WIFI
+    {"wifi", run_wifi, "wifi: Estado da conexo, do terminal remoto e do envio UDP"},
+#endif
+    {"xfer", run_xfer, "xfer <arquivo> [offset]: Envia o arquivo em quadros binrios (BaixaArquivo.py)"},
+    {"stats", run_stats, "stats [reset]: Tempos dos caminhos crticos e contadores de falhas"},
+    {"bench", run_bench, "bench [<drive#:>] [KiB]: Vazo e latncia do carto (bench.csv)"},
     {"help", run_help, "help: Mostra comandos disponveis"}
 };
 
@@ -718,30 +2306,38 @@ static cmd_def_t cmds[] = {
  * Processa caracteres recebidos via stdin e executa comandos
  * Implementa um parser simples de linha de comando
  * @param cRxedChar Caractere recebido
+ * @return true enquanto a linha s tem letras de atalho ('a'..'i'); assim o
+ *         nome de um arquivo em "xfer" no dispara, por exemplo, a formatao
  */
-static void process_stdio(int cRxedChar)
+static bool process_stdio(int cRxedChar)
 {
     static char cmd[256];  // Buffer para comando
     static size_t ix;      // ndice atual no buffer
+    static bool so_atalhos = true;
+    static uint32_t descartados;   // Caracteres alm do buffer na linha atual
 
     // Filtra apenas caracteres vlidos
     if (!isprint(cRxedChar) && !isspace(cRxedChar) && '\r' != cRxedChar &&
         '\b' != cRxedChar && cRxedChar != (char)127)
-        return;
+        return false;
     
     printf("%c", cRxedChar); // Echo do caractere
-    stdio_flush();
     
     if (cRxedChar == '\r')  // Enter pressionado
     {
         printf("%c", '\n');
-        stdio_flush();
 
+        if (descartados)
+        {
+            printf("[AVISO] Comando maior que %u caracteres: %lu descartados\n",
+                   (unsigned)(sizeof cmd - 1), (unsigned long)descartados);
+            descartados = 0;
+        }
         if (!strnlen(cmd, sizeof cmd))
         {
             printf("> ");
-            stdio_flush();
-            return;
+            so_atalhos = true;
+            return true;
         }
         
         // Tokeniza o comando
@@ -754,7 +2350,11 @@ static void process_stdio(int cRxedChar)
             {
                 if (0 == strcmp(cmds[i].command, cmdn))
                 {
+                    // Sadas longas (ls, cat) esperam pelo computador em
+                    // vez de serem descartadas
+                    console_set_blocking(true);
                     (*cmds[i].function)();  // Executa a funo correspondente
+                    console_set_blocking(false);
                     break;
                 }
             }
@@ -765,8 +2365,9 @@ static void process_stdio(int cRxedChar)
         // Reset do buffer de comando
         ix = 0;
         memset(cmd, 0, sizeof cmd);
-        printf("\n> ");
-        stdio_flush();
+        so_atalhos = true;
+        if (!ls_ativo)
+            printf("\n> ");    // Com o ls em andamento, o prompt vem no fim da listagem
     }
     else
     {
@@ -787,8 +2388,15 @@ static void process_stdio(int cRxedChar)
                 cmd[ix] = cRxedChar;
                 ix++;
             }
+            else
+            {
+                descartados++;
+            }
+            if (cRxedChar < 'a' || cRxedChar > 'i')
+                so_atalhos = false;
         }
     }
+    return so_atalhos;
 }
 
 // ================================================================================
@@ -796,12 +2404,18 @@ static void process_stdio(int cRxedChar)
 // ================================================================================
 
 /**
- * Handler de interrupo GPIO para os botes A e B
+ * Handler de interrupo GPIO para os botes A e B e o pino INT do MPU6050
  * Implementa debounce por software e controla estados do sistema
  * @param gpio Nmero do pino GPIO que gerou a interrupo
  * @param events Tipo de evento (borda de subida/descida)
  */
 void gpio_irq_handler(uint gpio, uint32_t events) {
+    // Dado pronto no MPU6050: sem debounce, cada pulso  uma amostra
+    if (gpio == MPU_INT_PIN) {
+        acq_data_ready_irq();
+        return;
+    }
+
     static uint32_t last_time = 0;
     uint32_t current_time = to_us_since_boot(get_absolute_time());
 
@@ -811,13 +2425,13 @@ void gpio_irq_handler(uint gpio, uint32_t events) {
         // Boto A: Controla coleta de dados
         if (gpio == botaoA && !gpio_get(botaoA)) {
             last_time = current_time;
-            Estado_coleta_dados = !Estado_coleta_dados;  // Toggle do estado
+            evt_post(EVT_BUTTON_A, 0);   // Tratado no lao principal
         }
         
         // Boto B: Controla montagem do carto SD
         if (gpio == botaoB && !gpio_get(botaoB)) {
             last_time = current_time;
-            Estado_montar_cartao = !Estado_montar_cartao;  // Toggle do estado
+            evt_post(EVT_BUTTON_B, 0);   // Tratado no lao principal
         }
     }
 }
@@ -826,54 +2440,36 @@ void gpio_irq_handler(uint gpio, uint32_t events) {
 // CONTROLE DO BUZZER - SINAIS SONOROS
 // ================================================================================
 
-/**
- * Gera um bipe no buzzer por tempo especificado
- * @param time_ms Durao do bipe em milissegundos
- */
-void buzzer_beep(int time_ms) {
-    gpio_put(buzzer, 1);      // Liga o buzzer
-    sleep_ms(time_ms);        // Mantm ligado pelo tempo especificado
-    gpio_put(buzzer, 0);      // Desliga o buzzer
-    sleep_ms(100);            // Pequeno intervalo entre bipes
-}
+// Padres de bipes: cada passo  {ligado, pausa} em ms
+static const ind_step_t bip_200x2[] = {{200, 100}, {200, 100}};
+static const ind_step_t bip_100x2[] = {{100, 100}, {100, 100}};
+static const ind_step_t bip_300x1[] = {{300, 100}};
+static const ind_step_t bip_100_300[] = {{100, 100}, {300, 100}};
+static const ind_step_t bip_100x3[] = {{100, 100}, {100, 100}, {100, 100}};
+static const ind_step_t bip_300x3[] = {{300, 100}, {300, 100}, {300, 100}};
+static const ind_step_t bip_50x1[] = {{50, 50}};
+
+#define IND_PATTERN(steps) {steps, sizeof(steps) / sizeof(steps[0])}
+
+// Indexado por Evento_buzzer
+static const ind_pattern_t padroes_buzzer[] = {
+    [Som_desmontando]        = IND_PATTERN(bip_200x2),   // 2 bipes curtos - SD desmontado
+    [Som_montando]           = IND_PATTERN(bip_100x2),   // 2 bipes curtos - SD montado
+    [Som_iniciando_captura]  = IND_PATTERN(bip_300x1),   // 1 bipe longo - incio da captura
+    [Som_encerrando_captura] = IND_PATTERN(bip_100_300), // 2 bipes (curto + longo) - fim da captura
+    [som_leitura]            = IND_PATTERN(bip_100x3),   // 3 bipes curtos - leitura de dados
+    [Som_erro]               = IND_PATTERN(bip_300x3),   // 3 bipes longos - erro no sistema
+    [Som_evento]             = IND_PATTERN(bip_50x1),    // 1 bipe curto - evento disparado
+};
 
 /**
  * Gera padres de bipes especficos para diferentes eventos do sistema
+ * A sequncia  enfileirada e tocada pelos alarmes; retorna imediatamente
  * @param evento Tipo de evento que determina o padro sonoro
  */
 void buzzer_signal(Evento_buzzer evento) {
-    switch (evento) {
-        case Som_desmontando:       // 2 bipes curtos - SD desmontado
-            buzzer_beep(200);
-            buzzer_beep(200);
-            break;
-
-        case Som_montando:          // 2 bipes curtos - SD montado
-            buzzer_beep(100);
-            buzzer_beep(100);
-            break;
-
-        case Som_iniciando_captura: // 1 bipe longo - incio da captura
-            buzzer_beep(300);
-            break;
-
-        case Som_encerrando_captura: // 2 bipes (curto + longo) - fim da captura
-            buzzer_beep(100);
-            buzzer_beep(300);
-            break;
-
-        case som_leitura:           // 3 bipes curtos - leitura de dados
-            buzzer_beep(100);
-            buzzer_beep(100);
-            buzzer_beep(100);
-            break;
-
-        case Som_erro:              // 3 bipes longos - erro no sistema
-            buzzer_beep(300);
-            buzzer_beep(300);
-            buzzer_beep(300);
-            break;
-    }
+    if (!ind_buzzer_play(&padroes_buzzer[evento]))
+        printf("[AVISO] Fila do buzzer cheia, sinal descartado\n");
 }
 
 // ================================================================================
@@ -885,19 +2481,8 @@ void buzzer_signal(Evento_buzzer evento) {
  * Configura LEDs, buzzer, botes e suas interrupes
  */
 void iniciando_perifericos(){
-    // Configurao dos LEDs como sada
-    gpio_init(Led_verde);
-    gpio_set_dir(Led_verde, GPIO_OUT);
-
-    gpio_init(Led_azul);
-    gpio_set_dir(Led_azul, GPIO_OUT);
-
-    gpio_init(Led_vermelho);
-    gpio_set_dir(Led_vermelho, GPIO_OUT);
-
-    // Configurao do buzzer como sada
-    gpio_init(buzzer);
-    gpio_set_dir(buzzer, GPIO_OUT);
+    // LEDs e buzzer como sada, controlados pelos alarmes de sinalizao
+    ind_init(buzzer, Led_verde, Led_azul, Led_vermelho);
 
     // Configurao do boto A com pull-up e interrupo
     gpio_init(botaoA);
@@ -910,8 +2495,264 @@ void iniciando_perifericos(){
     gpio_set_dir(botaoB, GPIO_IN);
     gpio_pull_up(botaoB);
     gpio_set_irq_enabled_with_callback(botaoB, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
+
+#if USE_MPU_FIFO
+    // Pino INT do MPU6050: ativo em nvel alto, interrupo na borda de subida
+    gpio_init(MPU_INT_PIN);
+    gpio_set_dir(MPU_INT_PIN, GPIO_IN);
+    gpio_pull_down(MPU_INT_PIN);
+    gpio_set_irq_enabled_with_callback(MPU_INT_PIN, GPIO_IRQ_EDGE_RISE, true, &gpio_irq_handler);
+#endif
 }
 
+// ================================================================================
+// TRATAMENTO DE EVENTOS
+// ================================================================================
+
+/**
+ * Monta ou desmonta o carto SD (boto B e teclas 'a'/'b')
+ */
+static void set_montagem_cartao(bool montar) {
+    ls_stop(" (interrompido)");
+    if (montar) {
+        Estado = 'M';   // Estado: Montando SD
+        printf("\nMontando o SD...\n");
+        run_mount();
+    } else {
+        Estado = 'D';   // Estado: Desmontando SD
+        printf("\nDesmontando o SD. Aguarde...\n");
+        run_unmount();
+    }
+    printf("\nEscolha o comando (g = help):  ");
+    Estado_montar_cartao = montar;
+}
+
+#if USE_CRASH_BUFFER
+/**
+ * Completa o arquivo de uma captura interrompida por reset (watchdog ou
+ * falha) com as amostras preservadas no buffer de aquisio
+ * Executada no boot, antes de a aquisio reutilizar o buffer; o carto 
+ * montado s para a recuperao
+ */
+static void recover_crash_buffer() {
+    if (!crash_pending())
+        return;
+    printf("Captura interrompida por %s; completando %s...\n",
+           watchdog_enable_caused_reboot() ? "watchdog" : "reset", crash_path());
+
+    sd_card_t *pSD = sd_get_by_num(0);
+    FRESULT fr = f_mount(sd_get_fs_by_name(pSD->pcName), pSD->pcName, 1);
+    if (fr == FR_OK) {
+        pSD->mounted = true;
+        uint32_t recuperadas, perdidas;
+        fr = crash_recover(&mpu_jrnl, &recuperadas, &perdidas);
+        if (fr == FR_OK)
+            printf("%lu amostras da RAM acrescentadas a %s\n", recuperadas, crash_path());
+        if (perdidas)
+            printf("[AVISO] %lu amostras j sobrescritas no buffer de aquisio\n", perdidas);
+        f_unmount(pSD->pcName);
+        pSD->mounted = false;
+        pSD->m_Status |= STA_NOINIT;
+    }
+    if (fr != FR_OK) {
+        printf("[ERRO] No foi possvel completar %s (%s)\n", crash_path(), FRESULT_str(fr));
+        Estado = 'E';
+    }
+    crash_disarm();
+}
+#endif
+
+#if !AUTO_START
+/**
+ * Espera o terminal abrir a porta serial, se houver um computador na USB
+ * Um carregador tambm fornece VBUS, mas nunca enumera o dispositivo
+ */
+static void wait_for_terminal() {
+#ifdef PICO_VBUS_PIN
+    gpio_init(PICO_VBUS_PIN);
+    gpio_set_dir(PICO_VBUS_PIN, GPIO_IN);
+    if (!gpio_get(PICO_VBUS_PIN))
+        return;
+#endif
+    absolute_time_t limite = make_timeout_time_ms(usb_enum_ms);
+    while (!tud_mounted() && !time_reached(limite))
+        sleep_ms(10);
+    if (!tud_mounted())
+        return;
+    limite = make_timeout_time_ms(boot_wait_ms);
+    while (!stdio_usb_connected() && !time_reached(limite))
+        sleep_ms(10);
+}
+#endif
+
+/**
+ * Entra ou sai do modo USB Mass Storage
+ * Ao entrar o FatFs  desmontado e o carto inicializado para o computador;
+ * ao sair o carto volta a ser montado. Os callbacks do MSC rodam em
+ * interrupo neste mesmo ncleo, ento depois de msc_detach() nenhum acesso
+ * do computador ao carto est em andamento.
+ */
+static void set_modo_usb(bool ativar) {
+    sd_card_t *pSD = sd_get_by_num(0);
+    if (ativar) {
+        if (msc_is_active())
+            return;
+        if (mpu_logging_enabled) {
+            printf("[ERRO] Pare a captura ('i') antes de entrar no modo USB.\n");
+            Estado = 'E';
+            return;
+        }
+        if (pSD->mounted)
+            run_unmount();
+        Estado_montar_cartao = false;
+        if (pSD->init(pSD) & (STA_NOINIT | STA_NODISK)) {
+            printf("[ERRO] Carto SD no inicializou para o modo USB.\n");
+            Estado = 'E';
+            return;
+        }
+        msc_attach(pSD);
+        Estado = 'U';
+        printf("\nCarto SD disponvel no computador como disco USB.\n");
+        printf("Ejete o disco no computador, pressione o boto B ou use 'msc off' para voltar.\n");
+    } else {
+        msc_detach();
+        Estado = 'N';
+        printf("\nModo USB encerrado.\n");
+        set_montagem_cartao(true);
+    }
+}
+
+#if USE_LOW_POWER
+/**
+ * Troca o clock do sistema para o modo de baixo consumo ou de volta
+ * A amostragem  parada durante a troca, e os divisores do I2C e do SPI do
+ * SD so recalculados para o novo clk_peri, e o do PWM do buzzer para o
+ * novo clk_sys.
+ */
+static void set_baixo_consumo(bool ativar) {
+    acq_stop();
+    if (lp_set_reduced_clock(ativar)) {
+        i2c_set_baudrate(I2C_PORT, 400 * 1000);
+        i2c_set_baudrate(I2C_PORT_DISP, 400 * 1000);
+        ind_clock_changed();
+        sd_card_t *pSD = sd_get_by_num(0);
+        if (pSD->spi->negotiated_baud_rate)
+            sd_spi_go_high_frequency(pSD);
+    }
+    if (!start_acquisition())
+        Estado = 'E';
+}
+#endif
+
+/**
+ * Inicia ou encerra a captura (boto A e teclas 'h'/'i')
+ */
+static void set_coleta_dados(bool coletar) {
+    Estado = coletar ? 'I' : 'T';   // Estado: Iniciando / Terminando captura
+#if USE_LOW_POWER
+    if (coletar)
+        set_baixo_consumo(true);
+#endif
+    mpu_logging_request(coletar);
+#if USE_LOW_POWER
+    if (coletar && mpu_logging_enabled) {
+        lp_meter_start(&lp_meter, evt_sleep_us(), log_writer_busy_us(&mpu_writer));
+    } else {
+        lp_meter_report(&lp_meter, evt_sleep_us(), log_writer_busy_us(&mpu_writer),
+                        sample_counter, USE_DUAL_CORE, false);
+        set_baixo_consumo(false);
+    }
+#endif
+    printf("\nEscolha o comando (g = help):  ");
+    Estado_coleta_dados = coletar;
+}
+
+/**
+ * Comandos diretos de uma tecla
+ */
+static void process_key(int cRxedChar) {
+    switch (cRxedChar) {
+        case 'a':   // Monta o SD card
+            set_montagem_cartao(true);
+            break;
+
+        case 'b':   // Desmonta o SD card
+            set_montagem_cartao(false);
+            break;
+
+        case 'c':   // Lista arquivos
+            Estado = 'V';
+            printf("\nListagem de arquivos no carto SD.\n");
+            run_ls();      // As pginas e o prompt seguem em ls_service()
+            break;
+
+        case 'd':   // Exibe contedo do arquivo
+            Estado = 'L';
+            read_file(mpu_filename);
+            printf("Escolha o comando (g = help):  ");
+            break;
+
+        case 'e':   // Obtm espao livre no SD
+            Estado = 'S';
+            printf("\nObtendo espao livre no SD.\n\n");
+            run_getfree();
+            printf("\nEspao livre obtido.\n");
+            printf("\nEscolha o comando (g = help):  ");
+            break;
+
+        case 'f':   // Formata o SD card
+            Estado = 'F';
+            printf("\nProcesso de formatao do SD iniciado. Aguarde...\n");
+            run_format();
+            printf("\nFormatao concluda.\n\n");
+            printf("\nEscolha o comando (g = help):  ");
+            break;
+
+        case 'g':   // Exibe comandos disponveis
+            run_help();
+            Estado = 'H';
+            break;
+
+        case 'h':   // Inicia captura contnua do MPU6050
+            set_coleta_dados(true);
+            break;
+
+        case 'i':   // Para captura contnua do MPU6050
+            set_coleta_dados(false);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Consome todos os caracteres disponveis no terminal
+ */
+static void drain_stdio(void) {
+    console_service();          // Recebe da USB para o buffer do terminal
+    int cRxedChar;
+    while (PICO_ERROR_TIMEOUT != (cRxedChar = getchar_timeout_us(0))) {
+        if (ls_ativo) {
+            ls_stop(" (interrompido)");    // Qualquer tecla interrompe o ls
+            continue;
+        }
+        if (process_stdio(cRxedChar))
+            process_key(cRxedChar);
+    }
+}
+
+// Avisos em interrupo: apenas publicam o evento
+static void on_stdio_chars(void *param) {
+    evt_post(EVT_RX, 0);
+}
+
+#if !USE_DUAL_CORE
+static void on_samples_ready(void) {
+    evt_post(EVT_SAMPLES, 0);
+}
+#endif
+
 // ================================================================================
 // FUNO PRINCIPAL - MAIN LOOP
 // ================================================================================
@@ -927,18 +2768,27 @@ int main()
     // ============================================================================
     
     stdio_init_all();           // Inicializa comunicao serial
+    console_init();             // printf passa pelo buffer do terminal
+    evt_init();                 // Fila de eventos (antes das interrupes)
+    stdio_set_chars_available_callback(on_stdio_chars, NULL);
     iniciando_perifericos();    // Inicializa GPIOs
+    PROF_MARK("perifricos");
     
     // Sequncia de inicializao com LEDs
     Estado = 'A';               // Estado de inicializao
-    gpio_put(Led_verde, true);
-    gpio_put(Led_vermelho, true);
-    sleep_ms(5000);             // Aguarda 5 segundos
+    ind_led_set(IND_LED_GREEN | IND_LED_RED, 0, 0);
+#if !AUTO_START
+    wait_for_terminal();        // S com um computador conectado
+    PROF_MARK("terminal");
+#endif
     Estado = 'N';               // Estado normal
     
     // Inicializao de perifricos do sistema
     time_init();                // Inicializa sistema de tempo
     adc_init();                 // Inicializa conversor A/D
+#if USE_WIFI && !AUTO_START
+    wifi_init();                // Conecta em segundo plano
+#endif
 
     // ============================================================================
     // CONFIGURAO DO DISPLAY OLED (I2C1)
@@ -960,6 +2810,10 @@ int main()
     // Limpa o display inicialmente
     ssd1306_fill(&ssd, false);
     ssd1306_send_data(&ssd);
+#if USE_DISPLAY_DMA
+    ssd1306_dma_init(&ssd);
+#endif
+    PROF_MARK("display");
 
     // ============================================================================
     // CONFIGURAO DO MPU6050 (I2C0)
@@ -976,23 +2830,67 @@ int main()
     bi_decl(bi_2pins_with_func(I2C_SDA, I2C_SCL, GPIO_FUNC_I2C));
     
     // Reset e inicializao do MPU6050
-    mpu6050_reset();
+    mpu6050_reset(&mpu);
+#if ACQ_SECOND_MPU
+    // Segundo sensor no mesmo barramento, lido em rajadas intercaladas
+    mpu2_presente = mpu6050_probe(&mpu2);
+    if (mpu2_presente)
+        mpu6050_reset(&mpu2);
+    else
+        printf("[AVISO] Segundo MPU6050 (0x%02x) no encontrado; capturando s o primeiro.\n", mpu2.addr);
+    acq_set_sensors(&mpu, mpu2_presente ? &mpu2 : NULL);
+#else
+    acq_set_sensors(&mpu, NULL);
+#endif
+
+    att_init(&atitude, ATT_TAU_S, mpu.gyro_lsb_per_dps);
+
+#if USE_CRASH_BUFFER
+    recover_crash_buffer();
+#endif
+    acq_ring_reset();           // ndices fora da inicializao da RAM (ACQ_RETAIN_RING)
+
+    // Inicia a amostragem peridica do MPU6050 (FIFO do sensor ou timer de hardware)
+    if (!start_acquisition()) {
+        Estado = 'E';
+    }
+    PROF_MARK("MPU6050 e aquisio");
 
     // ============================================================================
     // INICIALIZAO DA INTERFACE DO USURIO
     // ============================================================================
     
-    // Variveis para dados do MPU6050
-    int16_t aceleracao[3], gyro[3], temp;
     bool cor = true;   // Varivel de controle de cor do display
+    absolute_time_t next_ui_time = get_absolute_time();
+    bool display_ligado = true;
 
     // Configurao inicial do terminal
     printf("FatFS SPI example\n");
     printf("\033[2J\033[H");    // Limpa tela do terminal
     printf("\n> ");
-    stdio_flush();
     run_help();                 // Exibe comandos disponveis
 
+#if USE_DUAL_CORE
+    // Ncleo 1 passa a consumir as amostras e a gravar no SD
+    multicore_launch_core1(core1_sd_writer);
+#endif
+
+#if AUTO_START
+    // Carto e captura antes do que pode esperar (Wi-Fi); o terminal v as
+    // mensagens se j estiver aberto
+    set_montagem_cartao(true);
+    PROF_MARK("montagem do SD");
+    if (sd_get_by_num(0)->mounted) {
+        set_coleta_dados(true);
+        PROF_MARK("incio da captura");
+    }
+#if USE_WIFI
+    wifi_init();
+    PROF_MARK("Wi-Fi");
+#endif
+#endif
+    prof_print_marks();
+
     // ============================================================================
     // LOOP PRINCIPAL DO SISTEMA
     // ============================================================================
@@ -1000,129 +2898,56 @@ int main()
     while (true)
     {
         // ========================================================================
-        // PROCESSAMENTO DE MUDANAS DE ESTADO VIA BOTES
+        // ESPERA E TRATAMENTO DE EVENTOS
         // ========================================================================
         
-        // Verifica mudana no estado de montagem do carto SD
-        if(Estado_montar_cartao != Estado_montar_cartao_prev){
-            if(Estado_montar_cartao){
-                Estado = 'M';   // Estado: Montando SD
-                printf("\nMontando o SD...\n");
-                run_mount();
-                printf("\nEscolha o comando (g = help):  ");
-            }else{
-                Estado = 'D';   // Estado: Desmontando SD
-                printf("\nDesmontando o SD. Aguarde...\n");
-                run_unmount();
-                printf("\nEscolha o comando (g = help):  ");
+        // Dorme em __wfe at um evento (botes, terminal, amostras, gravador
+        // do SD) ou at o prximo quadro do display
+        evt_t evento;
+        if (evt_wait_until(next_ui_time, &evento)) {
+            switch (evento.type) {
+                case EVT_BUTTON_A:  // Boto A: alterna a coleta de dados
+                    set_coleta_dados(!Estado_coleta_dados);
+                    break;
+                case EVT_BUTTON_B:  // Boto B: alterna a montagem do SD
+                    if (msc_is_active())
+                        set_modo_usb(false);    // No modo USB: devolve o carto
+                    else
+                        set_montagem_cartao(!Estado_montar_cartao);
+                    break;
+                case EVT_RX:        // Comandos via terminal
+                    drain_stdio();
+                    break;
+                default:            // Amostras e gravador: tratados abaixo
+                    break;
             }
-            Estado_montar_cartao_prev = Estado_montar_cartao;
+        } else {
+            // Prazo do display; l tambm o terminal caso o aviso de
+            // caracteres disponveis no seja suportado pelo stdio
+            drain_stdio();
         }
 
-        // Verifica mudana no estado de coleta de dados
-        if(Estado_coleta_dados != Estado_coleta_dados_prev){
-            if(Estado_coleta_dados){
-                Estado = 'I';   // Estado: Iniciando captura
-                start_mpu_logging();
-                printf("\nEscolha o comando (g = help):  ");
-            }else{
-                Estado = 'T';   // Estado: Terminando captura
-                stop_mpu_logging();
-                printf("\nEscolha o comando (g = help):  ");
-            }
-            Estado_coleta_dados_prev = Estado_coleta_dados;
-        }
-
-        // ========================================================================
-        // PROCESSAMENTO DE COMANDOS VIA TERMINAL
-        // ========================================================================
-        
-        // Verifica se h caracteres disponveis no terminal
-        int cRxedChar = getchar_timeout_us(0);
-        if (PICO_ERROR_TIMEOUT != cRxedChar)
-            process_stdio(cRxedChar);
-
-        // ========================================================================
-        // PROCESSAMENTO DE COMANDOS DIRETOS (TECLAS NICAS)
-        // ========================================================================
-        
-        if (cRxedChar == 'a') // Monta o SD card
-        {
-            Estado = 'M';
-            printf("\nMontando o SD...\n");
-            run_mount();
-            printf("\nEscolha o comando (g = help):  ");
-            Estado_montar_cartao = true;
-            Estado_montar_cartao_prev = true;
-        }
-        
-        if (cRxedChar == 'b') // Desmonta o SD card
-        {
-            Estado = 'D';
-            printf("\nDesmontando o SD. Aguarde...\n");
-            run_unmount();
-            printf("\nEscolha o comando (g = help):  ");
-            Estado_montar_cartao = false;
-            Estado_montar_cartao_prev = false;
-        }
-        
-        if (cRxedChar == 'c') // Lista arquivos
-        {
-            Estado = 'V';
-            printf("\nListagem de arquivos no carto SD.\n");
-            run_ls();
-            printf("\nListagem concluda.\n");
-            printf("\nEscolha o comando (g = help):  ");
-        }
-        
-        if (cRxedChar == 'd') // Exibe contedo do arquivo
-        {
-            Estado = 'L';
-            read_file(mpu_filename);
-            printf("Escolha o comando (g = help):  ");
-        }
-        
-        if (cRxedChar == 'e') // Obtm espao livre no SD
-        {
-            Estado = 'S';
-            printf("\nObtendo espao livre no SD.\n\n");
-            run_getfree();
-            printf("\nEspao livre obtido.\n");
-            printf("\nEscolha o comando (g = help):  ");
-        }
-        
-        if (cRxedChar == 'f') // Formata o SD card
-        {
-            Estado = 'F';
-            printf("\nProcesso de formatao do SD iniciado. Aguarde...\n");
-            run_format();
-            printf("\nFormatao concluda.\n\n");
-            printf("\nEscolha o comando (g = help):  ");
-        }
-        
-        if (cRxedChar == 'g') // Exibe comandos disponveis
-        {
-            run_help();
-            Estado = 'H';
-        }
-        
-        if (cRxedChar == 'h') // Inicia captura contnua do MPU6050
-        {
-            Estado = 'I';
-            start_mpu_logging();
-            printf("\nEscolha o comando (g = help):  ");
-            Estado_coleta_dados = true;
-            Estado_coleta_dados_prev = true;
-        }
-        
-        if (cRxedChar == 'i') // Para captura contnua do MPU6050
-        {
-            Estado = 'T';
-            stop_mpu_logging();
-            printf("\nEscolha o comando (g = help):  ");
-            Estado_coleta_dados = false;
-            Estado_coleta_dados_prev = false;
+        // Sada do terminal e amostras da telemetria: envia o que couber no
+        // buffer da USB
+        console_service();
+        ls_service();               // Prxima pgina do ls, se houver espao
+        tlm_service();
+#if USE_WIFI
+        wifi_poll();                // Terminal remoto e pacotes UDP
+#endif
+
+        // Disco ejetado pelo computador: o carto volta ao FatFs
+        if (msc_take_eject())
+            set_modo_usb(false);
+
+#if USE_TRIGGER
+        // Bipe a cada evento disparado pelo consumidor das amostras
+        static uint32_t eventos_sinalizados = 0;
+        if (eventos_gravados != eventos_sinalizados) {
+            eventos_sinalizados = eventos_gravados;
+            buzzer_signal(Som_evento);
         }
+#endif
 
         // ========================================================================
         // CONTROLE DE LEDs E BUZZER BASEADO NO ESTADO
@@ -1180,6 +3005,13 @@ int main()
                 buzzer_signal(Som_erro);
                 break;
                 
+            case 'U':   // Estado: Modo USB (Ciano)
+                Estado_led_verde = true;
+                Estado_led_azul = true;
+                Estado_led_vermelho = false;
+                buzzer_signal(som_leitura);
+                break;
+
             case 'N':   // Estado: Normal (Branco)
                 Estado_led_verde = true;
                 Estado_led_azul = true;
@@ -1190,134 +3022,179 @@ int main()
                 break;
             }
             estado_fut = Estado;
-        }
 
-        // Atualiza os LEDs fisicamente
-        gpio_put(Led_verde, Estado_led_verde);
-        gpio_put(Led_azul, Estado_led_azul);
-        gpio_put(Led_vermelho, Estado_led_vermelho);
+            // Atualiza os LEDs; no erro o vermelho pisca
+            uint8_t cores = (Estado_led_verde ? IND_LED_GREEN : 0) |
+                            (Estado_led_azul ? IND_LED_BLUE : 0) |
+                            (Estado_led_vermelho ? IND_LED_RED : 0);
+            if (Estado == 'E')
+                ind_led_set(cores, 250, 250);
+#if USE_LOW_POWER
+            else if (Estado == 'I')
+                ind_led_set(cores, 20, 1980);   // Pulso curto: mantm o LED quase sempre apagado
+#endif
+            else
+                ind_led_set(cores, 0, 0);
+        }
 
         // ========================================================================
         // LEITURA E PROCESSAMENTO DE DADOS DO MPU6050
         // ========================================================================
         
-        // L dados brutos do MPU6050
-        mpu6050_read_raw(aceleracao, gyro, &temp);
-
-        // Converte acelerao para unidades de 'g' (gravidade terrestre)
-        float ax = aceleracao[0] / 16384.0f;
-        float ay = aceleracao[1] / 16384.0f;
-        float az = aceleracao[2] / 16384.0f;
-
-        // Calcula ngulos Roll e Pitch em graus
-        float roll  = atan2(ay, az) * 180.0f / M_PI;
-        float pitch = atan2(-ax, sqrt(ay*ay + az*az)) * 180.0f / M_PI;
-
-        // Captura dados para arquivo CSV se o logging estiver ativo
-        if (mpu_logging_enabled && absolute_time_diff_us(get_absolute_time(), next_mpu_log_time) <= 0) {
-            capture_mpu_data_to_csv(aceleracao, gyro, roll, pitch);
-            next_mpu_log_time = make_timeout_time_ms(mpu_log_period);
-        }
+#if !USE_DUAL_CORE
+        // Consome todas as amostras acumuladas pelo motor de aquisio
+        drain_mpu_samples();
+#endif
 
         // ========================================================================
         // ATUALIZAO DO DISPLAY OLED
         // ========================================================================
         
-        ssd1306_fill(&ssd, !cor);  // Limpa o display
+        // O display  redesenhado no seu prprio ritmo, sem afetar a amostragem
+        // (e s depois que o quadro anterior terminou de ser enviado)
+        if (!time_reached(next_ui_time))
+            continue;
+        if (ssd1306_busy(&ssd)) {
+            next_ui_time = make_timeout_time_ms(2);
+            continue;
+        }
+        next_ui_time = make_timeout_time_ms(ui_period_ms);
+
+#if USE_LOW_POWER
+        // Painel apagado durante a captura; indicao s pelo LED
+        if (display_ligado == mpu_logging_enabled) {
+            display_ligado = !mpu_logging_enabled;
+            ssd1306_set_power(&ssd, display_ligado);
+        }
+        if (!display_ligado)
+            continue;
+#endif
+
+        // Atitude filtrada pelo consumidor das amostras
+        float roll = atitude.roll, pitch = atitude.pitch;
+
+        // A moldura e os rtulos de cada tela so desenhados uma vez e
+        // guardados; nos quadros seguintes basta restaur-los e redesenhar os
+        // campos variveis, e s os bytes alterados seguem pelo I2C
+        uint16_t tela = (uint8_t)Estado | (cor << 8) | (Estado_montar_cartao << 9);
+        bool fundo_ok = ssd1306_restore_background(&ssd, tela);
+
+        if (!fundo_ok) {
+            ssd1306_fill(&ssd, !cor);  // Limpa o display
+
+            // Exibe diferentes telas baseadas no estado atual
+            if(Estado == 'I'){  // Tela de captura ativa
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 25, 123, 25, cor);
+                ssd1306_line(&ssd, 3, 37, 123, 37, cor);
+                ssd1306_draw_string(&ssd, "CAPTURANDO", 22, 6);
+                ssd1306_draw_string(&ssd, "DADOS", 33, 16);
+                ssd1306_draw_string(&ssd, "IMU    MPU6050", 10, 28);
+                ssd1306_line(&ssd, 63, 35, 63, 60, cor);
+                ssd1306_draw_string(&ssd, "roll", 14, 41);
+                ssd1306_draw_string(&ssd, "pitch", 73, 41);
+            }
+            else if((Estado == 'N') || (Estado == 'D') || (Estado == 'M')){  // Tela inicial/status
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_line(&ssd, 3, 47, 123, 47, cor);
+                ssd1306_draw_string(&ssd, "SISTEMA", 35, 8);
+                ssd1306_draw_string(&ssd, "INICIADO", 33, 20);
+                if(Estado_montar_cartao){
+                    ssd1306_draw_string(&ssd, "SD: MONTADO", 18, 36);
+                }else{
+                    ssd1306_draw_string(&ssd, "SD: DESMONTADO", 8, 36);
+                }
+                ssd1306_draw_string(&ssd, "g=HELP", 35, 52);
+            }
+            else if(Estado == 'V'){  // Tela de visualizao
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 18, 123, 18, cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_draw_string(&ssd, "DADOS DO SD", 22, 8);
+                ssd1306_draw_string(&ssd, "VISUALIZACAO", 15, 20);
+                ssd1306_draw_string(&ssd, "LISTA DE", 30, 32);
+                ssd1306_draw_string(&ssd, "ARQUIVOS", 30, 42);
+                ssd1306_draw_string(&ssd, "NO TERMINAL", 22, 52);
+            }
+            else if(Estado == 'L'){  // Tela de leitura
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 18, 123, 18, cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_draw_string(&ssd, "DADOS DO SD", 22, 8);
+                ssd1306_draw_string(&ssd, "LEITURA", 33, 20);
+                ssd1306_draw_string(&ssd, "LEITURA DOS", 26, 32);
+                ssd1306_draw_string(&ssd, "DADOS", 38, 42);
+                ssd1306_draw_string(&ssd, "NO TERMINAL", 22, 52);
+            }
+            else if(Estado == 'T'){  // Tela de captura finalizada
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_line(&ssd, 3, 47, 123, 47, cor);
+                ssd1306_draw_string(&ssd, "DADOS GRAVADOS", 9, 8);
+                ssd1306_draw_string(&ssd, "NO CARTAO SD", 15, 20);
+                ssd1306_draw_string(&ssd, "N AMOSTRAS:", 8, 35);
+                ssd1306_draw_string(&ssd, "NOME: mpu_data", 5, 50);
+            }
+            else if(Estado == 'E'){  // Tela de erro
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_line(&ssd, 3, 47, 123, 47, cor);
+                ssd1306_draw_string(&ssd, "ERRO DE COMANDO", 3, 8);
+                ssd1306_draw_string(&ssd, "VERIFIQUE", 22, 20);
+                if(Estado_montar_cartao){
+                    ssd1306_draw_string(&ssd, "SD: MONTADO", 18, 36);
+                }else{
+                    ssd1306_draw_string(&ssd, "SD: DESMONTADO", 8, 36);
+                }
+                ssd1306_draw_string(&ssd, "g=HELP", 35, 52);
+            }
+            else if(Estado == 'U'){  // Tela do modo USB
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 18, 123, 18, cor);
+                ssd1306_line(&ssd, 3, 30, 123, 30, cor);
+                ssd1306_draw_string(&ssd, "MODO USB", 33, 8);
+                ssd1306_draw_string(&ssd, "DISCO NO PC", 22, 20);
+                ssd1306_draw_string(&ssd, "EJETE O DISCO", 12, 34);
+                ssd1306_draw_string(&ssd, "OU BOTAO B", 25, 46);
+            }
+            else if(Estado == 'H'){  // Tela de ajuda
+                ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
+                ssd1306_line(&ssd, 3, 18, 123, 18, cor);
+                ssd1306_draw_string(&ssd, "BITDOGLAB", 24, 8);
+                ssd1306_draw_string(&ssd, "BO A=MONTAR", 6, 22);
+                ssd1306_draw_string(&ssd, "BO A=DESMONTAR", 6, 32);
+                ssd1306_draw_string(&ssd, "BO B=INICI CAP", 6, 42);
+                ssd1306_draw_string(&ssd, "BO B=ENCER CAP", 6, 52);
+            }
+
+            ssd1306_save_background(&ssd, tela);
+        }
 
-        // Exibe diferentes telas baseadas no estado atual
-        if(Estado == 'I'){  // Tela de captura ativa
+        // Campos variveis, desenhados sobre o fundo a cada quadro
+        if(Estado == 'I'){
             char str_roll[20];
             char str_pitch[20];
 
             snprintf(str_roll,  sizeof(str_roll),  "%5.1f", roll);
             snprintf(str_pitch, sizeof(str_pitch), "%5.1f", pitch);
-
-            // Desenha interface de captura
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 25, 123, 25, cor);
-            ssd1306_line(&ssd, 3, 37, 123, 37, cor);
-            ssd1306_draw_string(&ssd, "CAPTURANDO", 22, 6);
-            ssd1306_draw_string(&ssd, "DADOS", 33, 16);
-            ssd1306_draw_string(&ssd, "IMU    MPU6050", 10, 28);
-            ssd1306_line(&ssd, 63, 35, 63, 60, cor);
-            ssd1306_draw_string(&ssd, "roll", 14, 41);
             ssd1306_draw_string(&ssd, str_roll, 14, 52);
-            ssd1306_draw_string(&ssd, "pitch", 73, 41);
             ssd1306_draw_string(&ssd, str_pitch, 73, 52);
         }
-        else if((Estado == 'N') || (Estado == 'D') || (Estado == 'M')){  // Tela inicial/status
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 30, 123, 30, cor);
-            ssd1306_line(&ssd, 3, 47, 123, 47, cor);
-            ssd1306_draw_string(&ssd, "SISTEMA", 35, 8);
-            ssd1306_draw_string(&ssd, "INICIADO", 33, 20);
-            if(Estado_montar_cartao){
-                ssd1306_draw_string(&ssd, "SD: MONTADO", 18, 36);
-            }else{
-                ssd1306_draw_string(&ssd, "SD: DESMONTADO", 8, 36);
-            }
-            ssd1306_draw_string(&ssd, "g=HELP", 35, 52);
-        }
-        else if(Estado == 'V'){  // Tela de visualizao
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 18, 123, 18, cor);
-            ssd1306_line(&ssd, 3, 30, 123, 30, cor);
-            ssd1306_draw_string(&ssd, "DADOS DO SD", 22, 8);
-            ssd1306_draw_string(&ssd, "VISUALIZACAO", 15, 20);
-            ssd1306_draw_string(&ssd, "LISTA DE", 30, 32);
-            ssd1306_draw_string(&ssd, "ARQUIVOS", 30, 42);
-            ssd1306_draw_string(&ssd, "NO TERMINAL", 22, 52);
-        }
-        else if(Estado == 'L'){  // Tela de leitura
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 18, 123, 18, cor);
-            ssd1306_line(&ssd, 3, 30, 123, 30, cor);
-            ssd1306_draw_string(&ssd, "DADOS DO SD", 22, 8);
-            ssd1306_draw_string(&ssd, "LEITURA", 33, 20);
-            ssd1306_draw_string(&ssd, "LEITURA DOS", 26, 32);
-            ssd1306_draw_string(&ssd, "DADOS", 38, 42);
-            ssd1306_draw_string(&ssd, "NO TERMINAL", 22, 52);
-        }
-        else if(Estado == 'T'){  // Tela de captura finalizada
+        else if(Estado == 'T'){
             char str_amostras[20];
             snprintf(str_amostras, sizeof(str_amostras), "%d", sample_counter);
-
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 30, 123, 30, cor);
-            ssd1306_line(&ssd, 3, 47, 123, 47, cor);
-            ssd1306_draw_string(&ssd, "DADOS GRAVADOS", 9, 8);
-            ssd1306_draw_string(&ssd, "NO CARTAO SD", 15, 20);
-            ssd1306_draw_string(&ssd, "N AMOSTRAS:", 8, 35);
             ssd1306_draw_string(&ssd, str_amostras, 100, 35);
-            ssd1306_draw_string(&ssd, "NOME: mpu_data", 5, 50);
-        }
-        else if(Estado == 'E'){  // Tela de erro
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 30, 123, 30, cor);
-            ssd1306_line(&ssd, 3, 47, 123, 47, cor);
-            ssd1306_draw_string(&ssd, "ERRO DE COMANDO", 3, 8);
-            ssd1306_draw_string(&ssd, "VERIFIQUE", 22, 20);
-            if(Estado_montar_cartao){
-                ssd1306_draw_string(&ssd, "SD: MONTADO", 18, 36);
-            }else{
-                ssd1306_draw_string(&ssd, "SD: DESMONTADO", 8, 36);
-            }
-            ssd1306_draw_string(&ssd, "g=HELP", 35, 52);
-        }
-        else if(Estado == 'H'){  // Tela de ajuda
-            ssd1306_rect(&ssd, 3, 3, 122, 60, cor, !cor);
-            ssd1306_line(&ssd, 3, 18, 123, 18, cor);
-            ssd1306_draw_string(&ssd, "BITDOGLAB", 24, 8);
-            ssd1306_draw_string(&ssd, "BO A=MONTAR", 6, 22);
-            ssd1306_draw_string(&ssd, "BO A=DESMONTAR", 6, 32);
-            ssd1306_draw_string(&ssd, "BO B=INICI CAP", 6, 42);
-            ssd1306_draw_string(&ssd, "BO B=ENCER CAP", 6, 52);
         }
        
-        // Envia dados atualizados para o display
+        // Envia dados atualizados para o display (com DMA, mede s o disparo)
+        PROF_START(t_display);
+#if USE_DISPLAY_DMA
+        ssd1306_send_data_async(&ssd, NULL, NULL);
+#else
         ssd1306_send_data(&ssd);
-        sleep_ms(500);  // Delay para atualizao da tela
+#endif
+        PROF_STOP(PROF_DISPLAY, t_display);
     }
     
     return 0;
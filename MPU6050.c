@@ -6,58 +6,315 @@
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
-// Definição dos pinos I2C para o MPU6050
-#define I2C_PORT i2c0                 // I2C0 usa pinos 0 e 1
-#define I2C_SDA 0
-#define I2C_SCL 1
+// Registradores de identificação, das faixas de medida e do filtro
+#define MPU6050_REG_GYRO_CONFIG  0x1B
+#define MPU6050_REG_ACCEL_CONFIG 0x1C
+#define MPU6050_REG_CONFIG       0x1A    // DLPF_CFG nos bits 2:0
+#define MPU6050_REG_WHO_AM_I     0x75
+#define MPU6050_WHO_AM_I_VALUE   0x68    // Independe do pino AD0
 
-// Endereço padrão do MPU6050
-static int addr = 0x68;
+// Escreve um registrador do sensor
+static void mpu6050_write_reg(const mpu6050_t *dev, uint8_t reg, uint8_t value)
+{
+    uint8_t buf[] = {reg, value};
+    i2c_write_blocking(dev->port, dev->addr, buf, 2, false);
+}
 
 // Função para resetar e inicializar o MPU6050
-void mpu6050_reset()
+void mpu6050_reset(mpu6050_t *dev)
 {
     // Dois bytes para reset: primeiro o registrador, segundo o dado
-    uint8_t buf[] = {0x6B, 0x80};
-    i2c_write_blocking(I2C_PORT, addr, buf, 2, false);
+    mpu6050_write_reg(dev, 0x6B, 0x80);
     sleep_ms(100); // Aguarda reset e estabilização
 
     // Sai do modo sleep (registrador 0x6B, valor 0x00)
-    buf[1] = 0x00;
-    i2c_write_blocking(I2C_PORT, addr, buf, 2, false);
+    mpu6050_write_reg(dev, 0x6B, 0x00);
     sleep_ms(10); // Aguarda estabilização após acordar
+
+    // Faixas de medida: ±2 g / ±250 °/s correspondem a 16384 LSB/g e 131 LSB/(°/s)
+    dev->accel_range &= 3;
+    dev->gyro_range &= 3;
+    mpu6050_write_reg(dev, MPU6050_REG_ACCEL_CONFIG, (uint8_t)(dev->accel_range << 3));
+    mpu6050_write_reg(dev, MPU6050_REG_GYRO_CONFIG, (uint8_t)(dev->gyro_range << 3));
+    dev->dlpf = dev->dlpf > 6 ? 6 : dev->dlpf;
+    mpu6050_write_reg(dev, MPU6050_REG_CONFIG, dev->dlpf);
+    dev->accel_lsb_per_g = 16384.0f / (float)(1 << dev->accel_range);
+    dev->gyro_lsb_per_dps = 131.0f / (float)(1 << dev->gyro_range);
 }
 
-// Função para ler dados crus do acelerômetro, giroscópio e temperatura
-void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp)
+// Lê o WHO_AM_I; false se o sensor não responder no endereço
+bool mpu6050_probe(const mpu6050_t *dev)
 {
-    uint8_t buffer[6];
+    uint8_t reg = MPU6050_REG_WHO_AM_I;
+    uint8_t id = 0;
+    if (i2c_write_timeout_us(dev->port, dev->addr, &reg, 1, true, 2000) != 1)
+        return false;
+    if (i2c_read_timeout_us(dev->port, dev->addr, &id, 1, false, 2000) != 1)
+        return false;
+    return (id & 0x7E) == MPU6050_WHO_AM_I_VALUE;
+}
 
-    // Lê aceleração a partir do registrador 0x3B (6 bytes)
-    uint8_t val = 0x3B;
-    i2c_write_blocking(I2C_PORT, addr, &val, 1, true);
-    i2c_read_blocking(I2C_PORT, addr, buffer, 6, false);
+// Registrador inicial do bloco de dados: ACCEL_XOUT_H (0x3B) até GYRO_ZOUT_L (0x48)
+#define MPU6050_REG_ACCEL_XOUT_H 0x3B
+#define MPU6050_BURST_LEN 14
 
+// Decodifica o bloco de 14 bytes: aceleração (6), temperatura (2), giroscópio (6)
+static void mpu6050_decode(const uint8_t buffer[MPU6050_BURST_LEN],
+                           int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
     for (int i = 0; i < 3; i++)
     {
         accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+        gyro[i] = (buffer[8 + i * 2] << 8) | buffer[8 + (i * 2) + 1];
     }
+    *temp = (buffer[6] << 8) | buffer[7];
+}
 
-    // Lê giroscópio a partir do registrador 0x43 (6 bytes)
-    val = 0x43;
-    i2c_write_blocking(I2C_PORT, addr, &val, 1, true);
-    i2c_read_blocking(I2C_PORT, addr, buffer, 6, false);
+// Função para ler dados crus do acelerômetro, giroscópio e temperatura
+// Uma única transação I2C em rajada: todos os valores vêm do mesmo ciclo
+// de atualização do sensor
+void mpu6050_read_raw(const mpu6050_t *dev, int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
+    uint8_t buffer[MPU6050_BURST_LEN];
 
-    for (int i = 0; i < 3; i++)
+    uint8_t val = MPU6050_REG_ACCEL_XOUT_H;
+    i2c_write_blocking(dev->port, dev->addr, &val, 1, true);
+    i2c_read_blocking(dev->port, dev->addr, buffer, MPU6050_BURST_LEN, false);
+
+    mpu6050_decode(buffer, accel, gyro, temp);
+}
+
+// ================================================================================
+// LEITURA EM RAJADA VIA DMA (NÃO BLOQUEANTE)
+// ================================================================================
+
+// Comandos para o registrador IC_DATA_CMD: 1 escrita do endereço do
+// registrador seguida de 14 leituras (restart na primeira, stop na última)
+// Os canais e o buffer servem a todos os sensores, uma rajada por vez
+static uint32_t dma_cmds[1 + MPU6050_BURST_LEN];
+static uint8_t dma_rx[MPU6050_BURST_LEN];
+static int dma_tx_chan = -1;
+static int dma_rx_chan = -1;
+static const mpu6050_t *dma_dev = NULL;       // Sensor da rajada pendente
+
+// Desabilita o controlador e aguarda que ele pare de fato: o TAR só pode
+// ser escrito com IC_ENABLE_STATUS.IC_EN em 0, o que leva até o fim do byte
+// em andamento. Retorna false se o barramento não liberou em 1 ms
+static bool i2c_disable_wait(i2c_hw_t *hw)
+{
+    hw->enable = 0;
+    absolute_time_t timeout = make_timeout_time_ms(1);
+    while (hw->enable_status & I2C_IC_ENABLE_STATUS_IC_EN_BITS)
+    {
+        if (time_reached(timeout))
+            return false;
+    }
+    return true;
+}
+
+// Reserva os canais DMA e monta a sequência de comandos da rajada
+void mpu6050_dma_init(void)
+{
+    if (dma_tx_chan >= 0)
+        return;
+
+    dma_cmds[0] = MPU6050_REG_ACCEL_XOUT_H;
+    for (int i = 0; i < MPU6050_BURST_LEN; i++)
+        dma_cmds[1 + i] = I2C_IC_DATA_CMD_CMD_BITS;
+    dma_cmds[1] |= I2C_IC_DATA_CMD_RESTART_BITS;
+    dma_cmds[MPU6050_BURST_LEN] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    dma_tx_chan = dma_claim_unused_channel(true);
+    dma_rx_chan = dma_claim_unused_channel(true);
+}
+
+// Dispara a leitura em rajada; retorna imediatamente
+// Retorna false se já houver uma leitura em andamento
+bool mpu6050_read_raw_dma_start(const mpu6050_t *dev)
+{
+    if (dma_dev)
+        return false;
+
+    i2c_hw_t *hw = i2c_get_hw(dev->port);
+    if (!i2c_disable_wait(hw))
     {
-        gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+        hw->enable = 1;
+        return false;
     }
+    hw->tar = dev->addr;
+    hw->enable = 1;
+
+    dma_channel_config rx_cfg = dma_channel_get_default_config(dma_rx_chan);
+    channel_config_set_transfer_data_size(&rx_cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx_cfg, false);
+    channel_config_set_write_increment(&rx_cfg, true);
+    channel_config_set_dreq(&rx_cfg, i2c_get_dreq(dev->port, false));
+    dma_channel_configure(dma_rx_chan, &rx_cfg, dma_rx, &hw->data_cmd,
+                          MPU6050_BURST_LEN, true);
+
+    dma_channel_config tx_cfg = dma_channel_get_default_config(dma_tx_chan);
+    channel_config_set_transfer_data_size(&tx_cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx_cfg, true);
+    channel_config_set_write_increment(&tx_cfg, false);
+    channel_config_set_dreq(&tx_cfg, i2c_get_dreq(dev->port, true));
+    dma_channel_configure(dma_tx_chan, &tx_cfg, &hw->data_cmd, dma_cmds,
+                          count_of(dma_cmds), true);
+
+    dma_dev = dev;
+    return true;
+}
 
-    // Lê temperatura a partir do registrador 0x41 (2 bytes)
-    val = 0x41;
-    i2c_write_blocking(I2C_PORT, addr, &val, 1, true);
-    i2c_read_blocking(I2C_PORT, addr, buffer, 2, false);
+// Indica se a leitura via DMA ainda está em andamento
+bool mpu6050_read_raw_dma_busy(void)
+{
+    return dma_dev && dma_channel_is_busy(dma_rx_chan);
+}
 
-    *temp = (buffer[0] << 8) | buffer[1];
+// Aguarda o fim da leitura via DMA e decodifica os dados
+// Retorna false se não havia leitura pendente ou se o sensor não respondeu
+bool mpu6050_read_raw_dma_finish(int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
+    if (!dma_dev)
+        return false;
+
+    i2c_hw_t *hw = i2c_get_hw(dma_dev->port);
+    absolute_time_t timeout = make_timeout_time_ms(2);
+    bool aborted = false;
+    while (dma_channel_is_busy(dma_rx_chan))
+    {
+        // NACK ou perda de arbitragem: o controlador descarta os comandos
+        if ((hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) || time_reached(timeout))
+        {
+            aborted = true;
+            break;
+        }
+    }
+    if (aborted)
+    {
+        // Para o controlador antes de liberar os canais, descarta o que
+        // sobrou na FIFO e limpa a causa do abort para a próxima rajada
+        i2c_disable_wait(hw);
+        dma_channel_abort(dma_tx_chan);
+        dma_channel_abort(dma_rx_chan);
+        (void)hw->clr_tx_abrt;
+        hw->enable = 1;
+    }
+    dma_dev = NULL;
+    if (aborted)
+        return false;
+
+    mpu6050_decode(dma_rx, accel, gyro, temp);
+    return true;
+}
+
+// ================================================================================
+// MODO FIFO COM INTERRUPÇÃO DE DADO PRONTO
+// ================================================================================
+
+// Registradores de configuração da taxa, da FIFO e das interrupções
+#define MPU6050_REG_SMPLRT_DIV  0x19
+#define MPU6050_REG_FIFO_EN     0x23
+#define MPU6050_REG_INT_PIN_CFG 0x37
+#define MPU6050_REG_INT_ENABLE  0x38
+#define MPU6050_REG_INT_STATUS  0x3A
+#define MPU6050_REG_USER_CTRL   0x6A
+#define MPU6050_REG_FIFO_COUNTH 0x72
+#define MPU6050_REG_FIFO_R_W    0x74
+
+// FIFO_EN: temperatura, giroscópio X/Y/Z e acelerômetro. A FIFO grava na
+// ordem dos registradores, portanto cada registro tem o mesmo leiaute de
+// 14 bytes da leitura em rajada
+#define MPU6050_FIFO_EN_TEMP_GYRO_ACCEL 0xF8
+#define MPU6050_USER_CTRL_FIFO_EN       0x40
+#define MPU6050_USER_CTRL_FIFO_RESET    0x04
+#define MPU6050_INT_ENABLE_FIFO_OFLOW   0x10
+#define MPU6050_INT_ENABLE_DATA_RDY     0x01
+
+// Configura a taxa de saída de dados: com o filtro passa-baixa ativo
+// (DLPF_CFG de 1 a 6; sem filtro configurado usa 1, 188 Hz) o giroscópio é
+// amostrado a 1 kHz e a taxa final é 1 kHz / (1 + SMPLRT_DIV)
+// Retorna a taxa efetivamente configurada
+uint32_t mpu6050_set_sample_rate(const mpu6050_t *dev, uint32_t rate_hz)
+{
+    if (rate_hz == 0)
+        rate_hz = 1;
+    if (rate_hz > 1000)
+        rate_hz = 1000;
+    uint32_t div = 1000u / rate_hz - 1u;
+    if (div > 255)
+        div = 255;
+
+    mpu6050_write_reg(dev, MPU6050_REG_CONFIG, dev->dlpf ? dev->dlpf : 0x01);
+    mpu6050_write_reg(dev, MPU6050_REG_SMPLRT_DIV, (uint8_t)div);
+    return 1000u / (1u + div);
+}
+
+// Habilita (ou desabilita) a FIFO interna de 1024 bytes para aceleração,
+// temperatura e giroscópio, e a interrupção de dado pronto no pino INT
+// (ativo em nível alto, push-pull, pulso de 50 us)
+void mpu6050_fifo_enable(const mpu6050_t *dev, bool enable)
+{
+    mpu6050_write_reg(dev, MPU6050_REG_FIFO_EN, 0x00);
+    mpu6050_write_reg(dev, MPU6050_REG_INT_ENABLE, 0x00);
+    mpu6050_write_reg(dev, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET);
+    if (!enable)
+        return;
+
+    mpu6050_write_reg(dev, MPU6050_REG_INT_PIN_CFG, 0x00);
+    mpu6050_write_reg(dev, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+    mpu6050_write_reg(dev, MPU6050_REG_FIFO_EN, MPU6050_FIFO_EN_TEMP_GYRO_ACCEL);
+    mpu6050_write_reg(dev, MPU6050_REG_INT_ENABLE,
+                      MPU6050_INT_ENABLE_FIFO_OFLOW | MPU6050_INT_ENABLE_DATA_RDY);
+}
+
+// Esvazia a FIFO e realinha os registros, mantendo-a habilitada
+void mpu6050_fifo_reset(const mpu6050_t *dev)
+{
+    mpu6050_write_reg(dev, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET);
+    mpu6050_write_reg(dev, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+}
+
+// Lê (e limpa) o registrador de estado das interrupções
+uint8_t mpu6050_int_status(const mpu6050_t *dev)
+{
+    uint8_t reg = MPU6050_REG_INT_STATUS;
+    uint8_t status = 0;
+    i2c_write_blocking(dev->port, dev->addr, &reg, 1, true);
+    i2c_read_blocking(dev->port, dev->addr, &status, 1, false);
+    return status;
+}
+
+// Número de bytes armazenados na FIFO
+uint16_t mpu6050_fifo_count(const mpu6050_t *dev)
+{
+    uint8_t reg = MPU6050_REG_FIFO_COUNTH;
+    uint8_t buf[2];
+    i2c_write_blocking(dev->port, dev->addr, &reg, 1, true);
+    i2c_read_blocking(dev->port, dev->addr, buf, 2, false);
+    return (uint16_t)((buf[0] << 8) | buf[1]);
+}
+
+// Lê até max_samples registros completos da FIFO em uma única transação
+// (FIFO_R_W não incrementa o endereço, cada byte lido sai da fila)
+// Retorna o número de registros lidos
+int mpu6050_fifo_read(const mpu6050_t *dev, uint8_t *buffer, int max_samples)
+{
+    int n = mpu6050_fifo_count(dev) / MPU6050_FIFO_SAMPLE_SIZE;
+    if (n > max_samples)
+        n = max_samples;
+    if (n <= 0)
+        return 0;
+
+    uint8_t reg = MPU6050_REG_FIFO_R_W;
+    i2c_write_blocking(dev->port, dev->addr, &reg, 1, true);
+    i2c_read_blocking(dev->port, dev->addr, buffer, n * MPU6050_FIFO_SAMPLE_SIZE, false);
+    return n;
+}
+
+// Decodifica um registro da FIFO (mesmo leiaute da leitura em rajada)
+void mpu6050_fifo_decode(const uint8_t *record, int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
+    mpu6050_decode(record, accel, gyro, temp);
 }
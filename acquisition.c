@@ -0,0 +1,553 @@
+/*
+ * ================================================================================
+ * MOTOR DE AQUISIÇÃO DO MPU6050
+ * ================================================================================
+ *
+ * O timer repetitivo do Pico SDK dispara na taxa configurada e lê o sensor no
+ * contexto da interrupção. Cada leitura é gravada no buffer circular; o laço
+ * principal (display, LEDs, console e gravação no SD) consome as amostras no
+ * seu próprio ritmo, sem afetar o instante de amostragem.
+ *
+ * No modo FIFO o próprio sensor amostra na taxa do seu divisor interno e
+ * acumula os registros na FIFO de 1024 bytes; o pulso de dado pronto no pino
+ * INT marca o instante de cada amostra e a FIFO é esvaziada em rajadas. As
+ * leituras I2C da FIFO levam milissegundos e não cabem na interrupção da
+ * GPIO: ela apenas marca uma interrupção de software de prioridade mínima,
+ * que as do SD, da USB, do DMA e dos timers podem interromper.
+ *
+ * Com um segundo sensor no barramento os canais DMA são compartilhados: o
+ * timer dispara a cada meio período e alterna as rajadas, a do primeiro
+ * sensor no início do período e a do segundo no meio. Sem DMA as duas
+ * leituras bloqueantes ocorrem em sequência no mesmo callback.
+ *
+ * O buffer é lock-free para um produtor (a interrupção do timer ou a de
+ * software do modo FIFO) e um consumidor: o produtor só escreve `head` e o
+ * consumidor só escreve `tail`.
+ * O consumidor pode estar no outro núcleo; estatísticas e última amostra são
+ * protegidas por um spin lock de hardware.
+ * ================================================================================
+ */
+
+#include "acquisition.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "MPU6050.h"
+#include "prof.h"
+
+// Leitura em rajada via DMA: a transferência I2C de um período ocorre em
+// segundo plano e é concluída no período seguinte
+#ifndef ACQ_USE_DMA
+#define ACQ_USE_DMA 1
+#endif
+
+#if (ACQ_RING_SIZE & (ACQ_RING_SIZE - 1)) != 0
+#error "ACQ_RING_SIZE deve ser potência de 2"
+#endif
+
+// ================================================================================
+// ESTADO DO MOTOR DE AQUISIÇÃO
+// ================================================================================
+
+#if ACQ_RETAIN_RING
+// Preservados em reset (como rtc_save em rtc.c); zerados por acq_ring_reset
+#define ACQ_RETAINED __attribute__((section(".uninitialized_data")))
+#else
+#define ACQ_RETAINED
+#endif
+
+static mpu_sample_t ring[ACQ_RING_SIZE] ACQ_RETAINED;
+static volatile uint32_t head ACQ_RETAINED;   // Próxima posição de escrita (produtor)
+static volatile uint32_t tail ACQ_RETAINED;   // Próxima posição de leitura (consumidor)
+
+static const mpu6050_t *sensor = NULL;        // Sensor principal
+#if ACQ_SECOND_MPU
+static const mpu6050_t *sensor2 = NULL;       // Segundo sensor (NULL = ausente)
+#if ACQ_USE_DMA
+static mpu_sample_t pair;                     // Leitura do primeiro sensor aguardando a do segundo
+static bool pair_ok = false;                  // Rajada do primeiro sensor concluída
+static bool second_half = false;              // Próximo callback é o do meio do período
+#endif
+#endif
+
+static repeating_timer_t timer;
+static volatile bool running = false;
+static volatile acq_mode_t mode = ACQ_MODE_TIMER;
+static uint32_t seq = 0;
+static uint64_t last_sample_us = 0;
+#if ACQ_USE_DMA
+static uint64_t dma_start_us = 0;             // Instante em que a rajada pendente foi disparada
+#endif
+static uint64_t last_drain_us = 0;            // Última leitura da FIFO do sensor
+static uint32_t drain_interval_us = 0;        // Intervalo entre leituras da FIFO
+static int drain_irq = -1;                    // Interrupção de software do esvaziamento
+
+static volatile acq_stats_t stats;
+
+static acq_ready_cb_t ready_cb = NULL;        // Aviso de amostras acumuladas
+static uint32_t ready_batch = 1;
+static volatile mpu_sample_t latest;          // Última amostra, para a interface
+static spin_lock_t *lock = NULL;              // Protege stats e latest entre núcleos
+
+static void acq_lock_init(void) {
+    if (!lock)
+        lock = spin_lock_init(spin_lock_claim_unused(true));
+}
+
+// ================================================================================
+// PRODUTOR - INSERÇÃO NO BUFFER CIRCULAR
+// ================================================================================
+
+/**
+ * Registra o intervalo desde o último instante de amostragem
+ * Deve ser chamada com o spin lock adquirido
+ */
+static void acq_record_interval(uint64_t now) {
+    // Estatísticas de jitter: compara o intervalo real com o nominal
+    if (last_sample_us) {
+        uint32_t dt = (uint32_t)(now - last_sample_us);
+        uint32_t dev = dt > stats.period_us ? dt - stats.period_us : stats.period_us - dt;
+        if (dt < stats.dt_min_us) stats.dt_min_us = dt;
+        if (dt > stats.dt_max_us) stats.dt_max_us = dt;
+        if (dev > stats.jitter_max_us) stats.jitter_max_us = dev;
+        stats.jitter_sum_us += dev;
+        stats.intervals++;
+    }
+    last_sample_us = now;
+}
+
+/**
+ * Numera a amostra e a insere no buffer circular
+ * Executada em contexto de interrupção (timer ou software)
+ */
+static void acq_push(mpu_sample_t *s) {
+    uint32_t irq = spin_lock_blocking(lock);
+    s->seq = seq++;
+    stats.samples++;
+    latest = *s;
+
+    uint32_t h = head;
+    uint32_t fill = h - tail;
+    if (fill >= ACQ_RING_SIZE) {
+        stats.overruns++;                     // Buffer cheio: descarta a amostra
+        spin_unlock(lock, irq);
+        return;
+    }
+    if (fill + 1 > stats.max_fill) stats.max_fill = fill + 1;
+    spin_unlock(lock, irq);
+
+    ring[h & (ACQ_RING_SIZE - 1)] = *s;
+    __dmb();                                  // Dados visíveis antes do índice
+    head = h + 1;
+    __sev();                                  // Acorda o consumidor em __wfe
+    if (ready_cb && fill + 1 == ready_batch)
+        ready_cb();
+}
+
+/**
+ * Registra uma função chamada (em interrupção) quando o buffer atinge batch
+ * amostras pendentes; o aviso se repete após o consumidor esvaziá-lo
+ * @param cb    Função de aviso (NULL desativa)
+ * @param batch Amostras pendentes que disparam o aviso (mínimo 1)
+ */
+void acq_set_ready_callback(acq_ready_cb_t cb, uint32_t batch) {
+    ready_batch = batch ? batch : 1;
+    ready_cb = cb;
+}
+
+// ================================================================================
+// MODO TIMER - CALLBACK PERIÓDICO
+// ================================================================================
+
+/**
+ * Lê uma amostra do MPU6050 e a insere no buffer circular
+ * Executado em contexto de interrupção a cada período de amostragem
+ */
+static bool acq_timer_callback(repeating_timer_t *rt) {
+    uint64_t now = time_us_64();
+    PROF_START(t_leitura);
+
+    mpu_sample_t s;
+    bool ok = true;
+#if ACQ_USE_DMA && ACQ_SECOND_MPU
+    if (sensor2) {
+        // Meio do período: conclui a rajada do primeiro sensor e dispara a do segundo
+        if (second_half) {
+            second_half = false;
+            pair_ok = mpu6050_read_raw_dma_finish(pair.accel, pair.gyro, &pair.temp);
+            pair.t_us = (uint32_t)dma_start_us;
+            mpu6050_read_raw_dma_start(sensor2);
+            PROF_STOP(PROF_MPU_READ, t_leitura);
+            return running;
+        }
+        // Início do período: a amostra fica completa com a leitura do segundo
+        second_half = true;
+        s = pair;
+        ok = mpu6050_read_raw_dma_finish(s.accel2, s.gyro2, &s.temp2) && pair_ok;
+        dma_start_us = now;
+        mpu6050_read_raw_dma_start(sensor);
+    } else
+#endif
+    {
+#if ACQ_SECOND_MPU
+        memset(s.accel2, 0, sizeof s.accel2);
+        memset(s.gyro2, 0, sizeof s.gyro2);
+        s.temp2 = 0;
+#endif
+#if ACQ_USE_DMA
+        // Conclui a rajada do período anterior e já dispara a próxima
+        ok = mpu6050_read_raw_dma_finish(s.accel, s.gyro, &s.temp);
+        s.t_us = (uint32_t)dma_start_us;
+        dma_start_us = now;
+        mpu6050_read_raw_dma_start(sensor);
+#else
+        s.t_us = (uint32_t)now;
+        mpu6050_read_raw(sensor, s.accel, s.gyro, &s.temp);
+#if ACQ_SECOND_MPU
+        if (sensor2)
+            mpu6050_read_raw(sensor2, s.accel2, s.gyro2, &s.temp2);
+#endif
+#endif
+    }
+    PROF_STOP(PROF_MPU_READ, t_leitura);
+
+    uint32_t irq = spin_lock_blocking(lock);
+    acq_record_interval(now);
+    spin_unlock(lock, irq);
+
+    if (ok)                                   // Só há amostra se a leitura foi concluída
+        acq_push(&s);
+    return running;
+}
+
+// ================================================================================
+// MODO FIFO - INTERRUPÇÃO DE DADO PRONTO
+// ================================================================================
+
+/**
+ * Esvazia a FIFO do sensor em rajadas e insere os registros no buffer
+ * O instante de cada registro é reconstruído a partir do último pulso de
+ * dado pronto, recuando um período por registro ainda mais novo
+ */
+static void acq_fifo_drain(void) {
+    if (!running || mode != ACQ_MODE_FIFO) return;
+
+    // O pulso de dado pronto pode chegar durante a leitura da contagem:
+    // repete até que o instante de referência corresponda a ela
+    uint8_t status;
+    uint16_t count;
+    uint64_t ref_us, check_us;
+    do {
+        uint32_t irq = spin_lock_blocking(lock);
+        ref_us = last_sample_us;
+        spin_unlock(lock, irq);
+        status = mpu6050_int_status(sensor);
+        count = mpu6050_fifo_count(sensor);
+        irq = spin_lock_blocking(lock);
+        check_us = last_sample_us;
+        spin_unlock(lock, irq);
+    } while (ref_us != check_us);
+
+    // Transbordo: registros foram perdidos e o alinhamento não é garantido
+    if ((status & MPU6050_INT_FIFO_OFLOW) ||
+        count > MPU6050_FIFO_SIZE - MPU6050_FIFO_SAMPLE_SIZE) {
+        uint32_t irq = spin_lock_blocking(lock);
+        stats.fifo_overflows++;
+        spin_unlock(lock, irq);
+        mpu6050_fifo_reset(sensor);
+        return;
+    }
+
+    uint32_t pending = count / MPU6050_FIFO_SAMPLE_SIZE;
+    while (pending) {
+        uint8_t buffer[ACQ_FIFO_BURST * MPU6050_FIFO_SAMPLE_SIZE];
+        int n = mpu6050_fifo_read(sensor, buffer, ACQ_FIFO_BURST);
+        if (n <= 0) break;
+        if ((uint32_t)n > pending) n = (int)pending;
+
+        for (int k = 0; k < n; k++) {
+            mpu_sample_t s = {0};
+            mpu6050_fifo_decode(&buffer[k * MPU6050_FIFO_SAMPLE_SIZE], s.accel, s.gyro, &s.temp);
+            pending--;
+            s.t_us = (uint32_t)(ref_us - (uint64_t)pending * stats.period_us);
+            acq_push(&s);
+        }
+    }
+}
+
+/**
+ * Deve ser chamada pelo handler de GPIO na borda de subida do pino INT
+ * O pulso só marca o instante da amostra; a cada ACQ_FIFO_BURST períodos
+ * pede o esvaziamento da FIFO à interrupção de software
+ */
+void acq_data_ready_irq(void) {
+    if (!running || mode != ACQ_MODE_FIFO) return;
+
+    uint64_t now = time_us_64();
+    uint32_t irq = spin_lock_blocking(lock);
+    acq_record_interval(now);
+    spin_unlock(lock, irq);
+
+    if (now - last_drain_us < drain_interval_us) return;
+    last_drain_us = now;
+    irq_set_pending(drain_irq);
+}
+
+// ================================================================================
+// CONTROLE DO MOTOR
+// ================================================================================
+
+/**
+ * Define os sensores lidos pela aquisição (antes de acq_start)
+ * @param primary   Sensor principal
+ * @param secondary Segundo sensor no barramento, ou NULL. Ignorado sem
+ *                  ACQ_SECOND_MPU
+ */
+void acq_set_sensors(const mpu6050_t *primary, const mpu6050_t *secondary) {
+    if (running) return;
+    sensor = primary;
+#if ACQ_SECOND_MPU
+    sensor2 = secondary;
+#else
+    (void)secondary;
+#endif
+}
+
+/**
+ * Prepara o estado comum aos dois modos de aquisição
+ */
+static void acq_prepare(uint32_t rate_hz) {
+    acq_lock_init();
+    acq_flush();
+    acq_reset_stats();
+    stats.period_us = 1000000u / rate_hz;
+    seq = 0;
+    last_sample_us = 0;
+}
+
+/**
+ * Inicia a amostragem periódica do MPU6050
+ * @param rate_hz Taxa de amostragem desejada (1 a ACQ_MAX_RATE_HZ)
+ * @return true se o timer foi configurado com sucesso
+ */
+bool acq_start(uint32_t rate_hz) {
+    if (running) return true;
+    if (!sensor) {
+        printf("[ERRO] Nenhum sensor definido para a aquisição.\n");
+        return false;
+    }
+    if (rate_hz == 0 || rate_hz > ACQ_MAX_RATE_HZ) {
+        printf("[ERRO] Taxa de amostragem inválida: %lu Hz\n", (unsigned long)rate_hz);
+        return false;
+    }
+
+#if ACQ_USE_DMA
+    mpu6050_dma_init();
+#endif
+    acq_prepare(rate_hz);
+    mode = ACQ_MODE_TIMER;
+    running = true;
+
+    int64_t tick_us = stats.period_us;
+#if ACQ_USE_DMA && ACQ_SECOND_MPU
+    // Uma rajada a cada meio período, alternando os sensores
+    pair_ok = false;
+    second_half = false;
+    if (sensor2)
+        tick_us = stats.period_us / 2;
+#endif
+
+    // Atraso negativo: o período é contado entre inícios de callback,
+    // não a partir do fim do callback anterior
+    if (!add_repeating_timer_us(-tick_us, acq_timer_callback, NULL, &timer)) {
+        printf("[ERRO] Sem alarmes disponíveis para a aquisição.\n");
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Inicia a aquisição pela FIFO interna do MPU6050
+ * O sensor define o instante de amostragem (divisor de taxa); o pino INT
+ * deve estar ligado a uma GPIO cuja interrupção chame acq_data_ready_irq()
+ * @param rate_hz Taxa de amostragem desejada (1 a ACQ_MAX_RATE_HZ)
+ * @return true se o sensor foi configurado
+ */
+bool acq_start_fifo(uint32_t rate_hz) {
+    if (running) return true;
+    if (!sensor) {
+        printf("[ERRO] Nenhum sensor definido para a aquisição.\n");
+        return false;
+    }
+#if ACQ_SECOND_MPU
+    if (sensor2) {
+        printf("[ERRO] O modo FIFO não suporta o segundo sensor.\n");
+        return false;
+    }
+#endif
+    if (rate_hz == 0 || rate_hz > ACQ_MAX_RATE_HZ) {
+        printf("[ERRO] Taxa de amostragem inválida: %lu Hz\n", (unsigned long)rate_hz);
+        return false;
+    }
+
+    // Atendida no núcleo que liga a aquisição, o mesmo da interrupção da GPIO
+    if (drain_irq < 0) {
+        drain_irq = user_irq_claim_unused(true);
+        irq_set_exclusive_handler(drain_irq, acq_fifo_drain);
+        irq_set_priority(drain_irq, PICO_LOWEST_IRQ_PRIORITY);
+        irq_set_enabled(drain_irq, true);
+    }
+
+    uint32_t actual_hz = mpu6050_set_sample_rate(sensor, rate_hz);
+    acq_prepare(actual_hz);
+    drain_interval_us = stats.period_us * ACQ_FIFO_BURST;
+    last_drain_us = time_us_64();
+    mode = ACQ_MODE_FIFO;
+    mpu6050_fifo_enable(sensor, true);
+    running = true;
+
+    if (actual_hz != rate_hz)
+        printf("[AVISO] Taxa ajustada ao divisor do sensor: %lu Hz\n", (unsigned long)actual_hz);
+    return true;
+}
+
+/**
+ * Para a amostragem periódica
+ */
+void acq_stop(void) {
+    if (!running) return;
+    running = false;
+    if (mode == ACQ_MODE_FIFO) {
+        mpu6050_fifo_enable(sensor, false);
+        return;
+    }
+    cancel_repeating_timer(&timer);
+#if ACQ_USE_DMA
+    // Descarta a rajada que ficou pendente
+    mpu_sample_t s;
+    mpu6050_read_raw_dma_finish(s.accel, s.gyro, &s.temp);
+#endif
+}
+
+bool acq_is_running(void) {
+    return running;
+}
+
+// ================================================================================
+// CONSUMO DO BUFFER - CONSUMIDOR
+// ================================================================================
+
+/**
+ * Retira a amostra mais antiga do buffer circular
+ * @param sample Destino da amostra
+ * @return true se havia amostra, false se o buffer estava vazio
+ */
+bool acq_pop(mpu_sample_t *sample) {
+    uint32_t t = tail;
+    if (t == head) return false;
+    __dmb();                                  // Índice lido antes dos dados
+    *sample = ring[t & (ACQ_RING_SIZE - 1)];
+    __dmb();                                  // Dados copiados antes de liberar a posição
+    tail = t + 1;
+    return true;
+}
+
+/**
+ * Número de amostras aguardando consumo
+ */
+uint32_t acq_available(void) {
+    return head - tail;
+}
+
+/**
+ * Descarta todas as amostras pendentes
+ */
+void acq_flush(void) {
+    tail = head;
+}
+
+/**
+ * Posições absolutas no buffer: amostras produzidas (head) e consumidas (tail)
+ * desde acq_ring_reset
+ */
+uint32_t acq_head(void) {
+    return head;
+}
+
+uint32_t acq_tail(void) {
+    return tail;
+}
+
+/**
+ * Amostra na posição absoluta informada; válida enquanto o produtor não
+ * tiver dado a volta no buffer (acq_head() - pos <= ACQ_RING_SIZE)
+ */
+const mpu_sample_t *acq_ring_at(uint32_t pos) {
+    return &ring[pos & (ACQ_RING_SIZE - 1)];
+}
+
+/**
+ * Esvazia o buffer desde a posição 0; chamada no boot, antes de acq_start,
+ * pois com ACQ_RETAIN_RING os índices não são zerados na inicialização
+ */
+void acq_ring_reset(void) {
+    head = 0;
+    tail = 0;
+}
+
+/**
+ * Copia a amostra mais recente (para display e cálculo de ângulos)
+ */
+void acq_latest(mpu_sample_t *sample) {
+    uint32_t irq = spin_lock_blocking(lock);
+    *sample = latest;
+    spin_unlock(lock, irq);
+}
+
+// ================================================================================
+// ESTATÍSTICAS
+// ================================================================================
+
+void acq_get_stats(acq_stats_t *out) {
+    uint32_t irq = spin_lock_blocking(lock);
+    *out = stats;
+    spin_unlock(lock, irq);
+}
+
+void acq_reset_stats(void) {
+    acq_lock_init();
+    uint32_t irq = spin_lock_blocking(lock);
+    uint32_t period = stats.period_us;
+    memset((void *)&stats, 0, sizeof stats);
+    stats.period_us = period;
+    stats.dt_min_us = UINT32_MAX;
+    spin_unlock(lock, irq);
+}
+
+/**
+ * Exibe as estatísticas de temporização no terminal
+ */
+void acq_print_stats(void) {
+    acq_stats_t s;
+    acq_get_stats(&s);
+    printf("Aquisição: %lu amostras, %lu descartadas (buffer cheio)\n",
+           (unsigned long)s.samples, (unsigned long)s.overruns);
+    if (s.fifo_overflows)
+        printf("[AVISO] FIFO do sensor transbordou %lu vez(es): captura com lacunas\n",
+               (unsigned long)s.fifo_overflows);
+    printf("Ocupação máxima do buffer: %lu de %u amostras\n",
+           (unsigned long)s.max_fill, ACQ_RING_SIZE);
+    if (s.intervals) {
+        printf("Período nominal: %lu us | intervalo min/max: %lu/%lu us\n",
+               (unsigned long)s.period_us, (unsigned long)s.dt_min_us,
+               (unsigned long)s.dt_max_us);
+        printf("Jitter médio: %lu us | jitter máximo: %lu us\n",
+               (unsigned long)(s.jitter_sum_us / s.intervals),
+               (unsigned long)s.jitter_max_us);
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * ================================================================================
+ * MOTOR DE AQUISIÇÃO DO MPU6050
+ * ================================================================================
+ *
+ * Descrição: Amostragem do MPU6050 dirigida por timer de hardware, em taxa fixa
+ *            e configurável, com armazenamento em buffer circular lock-free
+ *            (um produtor, um consumidor) e estatísticas de jitter.
+ *            Alternativamente, usa a FIFO interna do sensor com a
+ *            interrupção de dado pronto. Um segundo MPU6050 no mesmo
+ *            barramento (ACQ_SECOND_MPU) é lido em rajadas intercaladas com
+ *            as do primeiro.
+ * ================================================================================
+ */
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "MPU6050.h"
+
+// Capacidade do buffer circular (potência de 2). Com 2048 amostras o buffer
+// absorve ~2 s a 1 kHz enquanto o laço principal está ocupado.
+#ifndef ACQ_RING_SIZE
+#define ACQ_RING_SIZE 2048
+#endif
+
+// Registros lidos da FIFO do sensor por transação I2C no modo FIFO
+// (8 x 14 bytes levam ~3 ms a 400 kHz)
+#ifndef ACQ_FIFO_BURST
+#define ACQ_FIFO_BURST 8
+#endif
+
+// Buffer circular e índices em RAM não inicializada: depois de um reset do
+// watchdog ou de uma falha as amostras ainda não gravadas continuam lá para
+// o boot completar o arquivo interrompido (crash.h)
+#ifndef ACQ_RETAIN_RING
+#define ACQ_RETAIN_RING 1
+#endif
+
+// Taxa máxima de saída de dados do MPU6050 com acelerômetro habilitado
+#define ACQ_MAX_RATE_HZ 1000
+
+// Segundo sensor (endereço alternativo, AD0 em nível alto) amostrado junto
+// com o primeiro; cada amostra passa a levar as duas leituras. Somente no
+// modo timer: com DMA as rajadas se alternam a cada meio período, e a do
+// segundo sensor ocorre t_us + period_us / 2
+#ifndef ACQ_SECOND_MPU
+#define ACQ_SECOND_MPU 0
+#endif
+
+/**
+ * Uma amostra completa do MPU6050 com número sequencial e instante de captura
+ */
+typedef struct {
+    uint32_t seq;          // Número sequencial da amostra
+    uint32_t t_us;         // Instante da leitura (time_us_32)
+    int16_t accel[3];      // Aceleração bruta [x, y, z]
+    int16_t gyro[3];       // Velocidade angular bruta [x, y, z]
+    int16_t temp;          // Temperatura bruta
+#if ACQ_SECOND_MPU
+    int16_t accel2[3];     // Leituras do segundo sensor
+    int16_t gyro2[3];
+    int16_t temp2;
+#endif
+} mpu_sample_t;
+
+/**
+ * Estatísticas de temporização da aquisição
+ */
+typedef struct {
+    uint32_t period_us;    // Período nominal configurado
+    uint32_t samples;      // Amostras adquiridas desde o início
+    uint32_t overruns;     // Amostras descartadas por buffer cheio
+    uint32_t dt_min_us;    // Menor intervalo observado entre amostras
+    uint32_t dt_max_us;    // Maior intervalo observado entre amostras
+    uint32_t jitter_max_us;// Maior desvio absoluto em relação ao período
+    uint64_t jitter_sum_us;// Soma dos desvios absolutos (para a média)
+    uint32_t intervals;    // Número de intervalos medidos
+    uint32_t max_fill;     // Maior ocupação do buffer (amostras pendentes)
+    uint32_t fifo_overflows;// Transbordos da FIFO do sensor (modo FIFO)
+} acq_stats_t;
+
+/**
+ * Origem do instante de amostragem
+ */
+typedef enum {
+    ACQ_MODE_TIMER,        // Timer do Pico lê o sensor a cada período
+    ACQ_MODE_FIFO          // Sensor amostra sozinho; FIFO lida em rajadas
+} acq_mode_t;
+
+// Aviso de amostras disponíveis, chamado no contexto da interrupção
+typedef void (*acq_ready_cb_t)(void);
+
+void acq_set_sensors(const mpu6050_t *primary, const mpu6050_t *secondary);
+bool acq_start(uint32_t rate_hz);
+bool acq_start_fifo(uint32_t rate_hz);
+void acq_data_ready_irq(void);
+void acq_stop(void);
+bool acq_is_running(void);
+
+bool acq_pop(mpu_sample_t *sample);
+uint32_t acq_available(void);
+void acq_flush(void);
+void acq_latest(mpu_sample_t *sample);
+uint32_t acq_head(void);
+uint32_t acq_tail(void);
+const mpu_sample_t *acq_ring_at(uint32_t pos);
+void acq_ring_reset(void);
+void acq_set_ready_callback(acq_ready_cb_t cb, uint32_t batch);
+
+void acq_get_stats(acq_stats_t *stats);
+void acq_reset_stats(void);
+void acq_print_stats(void);
+
+#endif // ACQUISITION_H
@@ -0,0 +1,97 @@
+/*
+ * ================================================================================
+ * ESTIMATIVA DE ATITUDE (ROLL/PITCH) DO MPU6050
+ * ================================================================================
+ *
+ * angulo = a * (angulo + giro * dt) + (1 - a) * angulo_acel, a = tau / (tau + dt)
+ *
+ * Tudo em float para usar as rotinas otimizadas de ponto flutuante simples
+ * da ROM do RP2040; nenhuma operação é promovida a double.
+ * ================================================================================
+ */
+
+#include "attitude.h"
+
+#include <math.h>
+
+#include "mpu_log.h"
+
+#define ATT_RAD_TO_DEG  57.2957795f
+#define ATT_PI          3.14159265f
+#define ATT_PI_2        1.57079633f
+
+/**
+ * Reinicia o filtro; a próxima amostra define os ângulos pelo acelerômetro
+ * @param tau_s Constante de tempo em segundos
+ * @param gyro_lsb_per_dps Escala do giroscópio (mpu6050_t.gyro_lsb_per_dps)
+ */
+void att_init(attitude_t *att, float tau_s, float gyro_lsb_per_dps) {
+    att->roll = 0.0f;
+    att->pitch = 0.0f;
+    att->tau_s = tau_s;
+    att->gyro_lsb_per_dps = gyro_lsb_per_dps;
+    att->last_us = 0;
+    att->valid = false;
+}
+
+/**
+ * atan2 aproximado por polinômio no octante [0, 1] (erro < 0,02°)
+ */
+float att_atan2f(float y, float x) {
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+    if (mx == 0.0f)
+        return 0.0f;
+
+    float a = mn / mx;
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    if (ay > ax) r = ATT_PI_2 - r;
+    if (x < 0.0f) r = ATT_PI - r;
+    if (y < 0.0f) r = -r;
+    return r;
+}
+
+/**
+ * Ângulos (em graus) apenas pelo acelerômetro
+ * @param accel Aceleração bruta [x, y, z]
+ */
+void att_accel_angles(const int16_t accel[3], float *roll, float *pitch) {
+    // A escala é comum aos três eixos e não altera os ângulos
+    float ax = accel[0], ay = accel[1], az = accel[2];
+    *roll  = att_atan2f(ay, az) * ATT_RAD_TO_DEG;
+    *pitch = att_atan2f(-ax, sqrtf(ay * ay + az * az)) * ATT_RAD_TO_DEG;
+}
+
+/**
+ * Incorpora uma amostra ao filtro
+ */
+void att_update(attitude_t *att, const mpu_sample_t *s) {
+    float roll_acc, pitch_acc;
+    att_accel_angles(s->accel, &roll_acc, &pitch_acc);
+
+    float dt = (int32_t)(s->t_us - att->last_us) * 1e-6f;
+    att->last_us = s->t_us;
+    if (!att->valid || dt <= 0.0f || dt > ATT_MAX_GAP_S) {
+        att->roll = roll_acc;
+        att->pitch = pitch_acc;
+        att->valid = true;
+        return;
+    }
+
+    float a = att->tau_s / (att->tau_s + dt);
+    float roll = att->roll + s->gyro[0] * (dt / att->gyro_lsb_per_dps);
+    float pitch = att->pitch + s->gyro[1] * (dt / att->gyro_lsb_per_dps);
+
+    // Roll cobre ±180°: a correção segue o caminho mais curto na virada
+    float e = roll_acc - roll;
+    if (e > 180.0f) e -= 360.0f;
+    else if (e < -180.0f) e += 360.0f;
+    roll += (1.0f - a) * e;
+    if (roll > 180.0f) roll -= 360.0f;
+    else if (roll < -180.0f) roll += 360.0f;
+
+    att->roll = roll;
+    att->pitch = pitch + (1.0f - a) * (pitch_acc - pitch);
+}
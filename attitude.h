@@ -0,0 +1,48 @@
+/*
+ * ================================================================================
+ * ESTIMATIVA DE ATITUDE (ROLL/PITCH) DO MPU6050
+ * ================================================================================
+ *
+ * Descrição: Filtro complementar em precisão simples, executado a cada amostra
+ *            da aquisição: integra o giroscópio e corrige a deriva com os
+ *            ângulos do acelerômetro, usando uma aproximação rápida de atan2.
+ * ================================================================================
+ */
+
+#ifndef ATTITUDE_H
+#define ATTITUDE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acquisition.h"
+
+// Constante de tempo do filtro: abaixo dela prevalece o acelerômetro, acima
+// o giroscópio integrado
+#ifndef ATT_TAU_S
+#define ATT_TAU_S 0.5f
+#endif
+
+// Intervalo entre amostras acima do qual o filtro reinicia pelo acelerômetro
+#ifndef ATT_MAX_GAP_S
+#define ATT_MAX_GAP_S 0.5f
+#endif
+
+/**
+ * Estado do filtro; roll e pitch em graus
+ */
+typedef struct {
+    volatile float roll;
+    volatile float pitch;
+    float tau_s;           // Constante de tempo do filtro
+    float gyro_lsb_per_dps; // Escala do giroscópio na faixa em uso
+    uint32_t last_us;      // Instante da amostra anterior
+    bool valid;            // false até a primeira amostra
+} attitude_t;
+
+void att_init(attitude_t *att, float tau_s, float gyro_lsb_per_dps);
+void att_update(attitude_t *att, const mpu_sample_t *s);
+void att_accel_angles(const int16_t accel[3], float *roll, float *pitch);
+float att_atan2f(float y, float x);
+
+#endif // ATTITUDE_H
@@ -0,0 +1,257 @@
+/*
+ * ================================================================================
+ * BANCADA DE DESEMPENHO DO CARTÃO SD
+ * ================================================================================
+ *
+ * O arquivo de teste é pré-alocado contíguo (f_expand), como o da captura:
+ * os testes pelo FatFs não alocam clusters durante a medida, e os testes em
+ * setores brutos gravam apenas dentro da extensão do arquivo, sem risco para
+ * o restante do cartão. A latência de cada operação inclui o f_lseek nos
+ * testes aleatórios; a vazão inclui o f_sync final nas gravações.
+ * ================================================================================
+ */
+
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "f_util.h"
+#include "sd_spi.h"
+
+#define BENCH_MAX_RESULTS 64
+
+/**
+ * Resultado de um teste (uma linha do CSV)
+ */
+typedef struct {
+    char test[16];
+    uint32_t clock_khz;     // Clock do SPI durante o teste
+    uint32_t chunk;         // Bytes por operação
+    uint32_t ops;
+    uint32_t kib_s;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} bench_result_t;
+
+static uint8_t bench_buf[BENCH_MAX_CHUNK] __attribute__((aligned(4)));
+static uint32_t lat[BENCH_MAX_OPS];
+static bench_result_t results[BENCH_MAX_RESULTS];
+static uint32_t n_results;
+static FIL fil;
+static uint32_t rng;
+
+static const uint32_t fatfs_chunks[] = {64, 256, 1024, 4096, 16384, 32768};
+static const uint32_t random_chunks[] = {512, 4096};
+static const uint32_t raw_blocks[] = {1, 8, 64};           // Setores por comando
+static const uint32_t clocks_hz[] = {6250000, 12500000, 25000000};
+
+_Static_assert(BENCH_MAX_CHUNK >= 64 * FF_MIN_SS, "buffer menor que o maior teste");
+
+// xorshift32: posições aleatórias reprodutíveis entre execuções
+static uint32_t bench_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Ordena as latências do teste, calcula os percentis e exibe a linha
+ * @param elapsed_us Duração total, para a vazão
+ */
+static void bench_report(const char *test, uint32_t clock_khz, uint32_t chunk,
+                         uint32_t ops, uint32_t elapsed_us) {
+    bench_result_t r;
+    qsort(lat, ops, sizeof lat[0], cmp_u32);
+    snprintf(r.test, sizeof r.test, "%s", test);
+    r.clock_khz = clock_khz;
+    r.chunk = chunk;
+    r.ops = ops;
+    r.kib_s = elapsed_us ? (uint32_t)((uint64_t)chunk * ops * 1000000u / 1024u / elapsed_us) : 0;
+    r.p50_us = lat[(ops - 1) * 50 / 100];
+    r.p90_us = lat[(ops - 1) * 90 / 100];
+    r.p99_us = lat[(ops - 1) * 99 / 100];
+    r.max_us = lat[ops - 1];
+    if (n_results < BENCH_MAX_RESULTS)
+        results[n_results++] = r;
+
+    printf("%-12s %6lu %6lu %5lu %8lu %7lu %7lu %7lu %7lu\n", r.test,
+           (unsigned long)r.clock_khz, (unsigned long)r.chunk, (unsigned long)r.ops,
+           (unsigned long)r.kib_s, (unsigned long)r.p50_us, (unsigned long)r.p90_us,
+           (unsigned long)r.p99_us, (unsigned long)r.max_us);
+}
+
+/**
+ * Leitura ou gravação pelo FatFs em blocos de `chunk` bytes, em sequência a
+ * partir do início do arquivo ou em posições aleatórias alinhadas ao bloco
+ */
+static FRESULT bench_fatfs(const char *test, bool write, bool random, uint32_t chunk,
+                           uint32_t file_bytes, uint32_t clock_khz) {
+    uint32_t slots = file_bytes / chunk;
+    uint32_t ops = slots < BENCH_MAX_OPS ? slots : BENCH_MAX_OPS;
+    FRESULT fr = f_lseek(&fil, 0);
+
+    uint32_t t0 = time_us_32();
+    for (uint32_t i = 0; fr == FR_OK && i < ops; i++) {
+        uint32_t t = time_us_32();
+        if (random)
+            fr = f_lseek(&fil, (FSIZE_t)(bench_rand() % slots) * chunk);
+        UINT n = 0;
+        if (fr == FR_OK)
+            fr = write ? f_write(&fil, bench_buf, chunk, &n) : f_read(&fil, bench_buf, chunk, &n);
+        if (fr == FR_OK && n != chunk)
+            fr = FR_INT_ERR;
+        lat[i] = time_us_32() - t;
+    }
+    if (fr == FR_OK && write)
+        fr = f_sync(&fil);
+    uint32_t elapsed = time_us_32() - t0;
+
+    if (fr == FR_OK)
+        bench_report(test, clock_khz, chunk, ops, elapsed);
+    return fr;
+}
+
+/**
+ * sd_write_blocks / sd_read_blocks com `blocks` setores por comando,
+ * restritos à extensão [lba, lba + sectors)
+ */
+static FRESULT bench_raw(const char *test, sd_card_t *sd, bool write, bool random,
+                         uint32_t blocks, LBA_t lba, uint32_t sectors, uint32_t clock_khz) {
+    uint32_t slots = sectors / blocks;
+    uint32_t ops = slots < BENCH_MAX_OPS ? slots : BENCH_MAX_OPS;
+
+    uint32_t t0 = time_us_32();
+    for (uint32_t i = 0; i < ops; i++) {
+        uint64_t at = lba + (uint64_t)(random ? bench_rand() % slots : i) * blocks;
+        uint32_t t = time_us_32();
+        int rc = write ? sd_write_blocks(sd, bench_buf, at, blocks)
+                       : sd_read_blocks(sd, bench_buf, at, blocks);
+        lat[i] = time_us_32() - t;
+        if (rc != SD_BLOCK_DEVICE_ERROR_NONE) {
+            printf("[ERRO] %s: falha no setor %llu (%d)\n", test, (unsigned long long)at, rc);
+            return FR_DISK_ERR;
+        }
+    }
+    bench_report(test, clock_khz, blocks * FF_MIN_SS, ops, time_us_32() - t0);
+    return FR_OK;
+}
+
+/**
+ * Grava os resultados em BENCH_CSV, na raiz do cartão testado
+ */
+static FRESULT bench_save_csv(sd_card_t *sd) {
+    char path[24];
+    snprintf(path, sizeof path, "%s%s", sd->pcName, BENCH_CSV);
+    FRESULT fr = f_open(&fil, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+        return fr;
+    f_printf(&fil, "test,clock_khz,chunk_bytes,ops,kib_s,p50_us,p90_us,p99_us,max_us\n");
+    for (uint32_t i = 0; i < n_results; i++) {
+        const bench_result_t *r = &results[i];
+        f_printf(&fil, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", r->test,
+                 (unsigned long)r->clock_khz, (unsigned long)r->chunk, (unsigned long)r->ops,
+                 (unsigned long)r->kib_s, (unsigned long)r->p50_us, (unsigned long)r->p90_us,
+                 (unsigned long)r->p99_us, (unsigned long)r->max_us);
+    }
+    FRESULT rc = f_close(&fil);
+    if (rc == FR_OK)
+        printf("Resultados salvos em %s\n", path);
+    return rc;
+}
+
+/**
+ * Executa a matriz de testes no cartão montado
+ * FatFs no clock negociado; setores brutos em cada clock da tabela que não
+ * passe do negociado (o mais rápido aprovado no teste de CRC do sd_init)
+ * @param file_kb Tamanho do arquivo de teste
+ */
+FRESULT bench_run(sd_card_t *sd, uint32_t file_kb) {
+    char path[24];
+    snprintf(path, sizeof path, "%s%s", sd->pcName, BENCH_FILE);
+    uint32_t file_bytes = file_kb * 1024u / BENCH_MAX_CHUNK * BENCH_MAX_CHUNK;
+    if (file_bytes < BENCH_MAX_CHUNK)
+        file_bytes = BENCH_MAX_CHUNK;
+
+    FRESULT fr = f_open(&fil, path, FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK) {
+        fr = f_expand(&fil, file_bytes, 1);
+        if (fr != FR_OK) {
+            printf("[ERRO] Sem %lu KiB contíguos para o arquivo de teste\n", (unsigned long)(file_bytes / 1024));
+            f_close(&fil);
+            f_unlink(path);
+            return fr;
+        }
+    }
+    if (fr != FR_OK)
+        return fr;
+
+    for (uint32_t i = 0; i < sizeof bench_buf; i++)
+        bench_buf[i] = (uint8_t)(i * 7 + 3);
+    n_results = 0;
+    rng = 0x2545F491u;
+
+    printf("Arquivo de teste: %s, %lu KiB contíguos\n", path, (unsigned long)(file_bytes / 1024));
+    printf("%-12s %6s %6s %5s %8s %7s %7s %7s %7s\n", "teste", "kHz", "bytes", "ops",
+           "KiB/s", "p50 us", "p90 us", "p99 us", "máx us");
+
+    // FatFs: sequencial em cada tamanho de bloco, depois aleatório
+    uint32_t negotiated = sd_get_baud_rate(sd);
+    for (size_t i = 0; fr == FR_OK && i < count_of(fatfs_chunks); i++) {
+        fr = bench_fatfs("fatfs_seq_wr", true, false, fatfs_chunks[i], file_bytes, negotiated / 1000);
+        if (fr == FR_OK)
+            fr = bench_fatfs("fatfs_seq_rd", false, false, fatfs_chunks[i], file_bytes, negotiated / 1000);
+    }
+    for (size_t i = 0; fr == FR_OK && i < count_of(random_chunks); i++) {
+        fr = bench_fatfs("fatfs_rnd_wr", true, true, random_chunks[i], file_bytes, negotiated / 1000);
+        if (fr == FR_OK)
+            fr = bench_fatfs("fatfs_rnd_rd", false, true, random_chunks[i], file_bytes, negotiated / 1000);
+    }
+
+    // Extensão do arquivo, resolvida antes de fechá-lo: o FatFs não guarda
+    // em cache setores de dados de arquivos fechados
+    FATFS *fs = fil.obj.fs;
+    LBA_t lba = fs->database + (LBA_t)fs->csize * (fil.obj.sclust - 2);
+    uint32_t sectors = file_bytes / FF_MIN_SS;
+    FRESULT rc = f_close(&fil);
+    if (fr == FR_OK)
+        fr = rc;
+
+    // Setores brutos: um ou vários setores por comando, em cada clock
+    uint last_hz = 0;
+    for (size_t c = 0; fr == FR_OK && c < count_of(clocks_hz); c++) {
+        uint hz = sd_spi_set_frequency(sd, clocks_hz[c]);
+        if (hz > negotiated || hz == last_hz)
+            continue;
+        last_hz = hz;
+        sd->spi->negotiated_baud_rate = hz;
+        for (size_t b = 0; fr == FR_OK && b < count_of(raw_blocks); b++) {
+            fr = bench_raw("raw_seq_wr", sd, true, false, raw_blocks[b], lba, sectors, hz / 1000);
+            if (fr == FR_OK)
+                fr = bench_raw("raw_seq_rd", sd, false, false, raw_blocks[b], lba, sectors, hz / 1000);
+        }
+        if (fr == FR_OK)
+            fr = bench_raw("raw_rnd_wr", sd, true, true, 1, lba, sectors, hz / 1000);
+        if (fr == FR_OK)
+            fr = bench_raw("raw_rnd_rd", sd, false, true, 1, lba, sectors, hz / 1000);
+    }
+    sd->spi->negotiated_baud_rate = sd_spi_set_frequency(sd, negotiated);
+
+    f_unlink(path);
+    if (fr != FR_OK) {
+        printf("[ERRO] Teste interrompido: %s (%d)\n", FRESULT_str(fr), fr);
+        return fr;
+    }
+    return bench_save_csv(sd);
+}
@@ -0,0 +1,44 @@
+/*
+ * ================================================================================
+ * BANCADA DE DESEMPENHO DO CARTÃO SD
+ * ================================================================================
+ *
+ * Descrição: Mede vazão e latência (percentis por operação) de gravação e
+ *            leitura, sequenciais e aleatórias: pelo FatFs com blocos de
+ *            64 B a 32 KiB, e em setores brutos (sd_write_blocks /
+ *            sd_read_blocks, um ou vários setores por comando) em cada clock
+ *            do SPI. Os resultados vão para o terminal e para bench.csv no
+ *            próprio cartão, para qualificar modelos de cartão.
+ * ================================================================================
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#include "ff.h"
+#include "sd_card.h"
+
+// Arquivo de teste (removido ao final) e planilha de resultados
+#define BENCH_FILE "bench.tmp"
+#define BENCH_CSV  "bench.csv"
+
+// Tamanho padrão do arquivo de teste, em KiB
+#ifndef BENCH_FILE_KB
+#define BENCH_FILE_KB 2048
+#endif
+
+// Operações cronometradas por teste (limita o tempo dos blocos pequenos)
+#ifndef BENCH_MAX_OPS
+#define BENCH_MAX_OPS 1024
+#endif
+
+// Maior bloco testado: também o tamanho do buffer estático
+#ifndef BENCH_MAX_CHUNK
+#define BENCH_MAX_CHUNK (32 * 1024)
+#endif
+
+FRESULT bench_run(sd_card_t *sd, uint32_t file_kb);
+
+#endif // BENCH_H
@@ -0,0 +1,177 @@
+/*
+ * ================================================================================
+ * CONFIGURAÇÃO DA CAPTURA NO CARTÃO (config.ini)
+ * ================================================================================
+ *
+ * O arquivo é lido linha a linha com f_gets, sem alocação. Cada chave é
+ * validada isoladamente: um valor inválido não impede as demais linhas, e a
+ * configuração em uso só muda nas chaves aceitas.
+ * ================================================================================
+ */
+
+#include "config.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "acquisition.h"
+
+static const char *const format_names[] = {
+    [CFG_FORMAT_CSV]        = "csv",
+    [CFG_FORMAT_BINARY]     = "binary",
+    [CFG_FORMAT_COMPRESSED] = "compressed",
+};
+
+// Remove espaços do início e do fim (no próprio buffer)
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s))
+        s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    return s;
+}
+
+// Número decimal inteiro, sem sobras
+static bool parse_u32(const char *s, uint32_t *out) {
+    char *end;
+    unsigned long v = strtoul(s, &end, 10);
+    if (end == s || *end || *s == '-')
+        return false;
+    *out = (uint32_t)v;
+    return true;
+}
+
+// Índice de uma faixa do MPU6050: o valor é base << índice (índice 0 a 3)
+static bool parse_range(const char *s, uint32_t base, uint8_t *out) {
+    uint32_t v;
+    if (!parse_u32(s, &v))
+        return false;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (v == base << i) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Aplica uma chave à configuração
+ * @return false se a chave for desconhecida ou o valor inválido
+ */
+bool cfg_set(cfg_t *cfg, const char *key, const char *value) {
+    uint32_t v;
+    if (!strcmp(key, "sample_rate_hz")) {
+        if (!parse_u32(value, &v) || v < 1 || v > ACQ_MAX_RATE_HZ)
+            return false;
+        cfg->sample_rate_hz = v;
+        cfg->rate_div = -1;
+    } else if (!strcmp(key, "rate_div")) {
+        // A base depende do dlpf, que pode vir depois: ver cfg_load
+        if (!parse_u32(value, &v) || v > 255)
+            return false;
+        cfg->rate_div = (int16_t)v;
+    } else if (!strcmp(key, "dlpf")) {
+        if (!parse_u32(value, &v) || v > 6)
+            return false;
+        cfg->dlpf = (uint8_t)v;
+    } else if (!strcmp(key, "accel_range_g")) {
+        return parse_range(value, 2, &cfg->accel_range);
+    } else if (!strcmp(key, "gyro_range_dps")) {
+        return parse_range(value, 250, &cfg->gyro_range);
+    } else if (!strcmp(key, "format")) {
+        for (uint8_t i = 0; i < count_of(format_names); i++) {
+            if (!strcmp(value, format_names[i])) {
+                cfg->format = i;
+                return true;
+            }
+        }
+        return false;
+    } else if (!strcmp(key, "file")) {
+        // Só na raiz do cartão em uso e com espaço para o terminador
+        if (!*value || strchr(value, '/') || strchr(value, ':') || strlen(value) >= sizeof cfg->filename)
+            return false;
+        strcpy(cfg->filename, value);
+    } else if (!strcmp(key, "sync_s")) {
+        return parse_u32(value, &cfg->sync_s);
+    } else if (!strcmp(key, "prealloc_s")) {
+        return parse_u32(value, &cfg->prealloc_s);
+    } else if (!strcmp(key, "segment_s")) {
+        return parse_u32(value, &cfg->segment_s);
+    } else if (!strcmp(key, "segment_mb")) {
+        return parse_u32(value, &cfg->segment_mb);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Lê o arquivo de configuração sobre os valores atuais de cfg
+ * @return FR_NO_FILE se não houver arquivo (cfg inalterada)
+ */
+FRESULT cfg_load(const char *path, cfg_t *cfg) {
+    static FIL fil;
+    FRESULT fr = f_open(&fil, path, FA_READ);
+    if (fr != FR_OK)
+        return fr;
+
+    char line[96];
+    uint32_t n = 0;
+    cfg->rate_div = -1;
+    while (f_gets(line, sizeof line, &fil)) {
+        n++;
+        char *comment = strpbrk(line, "#;");
+        if (comment)
+            *comment = '\0';
+        char *key = trim(line);
+        if (!*key || *key == '[')
+            continue;                           // Linha vazia ou seção
+        char *eq = strchr(key, '=');
+        if (!eq) {
+            printf("[AVISO] %s:%lu: linha sem '=' ignorada\n", path, (unsigned long)n);
+            continue;
+        }
+        *eq = '\0';
+        char *value = trim(eq + 1);
+        key = trim(key);
+        for (char *p = key; *p; p++)
+            *p = (char)tolower((unsigned char)*p);
+        if (!cfg_set(cfg, key, value))
+            printf("[AVISO] %s:%lu: \"%s = %s\" ignorado (chave ou valor inválido)\n",
+                   path, (unsigned long)n, key, value);
+    }
+
+    // O divisor vale sobre a base de 1 kHz do filtro ativo; com dlpf = 0 a
+    // base do MPU6050 seria 8 kHz
+    if (cfg->rate_div >= 0) {
+        if (cfg->dlpf == 0)
+            printf("[AVISO] %s: rate_div exige dlpf de 1 a 6; ignorado\n", path);
+        else
+            cfg->sample_rate_hz = 1000u / (1u + (uint32_t)cfg->rate_div);
+    }
+
+    fr = f_error(&fil) ? FR_DISK_ERR : FR_OK;
+    FRESULT rc = f_close(&fil);
+    return fr != FR_OK ? fr : rc;
+}
+
+/**
+ * Exibe a configuração no formato do arquivo (pode ser copiada para ele)
+ */
+void cfg_print(const cfg_t *cfg) {
+    printf("sample_rate_hz = %lu\n", (unsigned long)cfg->sample_rate_hz);
+    printf("dlpf = %u\n", cfg->dlpf);
+    printf("accel_range_g = %u\n", 2u << cfg->accel_range);
+    printf("gyro_range_dps = %u\n", 250u << cfg->gyro_range);
+    printf("format = %s\n", format_names[cfg->format]);
+    printf("file = %s\n", cfg->filename);
+    printf("sync_s = %lu\n", (unsigned long)cfg->sync_s);
+    printf("prealloc_s = %lu\n", (unsigned long)cfg->prealloc_s);
+    printf("segment_s = %lu\n", (unsigned long)cfg->segment_s);
+    printf("segment_mb = %lu\n", (unsigned long)cfg->segment_mb);
+}
@@ -0,0 +1,54 @@
+/*
+ * ================================================================================
+ * CONFIGURAÇÃO DA CAPTURA NO CARTÃO (config.ini)
+ * ================================================================================
+ *
+ * Descrição: Lê ao montar o cartão um arquivo texto com linhas "chave =
+ *            valor" (comentários com # ou ;, seções [..] ignoradas) e
+ *            ajusta taxa de amostragem, filtro passa-baixa e faixas do
+ *            MPU6050, nome do arquivo, pré-alocação, segmentos e intervalo
+ *            de f_sync sem regravar o firmware. Chaves ausentes mantêm o
+ *            valor atual; chaves desconhecidas ou valores fora da faixa são
+ *            avisados e ignorados.
+ * ================================================================================
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+
+#define CFG_FILE "config.ini"
+
+/**
+ * Formato do arquivo de dados; escolhido na compilação (MPU_LOG_BINARY e
+ * MPU_LOG_COMPRESS), o config.ini apenas confere
+ */
+typedef enum {
+    CFG_FORMAT_CSV,
+    CFG_FORMAT_BINARY,
+    CFG_FORMAT_COMPRESSED
+} cfg_format_t;
+
+typedef struct {
+    uint32_t sample_rate_hz;    // sample_rate_hz ou rate_div (1 kHz / (1 + div))
+    int16_t rate_div;           // rate_div lido, aplicado ao fim da leitura (-1 = ausente)
+    uint8_t dlpf;               // dlpf: DLPF_CFG do MPU6050 (0 = 260 Hz ... 6 = 5 Hz)
+    uint8_t accel_range;        // accel_range_g: 2, 4, 8 ou 16 (MPU6050_ACCEL_*)
+    uint8_t gyro_range;         // gyro_range_dps: 250, 500, 1000 ou 2000 (MPU6050_GYRO_*)
+    uint8_t format;             // format: csv, binary ou compressed (cfg_format_t)
+    char filename[32];          // file: arquivo de dados (sem segmentos)
+    uint32_t sync_s;            // sync_s: intervalo de f_sync em segundos (0 = só no fim)
+    uint32_t prealloc_s;        // prealloc_s: duração pré-alocada (0 = sem pré-alocação)
+    uint32_t segment_s;         // segment_s: duração máxima de um segmento (0 = sem limite)
+    uint32_t segment_mb;        // segment_mb: tamanho máximo de um segmento (0 = sem limite)
+} cfg_t;
+
+FRESULT cfg_load(const char *path, cfg_t *cfg);
+bool cfg_set(cfg_t *cfg, const char *key, const char *value);
+void cfg_print(const cfg_t *cfg);
+
+#endif // CONFIG_H
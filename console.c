@@ -0,0 +1,242 @@
+/*
+ * ================================================================================
+ * TERMINAL USB SEM BLOQUEIO
+ * ================================================================================
+ *
+ * O buffer de transmissão tem vários produtores (printf nos dois núcleos e em
+ * interrupções, quadros do xfer) e um consumidor (laço principal). A reserva
+ * de espaço e a cópia ficam sob um spin lock de hardware, por poucos
+ * microssegundos; o consumidor não usa o lock: lê head, envia e só então
+ * avança tail. O envio usa o próprio stdio_usb.out_chars com no máximo
+ * tud_cdc_write_available() bytes, de modo que ele nunca espera pelo
+ * computador. Sem terminal aberto a saída fica no buffer até ele encher.
+ * ================================================================================
+ */
+
+#include "console.h"
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+
+_Static_assert((CONSOLE_TX_SIZE & (CONSOLE_TX_SIZE - 1)) == 0, "CONSOLE_TX_SIZE deve ser potência de 2");
+_Static_assert((CONSOLE_RX_SIZE & (CONSOLE_RX_SIZE - 1)) == 0, "CONSOLE_RX_SIZE deve ser potência de 2");
+
+// Bytes copiados por vez em console_write, para o lock durar pouco
+#define CONSOLE_WRITE_CHUNK 256
+
+// Espera máxima de um printf durante um comando (como o stdio_usb)
+#define CONSOLE_BLOCK_TIMEOUT_MS 500
+
+static spin_lock_t *lock = NULL;               // Serializa os produtores
+static char tx_buf[CONSOLE_TX_SIZE];
+static volatile uint32_t tx_head = 0;          // Escrito só sob o lock
+static volatile uint32_t tx_tail = 0;          // Escrito só pelo laço principal
+static char rx_buf[CONSOLE_RX_SIZE];
+static volatile uint32_t rx_head = 0, rx_tail = 0;
+
+static volatile uint32_t dropped_msgs = 0;     // Mensagens descartadas (buffer cheio)
+static volatile uint32_t dropped_bytes = 0;
+static uint32_t reported_msgs = 0;             // Já avisadas no terminal
+static uint32_t max_used = 0;                  // Maior ocupação observada
+static volatile bool blocking = false;         // Comando do terminal em execução
+
+static void tx_drain(void);
+
+/**
+ * Copia len bytes para o buffer se couberem inteiros
+ * @param drop Contar como mensagem descartada se não couber
+ * @return false se não houver espaço (nada é copiado)
+ */
+static bool tx_put(const void *data, uint32_t len, bool drop) {
+    const char *src = data;
+    uint32_t irq = spin_lock_blocking(lock);
+    uint32_t h = tx_head;
+    uint32_t used = h - tx_tail;
+    bool ok = len <= CONSOLE_TX_SIZE - used;
+    if (ok) {
+        for (uint32_t i = 0; i < len; i++)
+            tx_buf[(h + i) & (CONSOLE_TX_SIZE - 1)] = src[i];
+        __dmb();
+        tx_head = h + len;
+        if (used + len > max_used)
+            max_used = used + len;
+    } else if (drop) {
+        dropped_msgs++;
+        dropped_bytes += len;
+    }
+    spin_unlock(lock, irq);
+    return ok;
+}
+
+// ================================================================================
+// DRIVER DO STDIO
+// ================================================================================
+
+/**
+ * Saída do printf. Durante um comando do terminal (ls, cat...), no laço
+ * principal, espera por espaço enviando o buffer, por até
+ * CONSOLE_BLOCK_TIMEOUT_MS; em qualquer outro contexto descarta
+ */
+static void console_out_chars(const char *buf, int len) {
+    if (len <= 0)
+        return;
+    bool wait = blocking && get_core_num() == 0 && !__get_current_exception();
+    if (wait && !tx_put(buf, (uint32_t)len, false)) {
+        absolute_time_t limite = make_timeout_time_ms(CONSOLE_BLOCK_TIMEOUT_MS);
+        while (tud_cdc_connected() && !time_reached(limite)) {
+            tx_drain();
+            if (tx_put(buf, (uint32_t)len, false))
+                return;
+        }
+    } else if (wait) {
+        return;
+    }
+    tx_put(buf, (uint32_t)len, true);
+}
+
+// Buffer vazio: lê direto da USB (getchar no laço principal, como no xfer)
+static int console_in_chars(char *buf, int len) {
+    int n = 0;
+    while (n < len && rx_tail != rx_head) {
+        buf[n++] = rx_buf[rx_tail & (CONSOLE_RX_SIZE - 1)];
+        rx_tail++;
+    }
+    if (!n)
+        return stdio_usb.in_chars(buf, len);
+    return n;
+}
+
+// O aviso de caracteres recebidos continua vindo do stdio_usb
+static void console_set_chars_available_callback(void (*fn)(void *), void *param) {
+    if (stdio_usb.set_chars_available_callback)
+        stdio_usb.set_chars_available_callback(fn, param);
+}
+
+static stdio_driver_t console_driver = {
+    .out_chars = console_out_chars,
+    .in_chars = console_in_chars,
+    .set_chars_available_callback = console_set_chars_available_callback,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+/**
+ * Troca o stdio_usb pelo driver com buffer; chamar logo após stdio_init_all
+ */
+void console_init(void) {
+    if (!lock)
+        lock = spin_lock_init(spin_lock_claim_unused(true));
+    stdio_set_driver_enabled(&stdio_usb, false);
+    stdio_set_driver_enabled(&console_driver, true);
+}
+
+// ================================================================================
+// LAÇO PRINCIPAL
+// ================================================================================
+
+/**
+ * Recebe os caracteres da USB e envia o que couber no buffer do CDC
+ */
+void console_service(void) {
+    // Recepção: só o que cabe no buffer; o restante espera no FIFO da USB
+    uint32_t free_rx = CONSOLE_RX_SIZE - (rx_head - rx_tail);
+    while (free_rx) {
+        char c;
+        if (stdio_usb.in_chars(&c, 1) != 1)
+            break;
+        rx_buf[rx_head & (CONSOLE_RX_SIZE - 1)] = c;
+        __dmb();
+        rx_head++;
+        free_rx--;
+    }
+
+    tx_drain();
+
+    // Avisa dos descartes quando o buffer esvaziar
+    uint32_t d = dropped_msgs;
+    if (d != reported_msgs && tx_tail == tx_head) {
+        reported_msgs = d;
+        printf("[AVISO] Terminal: %lu mensagens descartadas (buffer cheio)\n", (unsigned long)d);
+    }
+}
+
+/**
+ * Durante um comando do terminal o printf do laço principal espera por
+ * espaço em vez de descartar (saídas longas como ls e cat)
+ */
+void console_set_blocking(bool on) {
+    blocking = on;
+}
+
+// Envia o que couber no buffer do CDC (sem printf: roda também sob o lock do stdio)
+static void tx_drain(void) {
+    if (!tud_cdc_connected())
+        return;
+    uint32_t t = tx_tail;
+    uint32_t h = tx_head;
+    while (t != h) {
+        uint32_t room = tud_cdc_write_available();
+        if (!room)
+            break;
+        uint32_t n = h - t;
+        uint32_t contig = CONSOLE_TX_SIZE - (t & (CONSOLE_TX_SIZE - 1));
+        if (n > contig) n = contig;
+        if (n > room) n = room;
+        stdio_usb.out_chars(&tx_buf[t & (CONSOLE_TX_SIZE - 1)], (int)n);
+        t += n;
+        __dmb();
+        tx_tail = t;
+    }
+}
+
+uint32_t console_tx_free(void) {
+    return CONSOLE_TX_SIZE - (tx_head - tx_tail);
+}
+
+/**
+ * Escreve dados sem tradução de \n e sem descarte (quadros do xfer)
+ * Espera por espaço enviando o buffer; com o terminal fechado o restante é
+ * descartado, como o stdio_usb faria
+ */
+void console_write(const void *data, uint32_t len) {
+    const char *p = data;
+    while (len) {
+        uint32_t n = len < CONSOLE_WRITE_CHUNK ? len : CONSOLE_WRITE_CHUNK;
+        if (tx_put(p, n, false)) {
+            p += n;
+            len -= n;
+        } else if (tud_cdc_connected()) {
+            tx_drain();
+        } else {
+            tx_put(p, len, true);               // Não cabe: só conta o descarte
+            return;
+        }
+    }
+}
+
+/**
+ * Envia tudo o que está no buffer (antes de reiniciar, ao fim de um xfer)
+ * @return false se o prazo acabar ou o terminal fechar antes
+ */
+bool console_flush(uint32_t timeout_ms) {
+    absolute_time_t limite = make_timeout_time_ms(timeout_ms);
+    while (tx_tail != tx_head) {
+        if (!tud_cdc_connected() || time_reached(limite))
+            return false;
+        tx_drain();
+    }
+    return true;
+}
+
+void console_print_stats(void) {
+    printf("%-34s %lu de %u bytes\n", "Maior ocupação do terminal", (unsigned long)max_used,
+           CONSOLE_TX_SIZE);
+    printf("%-34s %lu (%lu bytes)\n", "Mensagens do terminal descartadas",
+           (unsigned long)dropped_msgs, (unsigned long)dropped_bytes);
+}
@@ -0,0 +1,41 @@
+/*
+ * ================================================================================
+ * TERMINAL USB SEM BLOQUEIO
+ * ================================================================================
+ *
+ * Descrição: Substitui o driver stdio_usb do stdio por um buffer circular de
+ *            transmissão: printf (de qualquer núcleo, inclusive do gravador)
+ *            apenas copia a mensagem e volta, e o laço principal envia o que
+ *            couber no buffer do CDC em console_service(). Mensagem que não
+ *            cabe no buffer é descartada inteira e contada, em vez de esperar
+ *            pelo computador; só os comandos do terminal (ls, cat...) esperam,
+ *            no laço principal, para a saída chegar inteira. A recepção passa
+ *            pelo mesmo caminho: os caracteres da USB são copiados para um
+ *            buffer circular, de onde getchar_timeout_us os lê.
+ * ================================================================================
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Buffers do terminal (potências de 2): ~40 linhas de saída aguardando o
+// computador
+#ifndef CONSOLE_TX_SIZE
+#define CONSOLE_TX_SIZE 4096
+#endif
+#ifndef CONSOLE_RX_SIZE
+#define CONSOLE_RX_SIZE 256
+#endif
+
+void console_init(void);
+void console_service(void);
+void console_set_blocking(bool on);
+uint32_t console_tx_free(void);
+void console_write(const void *data, uint32_t len);
+bool console_flush(uint32_t timeout_ms);
+void console_print_stats(void);
+
+#endif // CONSOLE_H
@@ -0,0 +1,189 @@
+/*
+ * ================================================================================
+ * AMOSTRAS PRESERVADAS EM RESET (WATCHDOG OU FALHA DURANTE A CAPTURA)
+ * ================================================================================
+ *
+ * Durante a captura as amostras passam do buffer circular para o setor do
+ * diário em montagem e dali para os buffers do gravador; nenhuma dessas
+ * etapas tem cópia no cartão. Em vez de guardar os buffers do gravador, a
+ * recuperação conta os registros que chegaram ao cartão e refaz o restante
+ * a partir do buffer circular, que guarda as últimas ACQ_RING_SIZE amostras
+ * e é bem maior que os buffers do gravador. O estado muda só na abertura de
+ * cada arquivo, então o CRC não pesa no caminho das amostras; as amostras
+ * são conferidas pelo número sequencial, que cresce a cada posição.
+ * ================================================================================
+ */
+
+#include "crash.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "acquisition.h"
+#include "crc.h"
+
+#define CRASH_MAGIC 0xDEADC0DEu
+
+/**
+ * Captura em andamento, mantida na RAM não inicializada
+ */
+typedef struct {
+    uint32_t magic;
+    char path[32];                  // Arquivo em gravação
+    mpu_log_header_t header;        // Cabeçalho, caso o primeiro buffer não tenha chegado ao cartão
+    uint32_t capture_id;            // Identificador dos setores do diário
+    uint32_t first;                 // Posição no buffer de aquisição da primeira amostra do arquivo
+    uint16_t crc;                   // CRC16 dos campos anteriores
+} crash_state_t;
+
+static crash_state_t state __attribute__((section(".uninitialized_data")));
+
+static uint16_t state_crc(void) {
+    return crc16_slice4((const char *)&state, offsetof(crash_state_t, crc));
+}
+
+static FRESULT write_sector(FIL *fil, const void *sector) {
+    UINT bw;
+    FRESULT fr = f_write(fil, sector, JRNL_SECTOR_SIZE, &bw);
+    return fr == FR_OK && bw != JRNL_SECTOR_SIZE ? FR_DENIED : fr;
+}
+
+/**
+ * Registra o arquivo recém-aberto; chamada ao gravar a primeira amostra
+ * @param first Posição da amostra no buffer de aquisição (acq_tail() - 1)
+ */
+void crash_arm(const char *path, const mpu_log_header_t *header, uint32_t capture_id, uint32_t first) {
+    state.magic = 0;                // Inválido até o CRC estar completo
+    if ((size_t)snprintf(state.path, sizeof state.path, "%s", path) >= sizeof state.path)
+        return;
+    state.header = *header;
+    state.capture_id = capture_id;
+    state.first = first;
+    state.crc = state_crc();
+    state.magic = CRASH_MAGIC;
+}
+
+/**
+ * Esquece a captura (ao fechar o arquivo e depois da recuperação)
+ */
+void crash_disarm(void) {
+    state.magic = 0;
+}
+
+/**
+ * Indica se o reset interrompeu uma captura; após o desligamento a RAM tem
+ * conteúdo aleatório e a assinatura ou o CRC não conferem
+ */
+bool crash_pending(void) {
+    return state.magic == CRASH_MAGIC && state.crc == state_crc();
+}
+
+const char *crash_path(void) {
+    return state.path;
+}
+
+/**
+ * Completa o arquivo interrompido com as amostras do buffer de aquisição
+ * que não chegaram ao cartão. O cartão deve estar montado e a aquisição
+ * ainda parada (o buffer é o da captura interrompida).
+ * @param j Diário de trabalho (o da captura, ocioso no boot)
+ * @param recovered Amostras acrescentadas ao arquivo
+ * @param lost Amostras sobrescritas no buffer antes do reset
+ */
+FRESULT crash_recover(jrnl_t *j, uint32_t *recovered, uint32_t *lost) {
+    static FIL fil;
+    *recovered = *lost = 0;
+    uint32_t per_sample = (state.header.flags & MPU_LOG_FLAG_DUAL) ? 2 : 1;
+    uint32_t per_sector = JRNL_RECORDS / per_sample;
+
+    // Setores válidos no cartão; só valem se o cabeçalho for o desta captura
+    // (a extensão pode ter dados de um arquivo apagado)
+    mpu_log_header_t h;
+    UINT br;
+    FRESULT fr = f_open(&fil, state.path, FA_READ);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_read(&fil, &h, sizeof h, &br);
+    f_close(&fil);
+    if (fr != FR_OK)
+        return fr;
+    bool header_ok = br == sizeof h && !memcmp(&h, &state.header, sizeof h);
+    if (header_ok && (fr = jrnl_recover(state.path)) != FR_OK)
+        return fr;
+
+    fr = f_open(&fil, state.path, FA_READ | FA_WRITE);
+    if (fr != FR_OK)
+        return fr;
+    uint32_t sectors = 0;
+    if (header_ok)
+        sectors = (uint32_t)(f_size(&fil) / JRNL_SECTOR_SIZE) - 1;
+    jrnl_sector_t *s = &j->sector[0];
+    if (sectors) {
+        // Todos os setores da captura saem cheios; um setor parcial no fim
+        // é o de jrnl_finish e o arquivo já estava completo
+        fr = f_lseek(&fil, (FSIZE_t)sectors * JRNL_SECTOR_SIZE);
+        if (fr == FR_OK)
+            fr = f_read(&fil, s, sizeof *s, &br);
+        if (fr == FR_OK && (br != sizeof *s || !jrnl_sector_valid(s, state.capture_id, sectors - 1)))
+            sectors = 0;                        // Setores de outra captura
+        else if (fr == FR_OK && s->hdr.count != per_sector * per_sample) {
+            f_close(&fil);
+            return FR_OK;
+        }
+    }
+
+    // Cabeçalho refeito quando o primeiro buffer não chegou ao cartão
+    if (fr == FR_OK && !sectors) {
+        memset(s, 0, sizeof *s);
+        memcpy(s, &state.header, sizeof state.header);
+        fr = f_lseek(&fil, 0);
+        if (fr == FR_OK)
+            fr = write_sector(&fil, s);
+    }
+    if (fr == FR_OK)
+        fr = f_lseek(&fil, (FSIZE_t)(sectors + 1) * JRNL_SECTOR_SIZE);
+
+    // Amostras seguintes à última gravada, até a mais recente do buffer; as
+    // que o produtor já sobrescreveu estão perdidas
+    uint32_t head = acq_head();
+    uint32_t pos = state.first + sectors * per_sector;
+    if ((int32_t)(head - pos) > ACQ_RING_SIZE) {
+        *lost = head - ACQ_RING_SIZE - pos;
+        pos = head - ACQ_RING_SIZE;
+    }
+    uint32_t last_us = state.header.start_us;
+    if (pos != state.first)
+        last_us = acq_ring_at(head - (pos - 1) <= ACQ_RING_SIZE ? pos - 1 : pos)->t_us;
+    uint32_t last_seq = acq_ring_at(pos)->seq - 1;
+
+    jrnl_resume(j, state.capture_id, sectors);
+    for (; fr == FR_OK && (int32_t)(head - pos) > 0; pos++) {
+        const mpu_sample_t *amostra = acq_ring_at(pos);
+        if ((int32_t)(amostra->seq - last_seq) <= 0)
+            break;                              // Fim das amostras coerentes
+        last_seq = amostra->seq;
+
+        mpu_log_record_t recs[2];
+        mpu_log_encode(&recs[0], amostra, &last_us, state.header.dt_unit_us);
+#if ACQ_SECOND_MPU
+        recs[1].dt = 0;
+        memcpy(recs[1].accel, amostra->accel2, sizeof recs[1].accel);
+        memcpy(recs[1].gyro, amostra->gyro2, sizeof recs[1].gyro);
+        recs[1].temp = amostra->temp2;
+#endif
+        const jrnl_sector_t *setor = jrnl_push(j, recs, per_sample);
+        if (setor)
+            fr = write_sector(&fil, setor);
+        (*recovered)++;
+    }
+    const jrnl_sector_t *setor = jrnl_finish(j);
+    if (fr == FR_OK && setor)
+        fr = write_sector(&fil, setor);
+
+    // Descarta o restante da pré-alocação
+    if (fr == FR_OK)
+        fr = f_truncate(&fil);
+    FRESULT rc = f_close(&fil);
+    return fr != FR_OK ? fr : rc;
+}
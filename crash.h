@@ -0,0 +1,32 @@
+/*
+ * ================================================================================
+ * AMOSTRAS PRESERVADAS EM RESET (WATCHDOG OU FALHA DURANTE A CAPTURA)
+ * ================================================================================
+ *
+ * Descrição: Guarda em RAM não inicializada, com assinatura e CRC, o arquivo
+ *            em gravação, o seu cabeçalho e a posição no buffer de aquisição
+ *            da primeira amostra. O buffer circular também sobrevive ao reset
+ *            (ACQ_RETAIN_RING): no boot seguinte crash_recover acha no cartão
+ *            o último setor do diário (journal.h) e acrescenta as amostras
+ *            que ainda estavam na RAM (no buffer circular ou nos buffers do
+ *            gravador) antes de a aquisição reutilizar o buffer.
+ * ================================================================================
+ */
+
+#ifndef CRASH_H
+#define CRASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+#include "journal.h"
+#include "mpu_log.h"
+
+void crash_arm(const char *path, const mpu_log_header_t *header, uint32_t capture_id, uint32_t first);
+void crash_disarm(void);
+bool crash_pending(void);
+const char *crash_path(void);
+FRESULT crash_recover(jrnl_t *j, uint32_t *recovered, uint32_t *lost);
+
+#endif // CRASH_H
@@ -0,0 +1,107 @@
+/*
+ * ================================================================================
+ * FILA DE EVENTOS DO LAÇO PRINCIPAL
+ * ================================================================================
+ *
+ * Fila circular protegida por spin lock de hardware, podendo receber eventos
+ * de interrupções e de qualquer núcleo. Cada publicação executa __sev, que
+ * acorda o consumidor parado em __wfe mesmo que o evento chegue entre o teste
+ * da fila e a instrução de espera.
+ * ================================================================================
+ */
+
+#include "events.h"
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if (EVT_QUEUE_LEN & (EVT_QUEUE_LEN - 1)) != 0
+#error "EVT_QUEUE_LEN deve ser potência de 2"
+#endif
+
+// Tipos agregáveis: no máximo um pendente na fila
+#define EVT_COALESCED ((1u << EVT_RX) | (1u << EVT_SAMPLES) | (1u << EVT_SD_DONE) | \
+                       (1u << EVT_TELEMETRY) | (1u << EVT_NET))
+
+static spin_lock_t *lock = NULL;
+static evt_t queue[EVT_QUEUE_LEN];
+static volatile uint32_t head = 0, tail = 0;
+static uint32_t pending = 0;                   // Tipos agregáveis na fila
+static uint32_t dropped = 0;                   // Eventos perdidos por fila cheia
+static uint64_t slept_us = 0;                  // Tempo dormindo em evt_wait_until
+
+/**
+ * Prepara a fila; chamar antes de habilitar as fontes de eventos
+ */
+void evt_init(void) {
+    if (!lock)
+        lock = spin_lock_init(spin_lock_claim_unused(true));
+}
+
+/**
+ * Publica um evento (seguro em interrupção e no outro núcleo)
+ * @return false se a fila estiver cheia e o evento foi descartado
+ */
+bool evt_post(evt_type_t type, uint32_t arg) {
+    uint32_t bit = 1u << type;
+    bool ok = true;
+
+    uint32_t irq = spin_lock_blocking(lock);
+    if (!(EVT_COALESCED & bit & pending)) {
+        if (head - tail >= EVT_QUEUE_LEN) {
+            dropped++;
+            ok = false;
+        } else {
+            queue[head & (EVT_QUEUE_LEN - 1)] = (evt_t){type, arg};
+            head++;
+            pending |= EVT_COALESCED & bit;
+        }
+    }
+    spin_unlock(lock, irq);
+
+    __sev();                                  // Acorda o laço principal em __wfe
+    return ok;
+}
+
+static bool evt_pop(evt_t *ev) {
+    bool ok = false;
+    uint32_t irq = spin_lock_blocking(lock);
+    if (head != tail) {
+        *ev = queue[tail & (EVT_QUEUE_LEN - 1)];
+        tail++;
+        pending &= ~(1u << ev->type);
+        ok = true;
+    }
+    spin_unlock(lock, irq);
+    return ok;
+}
+
+/**
+ * Retira o próximo evento, dormindo em __wfe enquanto a fila estiver vazia
+ * @param deadline Instante máximo de espera
+ * @return false se o prazo expirou sem eventos
+ */
+bool evt_wait_until(absolute_time_t deadline, evt_t *ev) {
+    while (!evt_pop(ev)) {
+        uint64_t t0 = time_us_64();
+        bool expired = best_effort_wfe_or_timeout(deadline);
+        slept_us += time_us_64() - t0;
+        if (expired)
+            return evt_pop(ev);
+    }
+    return true;
+}
+
+/**
+ * Total de eventos descartados por fila cheia
+ */
+uint32_t evt_dropped(void) {
+    return dropped;
+}
+
+/**
+ * Tempo acumulado que o consumidor passou dormindo à espera de eventos
+ */
+uint64_t evt_sleep_us(void) {
+    return slept_us;
+}
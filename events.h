@@ -0,0 +1,51 @@
+/*
+ * ================================================================================
+ * FILA DE EVENTOS DO LAÇO PRINCIPAL
+ * ================================================================================
+ *
+ * Descrição: Interrupções (botões, recepção serial, aquisição) e o núcleo 1
+ *            publicam eventos numa fila; o laço principal dorme em __wfe até
+ *            que haja um evento ou o prazo informado expire.
+ * ================================================================================
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/time.h"
+
+// Capacidade da fila (potência de 2)
+#ifndef EVT_QUEUE_LEN
+#define EVT_QUEUE_LEN 16
+#endif
+
+/**
+ * Tipos de evento
+ * Os marcados como agregáveis ficam no máximo uma vez na fila: uma nova
+ * publicação enquanto o anterior não foi tratado é absorvida por ele
+ */
+typedef enum {
+    EVT_BUTTON_A = 0,      // Botão A pressionado (após debounce)
+    EVT_BUTTON_B,          // Botão B pressionado (após debounce)
+    EVT_RX,                // Caracteres disponíveis no stdio (agregável)
+    EVT_SAMPLES,           // Amostras acumuladas no buffer de aquisição (agregável)
+    EVT_SD_DONE,           // Gravador do SD concluiu uma operação (agregável)
+    EVT_TELEMETRY,         // Amostras aguardando envio pela USB (agregável)
+    EVT_NET,               // Terminal remoto ou amostras aguardando o Wi-Fi (agregável)
+    EVT_COUNT
+} evt_type_t;
+
+typedef struct {
+    evt_type_t type;
+    uint32_t arg;
+} evt_t;
+
+void evt_init(void);
+bool evt_post(evt_type_t type, uint32_t arg);
+bool evt_wait_until(absolute_time_t deadline, evt_t *ev);
+uint32_t evt_dropped(void);
+uint64_t evt_sleep_us(void);
+
+#endif // EVENTS_H
@@ -0,0 +1,123 @@
+/*
+ * ================================================================================
+ * DISCO SIMULADO SOBRE UM ARQUIVO DE IMAGEM (BUILD DE HOST)
+ * ================================================================================
+ *
+ * A imagem é criada esparsa com o tamanho pedido; setores nunca gravados
+ * são lidos como zero, como num cartão recém-apagado.
+ * ================================================================================
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include "diskio_file.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ff.h"
+#include "diskio.h"
+
+#define SECTOR_SIZE 512
+
+static int fd = -1;
+static uint32_t n_sectors;
+static disk_file_stats_t stats;
+
+/**
+ * Cria (ou trunca) a imagem e a associa à unidade 0
+ * @param sectors Tamanho do disco em setores de 512 bytes
+ */
+bool disk_file_open(const char *path, uint32_t sectors) {
+    disk_file_close();
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    if (ftruncate(fd, (off_t)sectors * SECTOR_SIZE) != 0) {
+        perror(path);
+        disk_file_close();
+        return false;
+    }
+    n_sectors = sectors;
+    stats = (disk_file_stats_t){0};
+    return true;
+}
+
+void disk_file_close(void) {
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    n_sectors = 0;
+}
+
+void disk_file_get_stats(disk_file_stats_t *st) {
+    *st = stats;
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return (pdrv == 0 && fd >= 0) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    if (disk_status(pdrv))
+        return RES_NOTRDY;
+    if (sector + count > n_sectors)
+        return RES_PARERR;
+    size_t len = (size_t)count * SECTOR_SIZE;
+    if (pread(fd, buff, len, (off_t)sector * SECTOR_SIZE) != (ssize_t)len)
+        return RES_ERROR;
+    stats.reads++;
+    stats.read_sectors += count;
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    if (disk_status(pdrv))
+        return RES_NOTRDY;
+    if (sector + count > n_sectors)
+        return RES_PARERR;
+    size_t len = (size_t)count * SECTOR_SIZE;
+    if (pwrite(fd, buff, len, (off_t)sector * SECTOR_SIZE) != (ssize_t)len)
+        return RES_ERROR;
+    stats.writes++;
+    stats.write_sectors += count;
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    if (disk_status(pdrv))
+        return RES_NOTRDY;
+    switch (cmd) {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = n_sectors;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = SECTOR_SIZE;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;     // Bloco de apagamento desconhecido
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+// Carimbo de data dos arquivos pelo relógio do PC (FF_FS_NORTC = 0)
+DWORD get_fattime(void) {
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+    return (DWORD)(t->tm_year - 80) << 25 | (DWORD)(t->tm_mon + 1) << 21 |
+           (DWORD)t->tm_mday << 16 | (DWORD)t->tm_hour << 11 |
+           (DWORD)t->tm_min << 5 | (DWORD)(t->tm_sec / 2);
+}
@@ -0,0 +1,32 @@
+/*
+ * ================================================================================
+ * DISCO SIMULADO SOBRE UM ARQUIVO DE IMAGEM (BUILD DE HOST)
+ * ================================================================================
+ *
+ * Descrição: Implementa disk_* (diskio.h) sobre um arquivo comum, para rodar o
+ *            FatFs do firmware no PC. Só a unidade 0 existe; as demais
+ *            respondem STA_NOINIT.
+ * ================================================================================
+ */
+
+#ifndef DISKIO_FILE_H
+#define DISKIO_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Contadores de acesso ao disco simulado
+ */
+typedef struct {
+    uint32_t reads;         // Chamadas a disk_read
+    uint32_t writes;        // Chamadas a disk_write
+    uint64_t read_sectors;
+    uint64_t write_sectors;
+} disk_file_stats_t;
+
+bool disk_file_open(const char *path, uint32_t sectors);
+void disk_file_close(void);
+void disk_file_get_stats(disk_file_stats_t *st);
+
+#endif // DISKIO_FILE_H
@@ -0,0 +1,61 @@
+/*
+ * Substituto do hardware/dma.h para a build de host: só o que o ssd1306.c
+ * referencia; as transferências terminam na hora e não copiam nada
+ */
+
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+static inline int dma_claim_unused_channel(bool required) {
+    (void)required;
+    return 0;
+}
+
+static inline dma_channel_config dma_channel_get_default_config(unsigned int channel) {
+    (void)channel;
+    return (dma_channel_config){0};
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                                         enum dma_channel_transfer_size size) {
+    (void)c, (void)size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    (void)c, (void)incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    (void)c, (void)incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, unsigned int dreq) {
+    (void)c, (void)dreq;
+}
+
+static inline void dma_channel_configure(unsigned int channel, const dma_channel_config *config,
+                                         volatile void *write_addr, const volatile void *read_addr,
+                                         unsigned int transfer_count, bool trigger) {
+    (void)channel, (void)config, (void)write_addr, (void)read_addr, (void)transfer_count,
+        (void)trigger;
+}
+
+static inline bool dma_channel_is_busy(unsigned int channel) {
+    (void)channel;
+    return false;
+}
+
+static inline void dma_channel_abort(unsigned int channel) {
+    (void)channel;
+}
+
+#endif // HOST_HARDWARE_DMA_H
@@ -0,0 +1,33 @@
+/*
+ * Substituto mínimo do pico/stdlib.h para a build de host: relógio em
+ * microssegundos pelo CLOCK_MONOTONIC e as macros do SDK usadas pelos
+ * módulos portáteis
+ */
+
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef count_of
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+typedef unsigned int uint;
+
+static inline uint64_t time_us_64(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+static inline void tight_loop_contents(void) {}
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,839 @@
+/*
+ * ================================================================================
+ * MICROBENCHMARKS DO PIPELINE DE REGISTRO (BUILD DE HOST)
+ * ================================================================================
+ *
+ * Descrição: Mede no PC a vazão dos estágios portáteis do firmware (CRC do
+ *            SD, codificação e formatação das amostras, compressão, espectro,
+ *            atitude, gatilho, diário) e do FatFs gravando sobre uma imagem
+ *            de disco, incluindo a recuperação de uma captura interrompida,
+ *            e confere as primitivas de desenho do display SSD1306.
+ *            Cada estágio confere também o próprio resultado, de modo que o
+ *            programa serve de teste (ctest). Com -b, compara com uma
+ *            execução anterior e falha se algum estágio ficou mais lento que
+ *            a tolerância.
+ *
+ * Uso: mpu_bench [-q] [-o saida.csv] [-b referencia.csv] [-t tolerancia_%]
+ *                [-i imagem]
+ * ================================================================================
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "crc.h"
+#include "mpu_log.h"
+#include "mpu_pack.h"
+#include "spectrum.h"
+#include "attitude.h"
+#include "trigger.h"
+#include "journal.h"
+#include "config.h"
+#include "ssd1306.h"
+#include "font.h"
+#include "ff.h"
+#include "diskio_file.h"
+
+#define RATE_HZ        1000             // Taxa simulada
+#define TONE_HZ        50.0f            // Vibração senoidal no eixo do espectro
+#define N_SAMPLES      8192             // Amostras sintéticas (repetidas)
+#define IMAGE_SECTORS  (2048u * 2048u)  // Imagem esparsa de 2 GiB
+#define CLUSTER_SIZE   32768            // Cluster dos cartões SDHC formatados em FAT32
+#define WRITE_CHUNK    4096             // Tamanho das gravações (LOG_WRITER_BUF_SIZE)
+#define REPEAT         3                // Melhor de N execuções por estágio
+#define MAX_RESULTS    16
+
+typedef struct {
+    const char *name;
+    double value;
+    const char *unit;
+} result_t;
+
+static result_t results[MAX_RESULTS];
+static int n_results;
+static int failures;
+static uint32_t scale = 10;             // Multiplicador das iterações (-q: 1)
+
+static mpu_sample_t samples[N_SAMPLES];
+static uint8_t sector_data[512];
+static uint8_t file_buf[WRITE_CHUNK];
+static trg_t gatilho;
+static spec_t espectro;
+static mpu_pack_t pack;
+static jrnl_t jrnl;
+static volatile uint32_t sink;          // Impede que o compilador descarte os laços
+
+// ================================================================================
+// AUXILIARES
+// ================================================================================
+
+static double now_s(void) {
+    return time_us_64() * 1e-6;
+}
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("[ERRO] %s\n", what);
+        failures++;
+    }
+}
+
+static void report(const char *name, double value, const char *unit) {
+    printf("%-22s %12.2f %s\n", name, value, unit);
+    if (n_results < MAX_RESULTS)
+        results[n_results++] = (result_t){name, value, unit};
+}
+
+// Gerador xorshift32: dados reprodutíveis entre execuções
+static uint32_t rng = 0x2545F491u;
+static uint32_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/**
+ * Amostras parecidas com as reais: 1 g no eixo Z com vibração senoidal,
+ * ruído de poucos LSB e giroscópio quase parado; a cada 2000 amostras um
+ * impacto que dispara o gatilho
+ */
+static void make_samples(void) {
+    const float w = 6.28318531f * TONE_HZ / RATE_HZ;
+    for (uint32_t i = 0; i < N_SAMPLES; i++) {
+        mpu_sample_t *s = &samples[i];
+        memset(s, 0, sizeof *s);
+        s->seq = i;
+        s->t_us = i * (1000000u / RATE_HZ) + (next_rand() % 8);
+        int16_t noise = (int16_t)(next_rand() % 17) - 8;
+        s->accel[0] = (int16_t)(120 + noise);
+        s->accel[1] = (int16_t)(-340 + noise / 2);
+        s->accel[2] = (int16_t)(MPU_LOG_ACCEL_LSB_PER_G + 800.0f * sinf(w * i) + noise);
+        for (int k = 0; k < 3; k++)
+            s->gyro[k] = (int16_t)((int)(next_rand() % 33) - 16);
+        s->temp = (int16_t)(-500 + (next_rand() % 3));
+        if (i % 2000 == 1000)
+            s->accel[2] = 32000;
+    }
+}
+
+// ================================================================================
+// ESTÁGIOS
+// ================================================================================
+
+static void bench_crc(void) {
+    for (size_t i = 0; i < sizeof sector_data; i++)
+        sector_data[i] = (uint8_t)next_rand();
+    const char *d = (const char *)sector_data;
+    check(crc16(d, sizeof sector_data) == crc16_slice4(d, sizeof sector_data),
+          "crc16_slice4 difere de crc16");
+    const char cmd0[5] = {0x40, 0, 0, 0, 0};
+    check(((crc7(cmd0, 5) << 1) | 1) == (char)0x95, "crc7 do CMD0 diferente de 0x95");
+
+    uint32_t iters = 2000 * scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        double t0 = now_s();
+        for (uint32_t i = 0; i < iters; i++)
+            sink += crc16(d, sizeof sector_data);
+        double v = iters * sizeof sector_data / (now_s() - t0) / 1048576.0;
+        if (v > best) best = v;
+    }
+    report("crc16", best, "MiB/s");
+
+    best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        double t0 = now_s();
+        for (uint32_t i = 0; i < iters; i++)
+            sink += crc16_slice4(d, sizeof sector_data);
+        double v = iters * sizeof sector_data / (now_s() - t0) / 1048576.0;
+        if (v > best) best = v;
+    }
+    report("crc16_slice4", best, "MiB/s");
+}
+
+static void bench_encode(void) {
+    mpu_log_header_t h;
+    mpu_log_header_init(&h, RATE_HZ, samples[0].t_us);
+    uint32_t passes = 20 * scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        uint32_t last_us = samples[0].t_us;
+        mpu_log_record_t rec;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++) {
+            last_us = samples[0].t_us;
+            for (uint32_t i = 0; i < N_SAMPLES; i++) {
+                mpu_log_encode(&rec, &samples[i], &last_us, h.dt_unit_us);
+                sink += rec.dt;
+            }
+        }
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+        // O instante reconstruído acompanha o real a menos de uma unidade de dt
+        check(samples[N_SAMPLES - 1].t_us - last_us < h.dt_unit_us, "dt acumulou erro de arredondamento");
+    }
+    report("mpu_log_encode", best, "Mamostras/s");
+}
+
+static void bench_format_csv(void) {
+    char line[MPU_LOG_CSV_LINE_MAX], ref[MPU_LOG_CSV_LINE_MAX];
+    mpu_log_scale_t sc;
+    mpu_log_scale_init(&sc, MPU_LOG_ACCEL_LSB_PER_G, MPU_LOG_GYRO_LSB_PER_DPS);
+    mpu_log_clock_t t;
+    mpu_log_clock_init(&t, 0xFFFFFF00u);
+    mpu_log_clock_advance(&t, 0x00000100u);     // Volta do time_us_32
+    mpu_log_clock_advance(&t, 0x00000050u);     // Anterior: não recua
+    int len = mpu_log_format_csv(line, sizeof line, 7, &t, samples[0].accel, samples[0].gyro,
+                                 &sc, 1.5f, -2.25f);
+    check(len > 0 && line[len - 1] == '\n' && strncmp(line, "7,0.000512,", 11) == 0, "linha CSV malformada");
+    for (int i = 0; i < 3; i++)
+        mpu_log_clock_advance(&t, t.last_us + 999999u);
+    check(t.s == 3 && t.us == 509, "tempo do CSV acumulou erro");     // 512 + 3 x 999999 µs
+
+    // Mesmo texto do printf em ponto flutuante, nos extremos de cada faixa
+    // Inclui empates na terceira casa (1024 e 5120 em ±2 g, 512 em ±4 g)
+    static const int16_t raws[] = {0, 1, -1, 7, -123, 4096, -16384, 16383, 32767, -32768,
+                                   1024, -1024, 3072, 5120, -5120, 512, -512, 2560};
+    int diff = 0;
+    for (int range = 0; range < 4; range++) {
+        float a_lsb = 16384.0f / (1 << range), g_lsb = 131.0f / (1 << range);
+        mpu_log_scale_init(&sc, a_lsb, g_lsb);
+        for (size_t i = 0; i < count_of(raws); i++) {
+            int16_t a[3] = {raws[i], raws[i], raws[i]}, g[3] = {raws[i], raws[i], raws[i]};
+            mpu_log_format_csv(line, sizeof line, 1, &t, a, g, &sc, -12.345f, 0.004f);
+            snprintf(ref, sizeof ref, "1,%lu.%06lu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f\n",
+                     (unsigned long)t.s, (unsigned long)t.us,
+                     raws[i] / a_lsb, raws[i] / a_lsb, raws[i] / a_lsb,
+                     raws[i] / g_lsb, raws[i] / g_lsb, raws[i] / g_lsb, -12.345f, 0.004f);
+            // O printf escreve -0.000 para negativos que arredondam a zero
+            for (char *z; (z = strstr(ref, "-0.000,")) != NULL;)
+                memmove(z, z + 1, strlen(z));
+            if (strcmp(line, ref))
+                diff++;
+        }
+    }
+    check(diff == 0, "CSV em ponto fixo difere do printf");
+    mpu_log_scale_init(&sc, MPU_LOG_ACCEL_LSB_PER_G, MPU_LOG_GYRO_LSB_PER_DPS);
+
+    uint32_t passes = scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++)
+                sink += mpu_log_format_csv(line, sizeof line, i, &t, samples[i].accel, samples[i].gyro,
+                                           &sc, 0.0f, 0.0f);
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+    }
+    report("mpu_log_format_csv", best, "Mamostras/s");
+}
+
+static void bench_pack(void) {
+    mpu_log_record_t recs[N_SAMPLES];
+    uint32_t last_us = samples[0].t_us;
+    for (uint32_t i = 0; i < N_SAMPLES; i++)
+        mpu_log_encode(&recs[i], &samples[i], &last_us, 1);
+
+    uint32_t passes = 4 * scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        mpu_pack_init(&pack, MPU_PACK_BLOCK_SIZE - sizeof(mpu_log_header_t));
+        uint32_t len, blocks = 0;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++)
+                if (mpu_pack_push(&pack, &recs[i], &len)) {
+                    check(len % MPU_PACK_BLOCK_SIZE == 0 || blocks == 0, "bloco fora da fronteira de setor");
+                    blocks++;
+                }
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (mpu_pack_finish(&pack, &len))
+            blocks++;
+        if (v > best) best = v;
+        check(blocks > 0 && pack.packed_bytes < pack.raw_bytes, "compressão não reduziu o tamanho");
+    }
+    report("mpu_pack_push", best, "Mamostras/s");
+    printf("%-22s %12.2f %%\n", "  taxa de compressão", 100.0 * pack.packed_bytes / pack.raw_bytes);
+}
+
+static uint32_t get_varint(const uint8_t *src, uint32_t *v) {
+    uint32_t n = 0, shift = 0;
+    *v = 0;
+    do {
+        *v |= (uint32_t)(src[n] & 0x7F) << shift;
+        shift += 7;
+    } while (src[n++] & 0x80);
+    return n;
+}
+
+// Decodifica um bloco no formato de mpu_pack.h; devolve os registros lidos
+static uint32_t ref_unpack(const uint8_t *b, uint32_t size, mpu_log_record_t *out) {
+    enum { FIELDS = (sizeof(mpu_log_record_t) - 2) / 2 };
+    uint16_t count, used;
+    memcpy(&count, &b[0], 2);
+    memcpy(&used, &b[2], 2);
+    if (!count || used > size)
+        return 0;
+    uint32_t pos = 4;
+    memcpy(&out[0], &b[pos], sizeof *out);
+    pos += sizeof *out;
+    for (uint32_t r = 1; r < count; r++) {
+        mpu_log_record_t *rec = &out[r];
+        int16_t f[FIELDS];
+        uint32_t v;
+        pos += get_varint(&b[pos], &v);
+        rec->dt = (uint16_t)(out[r - 1].dt + (int16_t)((v >> 2) ^ -((v >> 1) & 1)));
+        if (v & 1) {
+            memcpy(f, &b[pos], sizeof f);
+            pos += sizeof f;
+        } else {
+            memcpy(f, (const uint8_t *)&out[r - 1] + 2, sizeof f);
+            for (uint32_t i = 0; i < FIELDS; i++) {
+                pos += get_varint(&b[pos], &v);
+                f[i] = (int16_t)(f[i] + (int16_t)((v >> 1) ^ -(v & 1)));
+            }
+        }
+        memcpy((uint8_t *)rec + 2, f, sizeof f);
+    }
+    return pos == used ? count : 0;
+}
+
+/**
+ * Compressão: ida e volta byte a byte por um decodificador de referência,
+ * com registros de campos sorteados em toda a faixa para exercitar a
+ * gravação bruta e blocos que cruzam a fronteira do primeiro setor
+ */
+static void check_pack(void) {
+    static mpu_log_record_t recs[N_SAMPLES], dec[N_SAMPLES + MPU_PACK_BLOCK_SIZE];
+    uint32_t last_us = samples[0].t_us;
+    for (uint32_t i = 0; i < N_SAMPLES; i++) {
+        mpu_log_encode(&recs[i], &samples[i], &last_us, 1);
+        if (i % 97 == 5)
+            for (uint32_t k = 0; k < sizeof recs[i]; k++)
+                ((uint8_t *)&recs[i])[k] = (uint8_t)next_rand();
+    }
+
+    mpu_pack_init(&pack, MPU_PACK_BLOCK_SIZE - sizeof(mpu_log_header_t));
+    uint32_t len, n = 0, blocks = 0, bad = 0;
+    const uint8_t *b;
+    for (uint32_t i = 0; i <= N_SAMPLES; i++) {
+        b = i < N_SAMPLES ? mpu_pack_push(&pack, &recs[i], &len) : mpu_pack_finish(&pack, &len);
+        if (!b)
+            continue;
+        uint32_t got = ref_unpack(b, len, &dec[n]);
+        if (!got)
+            bad++;
+        n += got;
+        blocks++;
+    }
+    check(bad == 0 && n == N_SAMPLES && memcmp(recs, dec, sizeof recs) == 0,
+          "compressão não reproduz os registros");
+    check(blocks > 1 && pack.packed_bytes < pack.raw_bytes, "compressão não reduziu o tamanho");
+}
+
+static void bench_spectrum(void) {
+    uint32_t passes = scale;
+    double best = 0;
+    spec_record_t rec;
+    for (int r = 0; r < REPEAT; r++) {
+        spec_init(&espectro, RATE_HZ, MPU_LOG_ACCEL_LSB_PER_G);
+        uint32_t windows = 0, peak_ok = 0;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++)
+                if (spec_push(&espectro, &samples[i], &rec)) {
+                    windows++;
+                    // Pico no tom simulado, dentro de um bin (unit_hz = 0,1 Hz)
+                    if (fabsf(rec.peak * 0.1f - TONE_HZ) <= (float)RATE_HZ / SPEC_FFT_N)
+                        peak_ok++;
+                }
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+        // Janelas com o impacto podem deslocar o pico; a maioria não
+        check(windows > 0 && peak_ok * 10 >= windows * 8, "pico do espectro fora do tom simulado");
+    }
+    report("spec_push", best, "Mamostras/s");
+}
+
+static void bench_attitude(void) {
+    uint32_t passes = 10 * scale;
+    double best = 0;
+    attitude_t att;
+    for (int r = 0; r < REPEAT; r++) {
+        att_init(&att, ATT_TAU_S, MPU_LOG_GYRO_LSB_PER_DPS);
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++)
+                att_update(&att, &samples[i]);
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+    }
+    // Sensor quase nivelado: roll e pitch de poucos graus
+    check(fabsf(att.roll) < 10.0f && fabsf(att.pitch) < 10.0f, "atitude divergiu");
+    report("att_update", best, "Mamostras/s");
+}
+
+static void bench_trigger(void) {
+    uint32_t passes = 10 * scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        trg_init(&gatilho, RATE_HZ, 100, 100, 1000, 0.5f, 250.0f,
+                 MPU_LOG_ACCEL_LSB_PER_G, MPU_LOG_GYRO_LSB_PER_DPS);
+        uint32_t starts = 0;
+        mpu_sample_t pre;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++) {
+                trg_result_t res = trg_push(&gatilho, &samples[i]);
+                if (res == TRG_START) {
+                    starts++;
+                    while (trg_pop_pre(&gatilho, &pre))
+                        sink += pre.seq;
+                } else if (res == TRG_LAST) {
+                    trg_rearm(&gatilho);
+                }
+            }
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+        check(starts == passes * ((N_SAMPLES + 999) / 2000), "número de eventos diferente dos impactos");
+    }
+    report("trg_push", best, "Mamostras/s");
+}
+
+// Primitivas do SSD1306 como eram antes do desenho por byte: pixel a pixel
+static void ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height,
+                     bool value, bool fill) {
+    for (uint8_t x = left; x < left + width; ++x) {
+        ssd1306_pixel(ssd, x, top, value);
+        ssd1306_pixel(ssd, x, top + height - 1, value);
+    }
+    for (uint8_t y = top; y < top + height; ++y) {
+        ssd1306_pixel(ssd, left, y, value);
+        ssd1306_pixel(ssd, left + width - 1, y, value);
+    }
+    if (fill)
+        for (uint8_t x = left + 1; x < left + width - 1; ++x)
+            for (uint8_t y = top + 1; y < top + height - 1; ++y)
+                ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_line(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value) {
+    int dx = abs(x1 - x0), dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    for (;;) {
+        ssd1306_pixel(ssd, x0, y0, value);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = err * 2;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+static void ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t line = font[index + i];
+        for (uint8_t j = 0; j < 8; ++j)
+            ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+    }
+}
+
+// Sem envio pendente: só o que a próxima primitiva alterar fica marcado
+static void ssd_clean(ssd1306_t *ssd) {
+    memset(ssd->dirty_x0, 0xFF, sizeof ssd->dirty_x0);
+    memset(ssd->dirty_x1, 0, sizeof ssd->dirty_x1);
+}
+
+static bool ssd_same(const ssd1306_t *a, const ssd1306_t *b) {
+    return !memcmp(a->ram_buffer, b->ram_buffer, a->bufsize) &&
+           !memcmp(a->dirty_x0, b->dirty_x0, sizeof a->dirty_x0) &&
+           !memcmp(a->dirty_x1, b->dirty_x1, sizeof a->dirty_x1);
+}
+
+/**
+ * Display: preenchimento, retângulos, linhas e caracteres por byte contra as
+ * versões pixel a pixel, em buffer e faixas alteradas. As versões antigas
+ * não recortavam na borda, então as figuras sorteadas cabem na tela
+ */
+static void check_ssd1306(void) {
+    static ssd1306_t a, b;
+    ssd1306_init(&a, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_init(&b, WIDTH, HEIGHT, false, 0x3C, NULL);
+    int diff = 0;
+    for (int i = 0; i < 20000; i++) {
+        uint32_t r = next_rand();
+        bool v = r & 1, fill = r & 2;
+        uint8_t x0 = next_rand() % WIDTH, x1 = next_rand() % WIDTH;
+        uint8_t y0 = next_rand() % HEIGHT, y1 = next_rand() % HEIGHT;
+        uint8_t lo_x = x0 < x1 ? x0 : x1, hi_x = x0 < x1 ? x1 : x0;
+        uint8_t lo_y = y0 < y1 ? y0 : y1, hi_y = y0 < y1 ? y1 : y0;
+        ssd_clean(&a);
+        ssd_clean(&b);
+        switch ((r >> 2) % 5) {
+        case 0:
+            if ((r >> 8) % 16)
+                continue;       // Raro: apaga ou acende a tela inteira
+            ssd1306_fill(&a, v);
+            for (uint8_t y = 0; y < HEIGHT; ++y)
+                for (uint8_t x = 0; x < WIDTH; ++x)
+                    ssd1306_pixel(&b, x, y, v);
+            break;
+        case 1:
+            ssd1306_rect(&a, lo_y, lo_x, hi_x - lo_x + 1, hi_y - lo_y + 1, v, fill);
+            ref_rect(&b, lo_y, lo_x, hi_x - lo_x + 1, hi_y - lo_y + 1, v, fill);
+            break;
+        case 2:
+            ssd1306_line(&a, x0, y0, x1, y1, v);
+            ref_line(&b, x0, y0, x1, y1, v);
+            break;
+        case 3:
+            ssd1306_hline(&a, lo_x, hi_x, y0, v);
+            ref_line(&b, lo_x, y0, hi_x, y0, v);
+            break;
+        case 4:
+            ssd1306_vline(&a, x0, lo_y, hi_y, v);
+            ref_line(&b, x0, lo_y, x0, hi_y, v);
+            break;
+        }
+        if (!ssd_same(&a, &b)) {
+            diff++;
+            memcpy(b.ram_buffer, a.ram_buffer, a.bufsize);
+        }
+    }
+    check(diff == 0, "primitivas do SSD1306 diferem do desenho pixel a pixel");
+
+    // Caracteres (inclusive fora de ' '..'~') em posições que não
+    // coincidem com as páginas, sobre o desenho que sobrou acima
+    diff = 0;
+    for (int i = 0; i < 50000; i++) {
+        char c = (char)next_rand();
+        uint8_t x = next_rand() % (WIDTH - 7), y = next_rand() % (HEIGHT - 7);
+        ssd_clean(&a);
+        ssd_clean(&b);
+        ssd1306_draw_char(&a, c, x, y);
+        ref_draw_char(&b, c, x, y);
+        if (!ssd_same(&a, &b)) {
+            diff++;
+            memcpy(b.ram_buffer, a.ram_buffer, a.bufsize);
+        }
+    }
+    check(diff == 0, "caracteres do SSD1306 diferem do desenho pixel a pixel");
+}
+
+/**
+ * Gravação dos blocos do compressor pelo FatFs sobre a imagem, em
+ * gravações de WRITE_CHUNK, seguida da leitura e conferência
+ */
+static void bench_fatfs(const char *image) {
+    static FATFS fs;
+    static FIL fil;
+    static BYTE work[FF_MAX_SS * 4];
+    if (!disk_file_open(image, IMAGE_SECTORS)) {
+        check(false, "imagem de disco não criada");
+        return;
+    }
+    MKFS_PARM opt = {FM_FAT32, 0, 0, 0, CLUSTER_SIZE};
+    FRESULT fr = f_mkfs("0:", &opt, work, sizeof work);
+    if (fr == FR_OK)
+        fr = f_mount(&fs, "0:", 1);
+    if (fr != FR_OK) {
+        printf("[ERRO] f_mkfs/f_mount: %d\n", fr);
+        failures++;
+        disk_file_close();
+        return;
+    }
+
+    disk_file_stats_t st0, st;
+    disk_file_get_stats(&st0);                  // Sem os acessos do f_mkfs
+    uint32_t chunks = 256 * scale / 10 + 64;   // 1 a 10 MiB
+    for (size_t i = 0; i < sizeof file_buf; i++)
+        file_buf[i] = (uint8_t)next_rand();
+    unsigned short crc_w = 0, crc_r = 0;
+    double best_w = 0, best_r = 0;
+    for (int r = 0; r < REPEAT && fr == FR_OK; r++) {
+        UINT n;
+        fr = f_open(&fil, "0:bench.bin", FA_WRITE | FA_CREATE_ALWAYS);
+        double t0 = now_s();
+        crc_w = 0;
+        for (uint32_t i = 0; fr == FR_OK && i < chunks; i++) {
+            file_buf[0] = (uint8_t)i;
+            update_crc16_slice4(&crc_w, (const char *)file_buf, sizeof file_buf);
+            fr = f_write(&fil, file_buf, sizeof file_buf, &n);
+        }
+        if (fr == FR_OK)
+            fr = f_close(&fil);
+        double v = chunks * sizeof file_buf / (now_s() - t0) / 1048576.0;
+        if (v > best_w) best_w = v;
+
+        if (fr == FR_OK)
+            fr = f_open(&fil, "0:bench.bin", FA_READ);
+        t0 = now_s();
+        crc_r = 0;
+        for (uint32_t i = 0; fr == FR_OK && i < chunks; i++) {
+            fr = f_read(&fil, file_buf, sizeof file_buf, &n);
+            update_crc16_slice4(&crc_r, (const char *)file_buf, n);
+        }
+        if (fr == FR_OK)
+            fr = f_close(&fil);
+        v = chunks * sizeof file_buf / (now_s() - t0) / 1048576.0;
+        if (v > best_r) best_r = v;
+    }
+    check(fr == FR_OK, "erro do FatFs na imagem");
+    check(crc_w == crc_r, "arquivo lido difere do gravado");
+    report("fatfs_write", best_w, "MiB/s");
+    report("fatfs_read", best_r, "MiB/s");
+
+    disk_file_get_stats(&st);
+    uint32_t writes = st.writes - st0.writes;
+    printf("%-22s %12.2f setores/gravação\n", "  disk_write",
+           writes ? (double)(st.write_sectors - st0.write_sectors) / writes : 0.0);
+    f_unmount("0:");
+    disk_file_close();
+    remove(image);
+}
+
+// Grava `sectors` setores de diário da captura `id` a partir do início de fp
+static FRESULT write_journal(FIL *fp, uint32_t id, uint32_t sectors) {
+    mpu_log_header_t h;
+    mpu_log_header_init(&h, RATE_HZ, samples[0].t_us);
+    h.flags |= MPU_LOG_FLAG_JOURNAL;
+    uint8_t first[JRNL_SECTOR_SIZE] = {0};
+    memcpy(first, &h, sizeof h);
+    UINT bw;
+    FRESULT fr = f_write(fp, first, sizeof first, &bw);
+
+    jrnl_init(&jrnl, id);
+    uint32_t last_us = samples[0].t_us, written = 0;
+    mpu_log_record_t rec;
+    for (uint32_t i = 0; fr == FR_OK && written < sectors; i++) {
+        mpu_log_encode(&rec, &samples[i % N_SAMPLES], &last_us, h.dt_unit_us);
+        const jrnl_sector_t *s = jrnl_push(&jrnl, &rec, 1);
+        if (s) {
+            fr = f_write(fp, s, sizeof *s, &bw);
+            written++;
+        }
+    }
+    return fr;
+}
+
+/**
+ * config.ini: chaves válidas aplicadas; linha inválida ignorada sem perder
+ * as demais (cartão já montado)
+ */
+static void check_config(void) {
+    static FIL fil;
+    static const char ini[] =
+        "# captura\r\n[mpu]\r\nrate_div = 3\r\nDLPF=0\r\naccel_range_g = 8 ; faixa\r\n"
+        "gyro_range_dps = 300\r\nfile = teste.bin\r\nsync_s\r\nsegment_s = 600\n";
+    UINT bw;
+    FRESULT fr = f_open(&fil, "0:" CFG_FILE, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK)
+        fr = f_write(&fil, ini, sizeof ini - 1, &bw);
+    if (fr == FR_OK)
+        fr = f_close(&fil);
+
+    cfg_t cfg = {.sample_rate_hz = 100, .gyro_range = 1, .sync_s = 5};
+    if (fr == FR_OK)
+        fr = cfg_load("0:" CFG_FILE, &cfg);
+    check(fr == FR_OK, "erro do FatFs ao ler o config.ini");
+    // rate_div recusado com dlpf = 0: a taxa anterior fica
+    check(cfg.sample_rate_hz == 100 && cfg.dlpf == 0 && cfg.accel_range == 2 &&
+          cfg.gyro_range == 1 && cfg.sync_s == 5 && cfg.segment_s == 600 &&
+          !strcmp(cfg.filename, "teste.bin"), "config.ini lido com valores errados");
+
+    // rate_div sobre a base de 1 kHz mesmo com o dlpf depois dele
+    static const char div_ini[] = "rate_div = 3\ndlpf = 2\n";
+    fr = f_open(&fil, "0:" CFG_FILE, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK)
+        fr = f_write(&fil, div_ini, sizeof div_ini - 1, &bw);
+    if (fr == FR_OK)
+        fr = f_close(&fil);
+    cfg.dlpf = 0;
+    if (fr == FR_OK)
+        fr = cfg_load("0:" CFG_FILE, &cfg);
+    check(fr == FR_OK && cfg.sample_rate_hz == 250 && cfg.dlpf == 2, "rate_div aplicado antes do dlpf");
+    f_unlink("0:" CFG_FILE);
+}
+
+/**
+ * Diário: vazão do jrnl_push e uma queda de energia simulada. O arquivo é
+ * pré-alocado sobre os setores de uma captura apagada (outro identificador)
+ * e abandonado sem f_close; a recuperação deve achar o último setor gravado
+ */
+static void bench_journal(const char *image) {
+    mpu_log_record_t recs[N_SAMPLES];
+    uint32_t last_us = samples[0].t_us;
+    for (uint32_t i = 0; i < N_SAMPLES; i++)
+        mpu_log_encode(&recs[i], &samples[i], &last_us, 1);
+
+    uint32_t passes = 10 * scale;
+    double best = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        jrnl_init(&jrnl, 1);
+        double t0 = now_s();
+        for (uint32_t p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < N_SAMPLES; i++)
+                if (jrnl_push(&jrnl, &recs[i], 1))
+                    sink++;
+        double v = (double)passes * N_SAMPLES / (now_s() - t0) / 1e6;
+        if (v > best) best = v;
+    }
+    report("jrnl_push", best, "Mamostras/s");
+
+    static FATFS fs;
+    static FIL fil;
+    static BYTE work[FF_MAX_SS * 4];
+    if (!disk_file_open(image, IMAGE_SECTORS)) {
+        check(false, "imagem de disco não criada");
+        return;
+    }
+    MKFS_PARM opt = {FM_FAT32, 0, 0, 0, CLUSTER_SIZE};
+    FRESULT fr = f_mkfs("0:", &opt, work, sizeof work);
+    if (fr == FR_OK)
+        fr = f_mount(&fs, "0:", 1);
+
+    const uint32_t extent = 256, written = 100;    // Setores de diário
+    FSIZE_t size = (FSIZE_t)(extent + 1) * JRNL_SECTOR_SIZE;
+    // Captura anterior ocupando toda a extensão, depois apagada
+    if (fr == FR_OK)
+        fr = f_open(&fil, "0:old.bin", FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK)
+        fr = write_journal(&fil, 0xA5A5A5A5u, extent);
+    if (fr == FR_OK)
+        fr = f_close(&fil);
+    if (fr == FR_OK)
+        fr = f_unlink("0:old.bin");
+
+    // Nova captura: pré-aloca, sincroniza uma vez e perde a energia
+    if (fr == FR_OK)
+        fr = f_open(&fil, "0:crash.bin", FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK)
+        fr = f_expand(&fil, size, 1);
+    if (fr == FR_OK)
+        fr = f_sync(&fil);
+    if (fr == FR_OK)
+        fr = write_journal(&fil, 0x12345678u, written);
+    if (fr == FR_OK) {
+        f_unmount("0:");                        // Sem f_close: o FIL é abandonado
+        fr = f_mount(&fs, "0:", 1);
+    }
+
+    FILINFO fno;
+    double t0 = now_s();
+    if (fr == FR_OK)
+        fr = jrnl_recover_dir("0:");
+    double dt_ms = (now_s() - t0) * 1e3;
+    if (fr == FR_OK)
+        fr = f_stat("0:crash.bin", &fno);
+    check(fr == FR_OK, "erro do FatFs no teste do diário");
+    check(fr != FR_OK || fno.fsize == (FSIZE_t)(written + 1) * JRNL_SECTOR_SIZE,
+          "recuperação não parou no último setor gravado");
+    printf("%-22s %12.2f ms\n", "  jrnl_recover_dir", dt_ms);
+    if (fr == FR_OK)
+        check_config();
+
+    f_unmount("0:");
+    disk_file_close();
+    remove(image);
+}
+
+// ================================================================================
+// RESULTADOS E COMPARAÇÃO
+// ================================================================================
+
+static void save_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        failures++;
+        return;
+    }
+    fprintf(f, "stage,value,unit\n");
+    for (int i = 0; i < n_results; i++)
+        fprintf(f, "%s,%.3f,%s\n", results[i].name, results[i].value, results[i].unit);
+    fclose(f);
+}
+
+/**
+ * Compara com uma execução anterior (mesmo formato de -o)
+ * @param tol_pct Queda de vazão aceita, em porcentagem
+ */
+static void compare_baseline(const char *path, double tol_pct) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        failures++;
+        return;
+    }
+    char line[128], name[64];
+    double ref;
+    printf("\nComparação com %s (tolerância %.0f%%):\n", path, tol_pct);
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, "%63[^,],%lf", name, &ref) != 2)
+            continue;                           // Cabeçalho
+        for (int i = 0; i < n_results; i++) {
+            if (strcmp(results[i].name, name) != 0)
+                continue;
+            double delta = 100.0 * (results[i].value - ref) / ref;
+            bool slow = results[i].value < ref * (1.0 - tol_pct / 100.0);
+            printf("%-22s %+8.1f%%%s\n", name, delta, slow ? "  [REGRESSÃO]" : "");
+            if (slow)
+                failures++;
+        }
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv) {
+    const char *out = NULL, *baseline = NULL, *image = "mpu_bench.img";
+    double tol_pct = 20.0;
+    int c;
+    while ((c = getopt(argc, argv, "qo:b:t:i:")) != -1) {
+        switch (c) {
+        case 'q': scale = 1; break;
+        case 'o': out = optarg; break;
+        case 'b': baseline = optarg; break;
+        case 't': tol_pct = atof(optarg); break;
+        case 'i': image = optarg; break;
+        default:
+            fprintf(stderr, "uso: %s [-q] [-o saida.csv] [-b referencia.csv] [-t tolerancia_%%] [-i imagem]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    make_samples();
+    bench_crc();
+    bench_encode();
+    bench_format_csv();
+    bench_pack();
+    check_pack();
+    bench_spectrum();
+    bench_attitude();
+    bench_trigger();
+    check_ssd1306();
+    bench_fatfs(image);
+    bench_journal(image);
+
+    if (out)
+        save_csv(out);
+    if (baseline)
+        compare_baseline(baseline, tol_pct);
+    if (failures)
+        printf("\n%d falha(s)\n", failures);
+    return failures ? 1 : 0;
+}
@@ -9,6 +9,8 @@
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */
+//
+#include "prof.h"
 
 /* 
 This example assumes the following hardware configuration:
@@ -19,12 +21,19 @@ This example assumes the following hardware configuration:
 | MOSI  | TX    | 19    | 25    | DI        | DI        | Master Out, Slave In   |
 | SCK   | SCK   | 18    | 24    | SCLK      | CLK       | SPI clock              |
 | CS0   | CSn   | 17    | 22    | SS or CS  | CS        | Slave (or Chip) Select |
+| CS1   |       | 20    | 26    | SS or CS  | CS        | Second card (optional) |
 | DET   |       | 22    | 29    |           | CD        | Card Detect            |
 | GND   |       |       | 18,23 |           | GND       | Ground                 |
 | 3v3   |       |       | 36    |           | 3v3       | 3.3 volt power         |
 
 */
 
+// Second SD card "1:" on the same SPI, for mirrored or striped logging
+// (MPU_LOG_SECOND_SD in Data_logger.c)
+#ifndef SD_SECOND_CARD
+#define SD_SECOND_CARD 0
+#endif
+
 // Hardware Configuration of SPI "objects"
 // Note: multiple SD cards can be driven by one SPI if they use different slave
 // selects.
@@ -35,9 +44,9 @@ static spi_t spis[] = {  // One for each SPI.
         .mosi_gpio = 19,
         .sck_gpio = 18,
 
-        // .baud_rate = 1000 * 1000
-        .baud_rate = 1000 * 1000
-        // .baud_rate = 25 * 1000 * 1000 // Actual frequency: 20833333.
+        // Ceiling for the data clock: sd_init negotiates the fastest step
+        // (25/20.8/12.5 MHz) that passes a CRC-checked test, else 1 MHz
+        .baud_rate = 25 * 1000 * 1000 // Actual frequency: 20833333.
     }};
 
 // Hardware Configuration of the SD Card "objects"
@@ -50,7 +59,16 @@ static sd_card_t sd_cards[] = {  // One for each SD card
         .card_detect_gpio = 22,  // Card detect
         .card_detected_true = -1  // What the GPIO read returns when a card is
                                  // present.
-    }};
+    },
+#if SD_SECOND_CARD
+    {
+        .pcName = "1:",
+        .spi = &spis[0],  // Shares the bus; only the slave select differs
+        .ss_gpio = 20,
+        .use_card_detect = false,
+    },
+#endif
+};
 
 /* ********************************************************************** */
 size_t sd_get_num() { return count_of(sd_cards); }
@@ -72,4 +90,13 @@ spi_t *spi_get_by_num(size_t num) {
     }
 }
 
+// Instrumentation hooks of the SD driver (weak no-ops in sd_card.c) feed
+// the "stats" command
+#if PROF_ENABLED
+void sd_card_wait_hook(uint32_t wait_us) { PROF_RECORD(PROF_SD_WAIT, wait_us); }
+void sd_card_event_hook(sd_event_t event) {
+    PROF_COUNT(event == SD_EVENT_CRC_ERROR ? PROF_SD_CRC_ERRORS : PROF_SD_RETRIES);
+}
+#endif
+
 /* [] END OF FILE */
@@ -0,0 +1,236 @@
+/*
+ * ================================================================================
+ * SINALIZAÇÃO NÃO BLOQUEANTE - BUZZER E LEDs
+ * ================================================================================
+ *
+ * Cada saída tem um alarme próprio no pool padrão do Pico SDK. O callback
+ * aplica o nível do passo atual e devolve a duração do próximo; retornos
+ * negativos reagendam em relação ao instante previsto, de modo que os
+ * períodos não acumulam a latência da interrupção. Fila e estado são
+ * protegidos por um spin lock, pois os alarmes rodam em interrupção.
+ * ================================================================================
+ */
+
+#include "indicators.h"
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#if IND_BUZZER_PWM
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#endif
+
+// ================================================================================
+// ESTADO
+// ================================================================================
+
+static spin_lock_t *lock = NULL;
+
+static uint buzzer_gpio;
+static uint led_gpio[3];                       // Verde, azul, vermelho
+
+// Buzzer: fila circular de sequências e posição na sequência atual
+static const ind_pattern_t *queue[IND_QUEUE_LEN];
+static uint8_t q_head = 0, q_tail = 0;
+static const ind_pattern_t *current = NULL;
+static uint8_t step = 0;
+static bool tone_on = false;
+static alarm_id_t buzzer_alarm = 0;
+
+// LEDs: cor e temporização do pisca
+static uint8_t led_colors = 0;
+static uint16_t led_on_ms = 0, led_off_ms = 0;
+static bool led_lit = false;
+static alarm_id_t led_alarm = 0;
+
+// ================================================================================
+// SAÍDAS
+// ================================================================================
+
+static void buzzer_output(bool on) {
+#if IND_BUZZER_PWM
+    pwm_set_gpio_level(buzzer_gpio, on ? (1000000u / IND_BUZZER_FREQ_HZ) / 2 : 0);
+#else
+    gpio_put(buzzer_gpio, on);
+#endif
+}
+
+static void led_output(uint8_t colors) {
+    gpio_put(led_gpio[0], colors & IND_LED_GREEN);
+    gpio_put(led_gpio[1], colors & IND_LED_BLUE);
+    gpio_put(led_gpio[2], colors & IND_LED_RED);
+}
+
+// ================================================================================
+// BUZZER
+// ================================================================================
+
+/**
+ * Avança para a próxima fase (ligado/desligado), puxando a próxima sequência
+ * da fila ao fim da atual. Deve ser chamada com o spin lock adquirido
+ * @return Duração da fase em µs, ou 0 se não houver mais nada a tocar
+ */
+static uint32_t buzzer_advance(void) {
+    while (true) {
+        if (current && tone_on) {
+            // Fim do bipe: pausa do mesmo passo
+            tone_on = false;
+            buzzer_output(false);
+            uint16_t off = current->steps[step++].off_ms;
+            if (off)
+                return off * 1000u;
+        }
+        if (current && step < current->count) {
+            const ind_step_t *s = &current->steps[step];
+            if (s->on_ms) {
+                tone_on = true;
+                buzzer_output(true);
+                return s->on_ms * 1000u;
+            }
+            tone_on = true;                    // Passo só de pausa
+            continue;
+        }
+        // Sequência concluída: próxima da fila
+        if (q_head == q_tail) {
+            current = NULL;
+            return 0;
+        }
+        current = queue[q_tail];
+        q_tail = (q_tail + 1) % IND_QUEUE_LEN;
+        step = 0;
+    }
+}
+
+static int64_t buzzer_alarm_cb(alarm_id_t id, void *user_data) {
+    uint32_t irq = spin_lock_blocking(lock);
+    uint32_t us = buzzer_advance();
+    if (!us)
+        buzzer_alarm = 0;
+    spin_unlock(lock, irq);
+    return -(int64_t)us;                       // Relativo ao instante previsto
+}
+
+/**
+ * Enfileira uma sequência de bipes; retorna imediatamente
+ * @return false se a fila estiver cheia (sequência descartada)
+ */
+bool ind_buzzer_play(const ind_pattern_t *pattern) {
+    uint32_t irq = spin_lock_blocking(lock);
+    uint8_t next = (q_head + 1) % IND_QUEUE_LEN;
+    bool ok = next != q_tail;
+    if (ok) {
+        queue[q_head] = pattern;
+        q_head = next;
+        if (!buzzer_alarm) {
+            uint32_t us = buzzer_advance();
+            if (us)
+                buzzer_alarm = add_alarm_in_us(us, buzzer_alarm_cb, NULL, true);
+        }
+    }
+    spin_unlock(lock, irq);
+    return ok;
+}
+
+/**
+ * Indica se há bipes tocando ou na fila
+ */
+bool ind_buzzer_busy(void) {
+    return current != NULL || q_head != q_tail;
+}
+
+/**
+ * Interrompe a sequência atual e esvazia a fila
+ */
+void ind_buzzer_stop(void) {
+    uint32_t irq = spin_lock_blocking(lock);
+    if (buzzer_alarm) {
+        cancel_alarm(buzzer_alarm);
+        buzzer_alarm = 0;
+    }
+    q_head = q_tail = 0;
+    current = NULL;
+    tone_on = false;
+    buzzer_output(false);
+    spin_unlock(lock, irq);
+}
+
+// ================================================================================
+// LEDs
+// ================================================================================
+
+static int64_t led_alarm_cb(alarm_id_t id, void *user_data) {
+    uint32_t irq = spin_lock_blocking(lock);
+    led_lit = !led_lit;
+    led_output(led_lit ? led_colors : 0);
+    int64_t us = (led_lit ? led_on_ms : led_off_ms) * 1000;
+    spin_unlock(lock, irq);
+    return -us;
+}
+
+/**
+ * Define a cor do LED RGB
+ * @param colors Combinação de IND_LED_*
+ * @param on_ms  Tempo aceso do pisca (0 = cor fixa)
+ * @param off_ms Tempo apagado do pisca
+ */
+void ind_led_set(uint8_t colors, uint16_t on_ms, uint16_t off_ms) {
+    uint32_t irq = spin_lock_blocking(lock);
+    if (led_alarm) {
+        cancel_alarm(led_alarm);
+        led_alarm = 0;
+    }
+    led_colors = colors;
+    led_on_ms = on_ms;
+    led_off_ms = off_ms;
+    led_lit = true;
+    led_output(colors);
+    if (on_ms && off_ms && colors)
+        led_alarm = add_alarm_in_ms(on_ms, led_alarm_cb, NULL, true);
+    spin_unlock(lock, irq);
+}
+
+// ================================================================================
+// INICIALIZAÇÃO
+// ================================================================================
+
+/**
+ * Recalcula o divisor do PWM do buzzer para manter o contador em 1 MHz;
+ * chamar após cada mudança de clk_sys
+ */
+void ind_clock_changed(void) {
+#if IND_BUZZER_PWM
+    pwm_set_clkdiv(pwm_gpio_to_slice_num(buzzer_gpio), clock_get_hz(clk_sys) / 1000000.0f);
+#endif
+}
+
+/**
+ * Configura os pinos do buzzer e do LED RGB (apagados)
+ */
+void ind_init(uint buzzer_pin, uint green_pin, uint blue_pin, uint red_pin) {
+    if (!lock)
+        lock = spin_lock_init(spin_lock_claim_unused(true));
+
+    buzzer_gpio = buzzer_pin;
+#if IND_BUZZER_PWM
+    // Contador de 1 MHz; wrap define a frequência do tom
+    gpio_set_function(buzzer_pin, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(buzzer_pin);
+    ind_clock_changed();
+    pwm_set_wrap(slice, 1000000u / IND_BUZZER_FREQ_HZ - 1);
+    pwm_set_gpio_level(buzzer_pin, 0);
+    pwm_set_enabled(slice, true);
+#else
+    gpio_init(buzzer_pin);
+    gpio_set_dir(buzzer_pin, GPIO_OUT);
+    gpio_put(buzzer_pin, 0);
+#endif
+
+    led_gpio[0] = green_pin;
+    led_gpio[1] = blue_pin;
+    led_gpio[2] = red_pin;
+    for (int i = 0; i < 3; i++) {
+        gpio_init(led_gpio[i]);
+        gpio_set_dir(led_gpio[i], GPIO_OUT);
+        gpio_put(led_gpio[i], 0);
+    }
+}
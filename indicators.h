@@ -0,0 +1,63 @@
+/*
+ * ================================================================================
+ * SINALIZAÇÃO NÃO BLOQUEANTE - BUZZER E LEDs
+ * ================================================================================
+ *
+ * Descrição: Reproduz sequências de bipes e padrões de pisca dos LEDs a partir
+ *            de alarmes do timer do Pico, sem sleep_ms no laço principal.
+ *            As sequências do buzzer ficam numa fila e tocam uma após a outra;
+ *            o LED RGB mantém uma cor fixa ou pisca com períodos dados.
+ * ================================================================================
+ */
+
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+// Sequências do buzzer aguardando na fila (além da que está tocando)
+#ifndef IND_QUEUE_LEN
+#define IND_QUEUE_LEN 4
+#endif
+
+// Buzzer passivo: 1 gera tom por PWM na frequência abaixo; 0 apenas liga o pino
+#ifndef IND_BUZZER_PWM
+#define IND_BUZZER_PWM 0
+#endif
+#ifndef IND_BUZZER_FREQ_HZ
+#define IND_BUZZER_FREQ_HZ 2000
+#endif
+
+// Cores do LED RGB (combináveis)
+#define IND_LED_GREEN  0x01
+#define IND_LED_BLUE   0x02
+#define IND_LED_RED    0x04
+
+/**
+ * Um passo da sequência: buzzer ligado por on_ms, depois desligado por off_ms
+ */
+typedef struct {
+    uint16_t on_ms;
+    uint16_t off_ms;
+} ind_step_t;
+
+/**
+ * Sequência de bipes (normalmente constante, em flash)
+ */
+typedef struct {
+    const ind_step_t *steps;
+    uint8_t count;
+} ind_pattern_t;
+
+void ind_init(uint buzzer_pin, uint green_pin, uint blue_pin, uint red_pin);
+void ind_clock_changed(void);
+
+bool ind_buzzer_play(const ind_pattern_t *pattern);
+bool ind_buzzer_busy(void);
+void ind_buzzer_stop(void);
+
+void ind_led_set(uint8_t colors, uint16_t on_ms, uint16_t off_ms);
+
+#endif // INDICATORS_H
@@ -0,0 +1,189 @@
+/*
+ * ================================================================================
+ * REGISTROS EM SETORES COM DIÁRIO (RECUPERAÇÃO APÓS QUEDA DE ENERGIA)
+ * ================================================================================
+ *
+ * Os setores são gravados em ordem dentro da extensão pré-alocada, então os
+ * válidos formam um prefixo: a recuperação faz uma busca binária pela
+ * fronteira, lendo O(log n) setores em vez do arquivo inteiro. Setores
+ * antigos deixados na extensão por arquivos apagados têm outro
+ * identificador de captura ou outro número e não são aceitos.
+ * ================================================================================
+ */
+
+#include "journal.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc.h"
+#include "f_util.h"
+
+// CRC16 (o mesmo dos blocos do SD) de tudo menos o próprio campo
+static uint16_t sector_crc(const jrnl_sector_t *s) {
+    const char *p = (const char *)s;
+    unsigned short crc = 0;
+    update_crc16_slice4(&crc, p, offsetof(jrnl_sector_hdr_t, crc));
+    update_crc16_slice4(&crc, p + sizeof(jrnl_sector_hdr_t), JRNL_SECTOR_SIZE - sizeof(jrnl_sector_hdr_t));
+    return crc;
+}
+
+// Cabeçalho do setor em montagem, com o número j->seq
+static void begin_sector(jrnl_t *j) {
+    jrnl_sector_t *s = &j->sector[j->active];
+    memcpy(s->hdr.magic, JRNL_MAGIC, 4);
+    s->hdr.capture_id = j->capture_id;
+    s->hdr.seq = j->seq;
+    s->hdr.count = 0;
+}
+
+/**
+ * Sela o setor em montagem (zeros após o último registro e CRC) e passa a
+ * montar no outro, de modo que o selado fique intacto até a gravação
+ */
+static const jrnl_sector_t *seal_sector(jrnl_t *j) {
+    jrnl_sector_t *s = &j->sector[j->active];
+    memset(&s->rec[s->hdr.count], 0, (JRNL_RECORDS - s->hdr.count) * sizeof(mpu_log_record_t));
+    s->hdr.crc = sector_crc(s);
+    j->seq++;
+    j->active ^= 1;
+    begin_sector(j);
+    return s;
+}
+
+/**
+ * Prepara o diário de uma nova captura
+ * @param capture_id Identificador sorteado, gravado em todos os setores
+ */
+void jrnl_init(jrnl_t *j, uint32_t capture_id) {
+    jrnl_resume(j, capture_id, 0);
+}
+
+/**
+ * Continua o diário de uma captura interrompida a partir do setor seq
+ */
+void jrnl_resume(jrnl_t *j, uint32_t capture_id, uint32_t seq) {
+    j->capture_id = capture_id;
+    j->seq = seq;
+    j->active = 0;
+    begin_sector(j);
+}
+
+/**
+ * Acrescenta n registros ao setor em montagem; registros de uma mesma
+ * amostra (dois sensores) nunca são separados entre setores
+ * @return Setor completo a gravar (válido até o próximo push) ou NULL
+ */
+const jrnl_sector_t *jrnl_push(jrnl_t *j, const mpu_log_record_t *recs, uint32_t n) {
+    const jrnl_sector_t *done = NULL;
+    if (jrnl_count(j) + n > JRNL_RECORDS)
+        done = seal_sector(j);
+    jrnl_sector_t *s = &j->sector[j->active];
+    memcpy(&s->rec[s->hdr.count], recs, n * sizeof *recs);
+    s->hdr.count += n;
+    return done;
+}
+
+/**
+ * Fecha o setor parcial ao fim da captura
+ * @return Setor a gravar ou NULL se estiver vazio
+ */
+const jrnl_sector_t *jrnl_finish(jrnl_t *j) {
+    if (!jrnl_count(j))
+        return NULL;
+    return seal_sector(j);
+}
+
+/**
+ * Confere assinatura, captura, número e CRC de um setor lido do arquivo
+ */
+bool jrnl_sector_valid(const jrnl_sector_t *s, uint32_t capture_id, uint32_t seq) {
+    return !memcmp(s->hdr.magic, JRNL_MAGIC, 4) && s->hdr.capture_id == capture_id &&
+           s->hdr.seq == seq && s->hdr.count <= JRNL_RECORDS && s->hdr.crc == sector_crc(s);
+}
+
+// Lê o setor `index` do diário (o cabeçalho do arquivo ocupa o setor 0)
+static bool read_sector(FIL *fil, uint32_t index, jrnl_sector_t *s) {
+    UINT br;
+    return f_lseek(fil, (FSIZE_t)(index + 1) * JRNL_SECTOR_SIZE) == FR_OK &&
+           f_read(fil, s, sizeof *s, &br) == FR_OK && br == sizeof *s;
+}
+
+/**
+ * Ajusta o tamanho de um arquivo com diário ao último setor válido
+ * Arquivos fechados normalmente já terminam nele e não são alterados
+ */
+FRESULT jrnl_recover(const char *path) {
+    static FIL fil;
+    static jrnl_sector_t s;
+    FRESULT fr = f_open(&fil, path, FA_READ | FA_WRITE);
+    if (fr != FR_OK)
+        return fr;
+
+    mpu_log_header_t h;
+    UINT br;
+    fr = f_read(&fil, &h, sizeof h, &br);
+    if (fr != FR_OK || br != sizeof h || memcmp(h.magic, MPU_LOG_MAGIC, 4) ||
+        !(h.flags & MPU_LOG_FLAG_JOURNAL)) {
+        f_close(&fil);
+        return fr;                              // Não usa diário
+    }
+
+    // O primeiro setor define a captura e o número inicial (extrações
+    // começam no meio); setores [0, lo] válidos, a partir de hi não
+    uint32_t total = (uint32_t)(f_size(&fil) / JRNL_SECTOR_SIZE) - 1;
+    uint32_t valid = 0;
+    if (total && read_sector(&fil, 0, &s) && jrnl_sector_valid(&s, s.hdr.capture_id, s.hdr.seq)) {
+        uint32_t id = s.hdr.capture_id, seq0 = s.hdr.seq;
+        uint32_t lo = 0, hi = total;
+        while (hi - lo > 1) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (read_sector(&fil, mid, &s) && jrnl_sector_valid(&s, id, seq0 + mid))
+                lo = mid;
+            else
+                hi = mid;
+        }
+        valid = lo + 1;
+    }
+
+    FSIZE_t size = (FSIZE_t)(valid + 1) * JRNL_SECTOR_SIZE;
+    if (size < f_size(&fil)) {
+        fr = f_lseek(&fil, size);
+        if (fr == FR_OK)
+            fr = f_truncate(&fil);
+        if (fr == FR_OK)
+            printf("[AVISO] %s: captura interrompida recuperada com %lu setores (%lu KiB)\n",
+                   path, (unsigned long)valid, (unsigned long)(size / 1024));
+    }
+    FRESULT rc = f_close(&fil);
+    return fr != FR_OK ? fr : rc;
+}
+
+/**
+ * Recupera os arquivos .bin da raiz do cartão deixados abertos por uma
+ * queda de energia; chamado ao montar o cartão
+ */
+FRESULT jrnl_recover_dir(const char *drive) {
+    DIR dir;
+    FILINFO fno;
+    FRESULT fr = f_opendir(&dir, drive);
+    while (fr == FR_OK) {
+        fr = f_readdir(&dir, &fno);
+        if (fr != FR_OK || !fno.fname[0])
+            break;
+        const char *ponto = strrchr(fno.fname, '.');
+        // Só arquivos que terminam em fronteira de setor e têm ao menos um
+        // setor de registros podem estar pendentes
+        if ((fno.fattrib & AM_DIR) || !ponto || (strcmp(ponto, ".bin") && strcmp(ponto, ".BIN")) ||
+            fno.fsize < 2 * JRNL_SECTOR_SIZE || fno.fsize % JRNL_SECTOR_SIZE)
+            continue;
+        char path[FF_LFN_BUF + 4];
+        snprintf(path, sizeof path, "%s%s", drive, fno.fname);
+        FRESULT rc = jrnl_recover(path);
+        if (rc != FR_OK)
+            printf("[AVISO] Não foi possível verificar %s (%s)\n", path, FRESULT_str(rc));
+    }
+    f_closedir(&dir);
+    return fr;
+}
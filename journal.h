@@ -0,0 +1,70 @@
+/*
+ * ================================================================================
+ * REGISTROS EM SETORES COM DIÁRIO (RECUPERAÇÃO APÓS QUEDA DE ENERGIA)
+ * ================================================================================
+ *
+ * Descrição: Agrupa os registros de 16 bytes (mpu_log.h) em setores de 512
+ *            bytes autoverificáveis: cabeçalho de 16 bytes com identificador
+ *            da captura, número do setor e CRC16, seguido de até 31
+ *            registros. O cabeçalho do arquivo ocupa sozinho o primeiro
+ *            setor. Com o arquivo pré-alocado e sincronizado na abertura, a
+ *            captura dispensa f_sync periódico: após uma queda de energia,
+ *            jrnl_recover localiza o último setor válido e ajusta o tamanho.
+ * ================================================================================
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+#include "mpu_log.h"
+
+#define JRNL_MAGIC        "MPUJ"
+#define JRNL_SECTOR_SIZE  512
+
+/**
+ * Cabeçalho de cada setor (16 bytes, little-endian)
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "MPUJ"
+    uint32_t capture_id;        // Sorteado na abertura: rejeita setores de capturas anteriores
+    uint32_t seq;               // Número do setor na captura (0 = primeiro após o cabeçalho)
+    uint16_t count;             // Registros válidos no setor
+    uint16_t crc;               // CRC16 dos outros 510 bytes do setor
+} jrnl_sector_hdr_t;
+
+#define JRNL_RECORDS ((JRNL_SECTOR_SIZE - sizeof(jrnl_sector_hdr_t)) / sizeof(mpu_log_record_t))
+
+typedef struct __attribute__((packed)) {
+    jrnl_sector_hdr_t hdr;
+    mpu_log_record_t rec[JRNL_RECORDS];
+} jrnl_sector_t;
+
+_Static_assert(sizeof(jrnl_sector_hdr_t) == 16, "cabeçalho do setor deve ter 16 bytes");
+_Static_assert(sizeof(jrnl_sector_t) == JRNL_SECTOR_SIZE, "setor do diário deve ter 512 bytes");
+
+typedef struct {
+    jrnl_sector_t sector[2] __attribute__((aligned(4)));    // Em montagem e entregue
+    uint8_t active;                                         // Setor em montagem
+    uint32_t capture_id;
+    uint32_t seq;                                           // Número do setor em montagem
+} jrnl_t;
+
+void jrnl_init(jrnl_t *j, uint32_t capture_id);
+void jrnl_resume(jrnl_t *j, uint32_t capture_id, uint32_t seq);
+const jrnl_sector_t *jrnl_push(jrnl_t *j, const mpu_log_record_t *recs, uint32_t n);
+const jrnl_sector_t *jrnl_finish(jrnl_t *j);
+bool jrnl_sector_valid(const jrnl_sector_t *s, uint32_t capture_id, uint32_t seq);
+
+// Registros no setor em montagem
+static inline uint32_t jrnl_count(const jrnl_t *j) {
+    return j->sector[j->active].hdr.count;
+}
+
+FRESULT jrnl_recover(const char *path);
+FRESULT jrnl_recover_dir(const char *drive);
+
+#endif // JOURNAL_H
@@ -39,7 +39,11 @@ void ff_memfree (
 /* Definitions of Mutex                                                   */
 /*------------------------------------------------------------------------*/
 
-#define OS_TYPE	0	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS */
+#if PICO_ON_DEVICE
+#define OS_TYPE	5	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS, 5:Pico SDK, 6:None */
+#else
+#define OS_TYPE	6	/* Host build: single thread, locking is only checked for balance */
+#endif
 
 
 #if   OS_TYPE == 0	/* Win32 */
@@ -64,6 +68,16 @@ static SemaphoreHandle_t Mutex[FF_VOLUMES + 1];	/* Table of mutex handle */
 #include "cmsis_os.h"
 static osMutexId Mutex[FF_VOLUMES + 1];	/* Table of mutex ID */
 
+#elif OS_TYPE == 5	/* Pico SDK (both cores, no RTOS) */
+#include "pico/mutex.h"
+#include "hw_config.h"
+#include "sd_card.h"
+static mutex_t Mutex[FF_VOLUMES + 1];	/* Table of mutex, owned by core */
+
+#elif OS_TYPE == 6	/* None */
+#include <assert.h>
+static int Mutex[FF_VOLUMES + 1];		/* Table of lock depth */
+
 #endif
 
 
@@ -106,6 +120,14 @@ int ff_mutex_create (	/* Returns 1:Function succeeded or 0:Could not create the
 	Mutex[vol] = osMutexCreate(osMutex(cmsis_os_mutex));
 	return (int)(Mutex[vol] != NULL);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	if (!mutex_is_initialized(&Mutex[vol])) mutex_init(&Mutex[vol]);
+	return 1;
+
+#elif OS_TYPE == 6	/* None */
+	Mutex[vol] = 0;
+	return 1;
+
 #endif
 }
 
@@ -138,6 +160,12 @@ void ff_mutex_delete (	/* Returns 1:Function succeeded or 0:Could not delete due
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexDelete(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK: static mutex, kept for the next f_mount */
+	(void)vol;
+
+#elif OS_TYPE == 6	/* None */
+	assert(Mutex[vol] == 0);
+
 #endif
 }
 
@@ -171,6 +199,21 @@ int ff_mutex_take (	/* Returns 1:Succeeded or 0:Timeout */
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	return (int)(osMutexWait(Mutex[vol], FF_FS_TIMEOUT) == osOK);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	/* Lock order is volume -> card (sd_lock) -> SPI (spi_lock). An async
+	/  write holds the card and the SPI until its core completes it, so the
+	/  core must complete it before waiting here: the other core may hold this
+	/  volume and be waiting for the card (FF_FS_TIMEOUT is in ms). */
+	if (vol < FF_VOLUMES && (size_t)vol < sd_get_num()) {
+		sd_write_async_complete(sd_get_by_num((size_t)vol));
+	}
+	return (int)mutex_enter_timeout_ms(&Mutex[vol], FF_FS_TIMEOUT);
+
+#elif OS_TYPE == 6	/* None */
+	assert(Mutex[vol] == 0);	/* FatFs never takes a mutex it holds */
+	Mutex[vol]++;
+	return 1;
+
 #endif
 }
 
@@ -201,6 +244,13 @@ void ff_mutex_give (
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexRelease(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	mutex_exit(&Mutex[vol]);
+
+#elif OS_TYPE == 6	/* None */
+	assert(Mutex[vol] == 1);
+	Mutex[vol]--;
+
 #endif
 }
 
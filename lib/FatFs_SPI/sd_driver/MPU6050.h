@@ -1,20 +1,79 @@
 #ifndef MPU6050_H
 #define MPU6050_H
 
+#include <stdbool.h>
 #include <stdint.h>     // Para os tipos int16_t
 
-// Endereo padro do MPU6050
-#define MPU6050_ADDR 0x68
+#include "hardware/i2c.h"
+
+// Endereos do MPU6050: pino AD0 em nvel baixo (padro) ou alto
+#define MPU6050_ADDR     0x68
+#define MPU6050_ADDR_ALT 0x69
 
 // Porta e pinos I2C utilizados para o MPU6050
 #define I2C_PORT      i2c0
 #define I2C_SDA       0
 #define I2C_SCL       1
 
-// Funo para inicializar e resetar o MPU6050
-void mpu6050_reset(void);
+// Faixas de medida (campos AFS_SEL e FS_SEL): cada passo dobra a faixa e
+// divide a escala por 2
+#define MPU6050_ACCEL_2G      0
+#define MPU6050_ACCEL_4G      1
+#define MPU6050_ACCEL_8G      2
+#define MPU6050_ACCEL_16G     3
+#define MPU6050_GYRO_250DPS   0
+#define MPU6050_GYRO_500DPS   1
+#define MPU6050_GYRO_1000DPS  2
+#define MPU6050_GYRO_2000DPS  3
+
+/**
+ * Um sensor no barramento: porta, endereo e faixas de medida
+ * Vrios sensores podem compartilhar a mesma porta com endereos diferentes
+ */
+typedef struct {
+    i2c_inst_t *port;           // Controlador I2C do barramento
+    uint8_t addr;               // MPU6050_ADDR ou MPU6050_ADDR_ALT
+    uint8_t accel_range;        // MPU6050_ACCEL_*
+    uint8_t gyro_range;         // MPU6050_GYRO_*
+    uint8_t dlpf;               // Filtro passa-baixa DLPF_CFG (0 = 260 Hz ... 6 = 5 Hz)
+    float accel_lsb_per_g;      // Escalas da faixa (preenchidas em mpu6050_reset)
+    float gyro_lsb_per_dps;
+} mpu6050_t;
+
+// Sensor com as faixas padro (2 g, 250 /s) e sem filtro
+#define MPU6050_DEVICE(p, a) { .port = (p), .addr = (a) }
+
+// Funo para inicializar e resetar o MPU6050 e aplicar as faixas de medida
+void mpu6050_reset(mpu6050_t *dev);
+
+// Verifica se h um MPU6050 respondendo no endereo (registrador WHO_AM_I)
+bool mpu6050_probe(const mpu6050_t *dev);
 
 // Funo para ler os dados brutos do acelermetro, giroscpio e temperatura
-void mpu6050_read_raw(int16_t accel[3], int16_t gyro[3], int16_t *temp);
+// (leitura em rajada de 14 bytes a partir de 0x3B)
+void mpu6050_read_raw(const mpu6050_t *dev, int16_t accel[3], int16_t gyro[3], int16_t *temp);
+
+// Leitura em rajada no bloqueante via DMA: start dispara a transferncia,
+// finish aguarda (se preciso) e decodifica os dados. Os canais DMA so
+// compartilhados: h no mximo uma rajada pendente, de um nico sensor
+void mpu6050_dma_init(void);
+bool mpu6050_read_raw_dma_start(const mpu6050_t *dev);
+bool mpu6050_read_raw_dma_busy(void);
+bool mpu6050_read_raw_dma_finish(int16_t accel[3], int16_t gyro[3], int16_t *temp);
+
+// Modo FIFO: o sensor amostra na taxa do divisor interno, acumula os
+// registros na FIFO de 1024 bytes e sinaliza cada dado pronto no pino INT
+#define MPU6050_FIFO_SIZE        1024
+#define MPU6050_FIFO_SAMPLE_SIZE 14    // Acelerao, temperatura e giroscpio
+#define MPU6050_INT_FIFO_OFLOW   0x10  // INT_STATUS: FIFO transbordou
+#define MPU6050_INT_DATA_RDY     0x01  // INT_STATUS: nova amostra disponvel
+
+uint32_t mpu6050_set_sample_rate(const mpu6050_t *dev, uint32_t rate_hz);
+void mpu6050_fifo_enable(const mpu6050_t *dev, bool enable);
+void mpu6050_fifo_reset(const mpu6050_t *dev);
+uint8_t mpu6050_int_status(const mpu6050_t *dev);
+uint16_t mpu6050_fifo_count(const mpu6050_t *dev);
+int mpu6050_fifo_read(const mpu6050_t *dev, uint8_t *buffer, int max_samples);
+void mpu6050_fifo_decode(const uint8_t *record, int16_t accel[3], int16_t gyro[3], int16_t *temp);
 
 #endif // MPU6050_H
@@ -36,6 +36,8 @@ specific language governing permissions and limitations under the License.
 char crc7(const char* data, int length);
 unsigned short crc16(const char* data, int length);
 void update_crc16(unsigned short *pCrc16, const char data[], size_t length);
+unsigned short crc16_slice4(const char* data, int length);
+void update_crc16_slice4(unsigned short *pCrc16, const char data[], size_t length);
 
 #endif
 
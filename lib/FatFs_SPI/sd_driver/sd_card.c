@@ -163,7 +163,9 @@ specific language governing permissions and limitations under the License.
 #include <inttypes.h>
 #include <string.h>
 //
+#include "hardware/timer.h"
 #include "pico/mutex.h"
+#include "pico/platform.h"
 //
 #include "hw_config.h"  // Hardware Configuration of the SPI and SD Card "objects"
 #include "my_debug.h"
@@ -346,8 +348,12 @@ static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
     return response;
 }
 
+__attribute__((weak)) void sd_card_wait_hook(uint32_t wait_us) { (void)wait_us; }
+__attribute__((weak)) void sd_card_event_hook(sd_event_t event) { (void)event; }
+
 static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
     char resp;
+    uint32_t t_wait = time_us_32();
 
     // Keep sending dummy clocks with DI held high until the card releases the
     // DO line
@@ -358,6 +364,7 @@ static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
              0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
 
     if (resp == 0x00) DBG_PRINTF("%s failed\r\n", __FUNCTION__);
+    sd_card_wait_hook(time_us_32() - t_wait);
 
     // Return success/failure
     return (resp > 0x00);
@@ -383,6 +390,13 @@ static void sd_release(sd_card_t *pSD) {
     sd_spi_release(pSD);
 }
 
+// Any other card access must first terminate an open streaming write
+static int in_sd_write_session_end(sd_card_t *pSD);
+static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
+                              uint64_t ulSectorNumber, uint32_t blockCnt);
+// ... and complete an asynchronous write started by this core
+// (sd_write_async_complete, declared in sd_card.h)
+
 #if 0
 static const char *cmd2str(const cmdSupported cmd) {
     switch (cmd) {
@@ -753,7 +767,9 @@ static uint64_t sd_sectors_nolock(sd_card_t *pSD) {
     return blocks;
 }
 uint64_t sd_sectors(sd_card_t *pSD) {
+    sd_write_async_complete(pSD);
     sd_acquire(pSD);
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
     uint64_t sectors = sd_sectors_nolock(pSD);
     sd_release(pSD);
     return sectors;
@@ -817,9 +833,17 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
         DBG_PRINTF("%s:%d Read timeout\r\n", __FILE__, __LINE__);
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
-    // read data
+    // read data, computing its CRC16 on the fly when checking is on
     // bool spi_transfer(const uint8_t *tx, uint8_t *rx, size_t length)
-    if (!sd_spi_transfer(pSD, NULL, buffer, length)) {
+    uint16_t crc_result = 0;
+    bool ok;
+#if SD_CRC_ENABLED
+    if (crc_on)
+        ok = sd_spi_transfer_crc16(pSD, NULL, buffer, length, &crc_result);
+    else
+#endif
+        ok = sd_spi_transfer(pSD, NULL, buffer, length);
+    if (!ok) {
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
     // Read the CRC16 checksum for the data block
@@ -828,9 +852,7 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
 
 #if SD_CRC_ENABLED
     if (crc_on) {
-        uint32_t crc_result;
-        // Compute and verify checksum
-        crc_result = crc16((void *)buffer, length);
+        // Verify checksum
         if ((uint16_t)crc_result != crc) {
             DBG_PRINTF("%s: Invalid CRC received 0x%" PRIx16
                        " result of computation 0x%" PRIx16 "\r\n",
@@ -847,6 +869,8 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
                              uint64_t ulSectorNumber, uint32_t ulSectorCount) {
     uint32_t blockCnt = ulSectorCount;
 
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
+
     if (ulSectorNumber + blockCnt > pSD->sectors)
         return SD_BLOCK_DEVICE_ERROR_PARAMETER;
     if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
@@ -874,8 +898,8 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
     // receive the data : one block at a time
     int rd_status = 0;
     while (blockCnt) {
-        if (0 != sd_read_block(pSD, buffer, _block_size)) {
-            rd_status = SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+        rd_status = sd_read_block(pSD, buffer, _block_size);
+        if (0 != rd_status) {
             break;
         }
         buffer += _block_size;
@@ -888,12 +912,169 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
     return rd_status ? rd_status : status;
 }
 
+/* SPI clock negotiation
+ *
+ * sd_init identifies the card at 400 kHz, then tries the data clock steps
+ * below (up to spi_t.baud_rate) and keeps the fastest one that reads the
+ * last sectors twice, with matching data and (when enabled) good CRC16s. The
+ * test never writes to the card. During operation, if CRC
+ * errors reach SD_CRC_FALLBACK_ERRORS within SD_CRC_FALLBACK_WINDOW blocks,
+ * the clock drops to the next step.
+ */
+#ifndef SD_CRC_FALLBACK_ERRORS
+#define SD_CRC_FALLBACK_ERRORS 3
+#endif
+#define SD_CRC_FALLBACK_WINDOW 1024
+#define SD_BAUD_RATE_SAFE (1000 * 1000) /*!< Used when no step passes the test */
+
+// Requested rates; with clk_peri = 125 MHz, 25 MHz comes out as 20.8 MHz
+static const uint sd_baud_steps[] = {25 * 1000 * 1000, 20833333, 12500000};
+
+// Blocks per test read: more than one, so CMD18 and CMD12 are exercised too
+#define SD_BAUD_TEST_BLOCKS 2
+
+static bool sd_test_baud_rate(sd_card_t *pSD) {
+    static uint8_t buf[2][SD_BAUD_TEST_BLOCKS * BLOCK_SIZE_HC];
+    uint64_t lba = pSD->sectors - SD_BAUD_TEST_BLOCKS;
+
+    // With CRC on, a garbled block fails its CRC16 and a garbled command
+    // its CRC7; the second read catches what slips through with CRC off
+    for (size_t i = 0; i < count_of(buf); ++i)
+        if (in_sd_read_blocks(pSD, buf[i], lba, SD_BAUD_TEST_BLOCKS)) return false;
+    return 0 == memcmp(buf[0], buf[1], sizeof buf[0]);
+}
+
+static void sd_negotiate_baud_rate(sd_card_t *pSD) {
+    uint ceiling = pSD->spi->baud_rate;
+    uint failed = 0;
+
+    for (size_t i = 0; i < count_of(sd_baud_steps); ++i) {
+        if (sd_baud_steps[i] > ceiling) continue;
+        uint actual = sd_spi_set_frequency(pSD, sd_baud_steps[i]);
+        if (actual == failed) continue;  // Same divider as a failed step
+        if (sd_test_baud_rate(pSD)) {
+            pSD->spi->negotiated_baud_rate = actual;
+            DBG_PRINTF("SD clock negotiated: %u Hz\r\n", actual);
+            return;
+        }
+        failed = actual;
+    }
+    uint rate = ceiling < SD_BAUD_RATE_SAFE ? ceiling : SD_BAUD_RATE_SAFE;
+    if (ceiling < sd_baud_steps[count_of(sd_baud_steps) - 1]) rate = ceiling;
+    pSD->spi->negotiated_baud_rate = sd_spi_set_frequency(pSD, rate);
+    DBG_PRINTF("SD clock: %u Hz (untested)\r\n", pSD->spi->negotiated_baud_rate);
+}
+
+// Account for a transfer; drop to a slower clock when CRC errors climb
+static void sd_check_crc_rate(sd_card_t *pSD, int status, uint32_t blocks) {
+    pSD->crc_window += blocks;
+    if (SD_BLOCK_DEVICE_ERROR_CRC == status) {
+        ++pSD->crc_errors;
+        sd_card_event_hook(SD_EVENT_CRC_ERROR);
+    }
+
+    if (pSD->crc_errors >= SD_CRC_FALLBACK_ERRORS) {
+        uint current = pSD->spi->negotiated_baud_rate;
+        uint rate = SD_BAUD_RATE_SAFE;
+        for (size_t i = 0; i < count_of(sd_baud_steps); ++i) {
+            if (sd_baud_steps[i] < current) {
+                rate = sd_baud_steps[i];
+                break;
+            }
+        }
+        if (rate < current) {
+            pSD->spi->negotiated_baud_rate = sd_spi_set_frequency(pSD, rate);
+            DBG_PRINTF("SD CRC errors: clock lowered to %u Hz\r\n",
+                       pSD->spi->negotiated_baud_rate);
+        }
+        pSD->crc_errors = 0;
+        pSD->crc_window = 0;
+    } else if (pSD->crc_window >= SD_CRC_FALLBACK_WINDOW) {
+        pSD->crc_errors = 0;
+        pSD->crc_window = 0;
+    }
+}
+
+// SD status (ACMD13): 512-bit block sent MSB first. AU_SIZE is [431:428],
+// ERASE_SIZE [423:408], ERASE_TIMEOUT [407:402] and ERASE_OFFSET [401:400]
+static void sd_read_sd_status_nolock(sd_card_t *pSD) {
+    static const uint8_t au_mib[] = {8, 12, 16, 24, 32, 64};  // AU_SIZE 0xA..0xF
+    uint8_t st[64];
+    pSD->au_sectors = 0;
+    pSD->erase_size = 0;
+    pSD->erase_timeout_s = 0;
+    pSD->erase_offset_s = 0;
+    if (sd_cmd(pSD, ACMD13_SD_STATUS, 0x0, true, 0) != 0 ||
+        sd_read_bytes(pSD, st, sizeof st) != 0) {
+        DBG_PRINTF("Couldn't read SD status\r\n");
+        return;
+    }
+    uint32_t au = st[10] >> 4;
+    if (au >= 0xA)
+        pSD->au_sectors = au_mib[au - 0xA] * (1024U * 1024U / _block_size);
+    else if (au)
+        pSD->au_sectors = (16U * 1024U / _block_size) << (au - 1);
+    pSD->erase_size = (uint16_t)(st[11] << 8 | st[12]);
+    pSD->erase_timeout_s = st[13] >> 2;
+    pSD->erase_offset_s = st[13] & 0x3;
+    DBG_PRINTF("AU: %" PRIu32 " sectors, erase: %u AU in %u+%u s\r\n",
+               pSD->au_sectors, pSD->erase_size, pSD->erase_timeout_s,
+               pSD->erase_offset_s);
+}
+
+/* Erase in runs of ERASE_SIZE AUs (one AU if not reported), so that each
+ * CMD38 completes within ERASE_TIMEOUT + ERASE_OFFSET */
+int sd_erase_blocks(sd_card_t *pSD, uint64_t first, uint64_t last) {
+    if (last < first || last >= pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    uint32_t au = pSD->au_sectors ? pSD->au_sectors : 8192;
+    uint64_t run = (uint64_t)au * (pSD->erase_size ? pSD->erase_size : 1);
+    int timeout_ms = SD_COMMAND_TIMEOUT +
+                     1000 * (pSD->erase_timeout_s + pSD->erase_offset_s);
+    int status = SD_BLOCK_DEVICE_ERROR_NONE;
+
+    sd_write_async_complete(pSD);
+    sd_acquire(pSD);
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
+    while (status == SD_BLOCK_DEVICE_ERROR_NONE && first <= last) {
+        // Runs end on an AU boundary, except for the last one
+        uint64_t end = (first / au * au) + run - 1;
+        if (end > last) end = last;
+        uint64_t a = first, b = end;
+        // SDSC Card (CCS=0) uses byte unit address
+        if (SDCARD_V2HC != pSD->card_type) {
+            a *= _block_size;
+            b *= _block_size;
+        }
+        status = sd_cmd(pSD, CMD32_ERASE_WR_BLK_START_ADDR, (uint32_t)a, false, 0);
+        if (status == SD_BLOCK_DEVICE_ERROR_NONE)
+            status = sd_cmd(pSD, CMD33_ERASE_WR_BLK_END_ADDR, (uint32_t)b, false, 0);
+        if (status == SD_BLOCK_DEVICE_ERROR_NONE)
+            status = sd_cmd(pSD, CMD38_ERASE, 0x0, false, 0);
+        if (status == SD_BLOCK_DEVICE_ERROR_NONE && !sd_wait_ready(pSD, timeout_ms))
+            status = SD_BLOCK_DEVICE_ERROR_ERASE;
+        first = end + 1;
+    }
+    sd_release(pSD);
+    return status;
+}
+
+uint sd_get_baud_rate(sd_card_t *pSD) {
+    return pSD->spi->negotiated_baud_rate;
+}
+
 int sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
                    uint32_t ulSectorCount) {
+    sd_write_async_complete(pSD);
     sd_acquire(pSD);
     TRACE_PRINTF("sd_read_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, ulSectorCount);
     int status = in_sd_read_blocks(pSD, buffer, ulSectorNumber, ulSectorCount);
+    sd_check_crc_rate(pSD, status, ulSectorCount);
+    if (SD_BLOCK_DEVICE_ERROR_CRC == status) {  // Retry once
+        sd_card_event_hook(SD_EVENT_RETRY);
+        status = in_sd_read_blocks(pSD, buffer, ulSectorNumber, ulSectorCount);
+    }
     sd_release(pSD);
     return status;
 }
@@ -906,16 +1087,15 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
     // indicate start of block
     sd_spi_write(pSD, token);
 
-    // write the data
-    bool ret = sd_spi_transfer(pSD, buffer, NULL, length);
-    myASSERT(ret);
-
+    // write the data, computing its CRC16 as it streams out
+    bool ret;
 #if SD_CRC_ENABLED
-    if (crc_on) {
-        // Compute CRC
-        crc = crc16((void *)buffer, length);
-    }
+    if (crc_on)
+        ret = sd_spi_transfer_crc16(pSD, buffer, NULL, length, &crc);
+    else
 #endif
+        ret = sd_spi_transfer(pSD, buffer, NULL, length);
+    myASSERT(ret);
 
     // write the checksum CRC16
     sd_spi_write(pSD, crc >> 8);
@@ -948,6 +1128,8 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
  */
 static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
                               uint64_t ulSectorNumber, uint32_t blockCnt) {
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
+
     if (ulSectorNumber + blockCnt > pSD->sectors)
         return SD_BLOCK_DEVICE_ERROR_PARAMETER;
     if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
@@ -977,7 +1159,8 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
         // Only CRC and general write error are communicated via response token
         if (response != SPI_DATA_ACCEPTED) {
             DBG_PRINTF("Single Block Write failed: 0x%x \r\n", response);
-            status = SD_BLOCK_DEVICE_ERROR_WRITE;
+            status = (response == SPI_DATA_CRC_ERROR) ? SD_BLOCK_DEVICE_ERROR_CRC
+                                                      : SD_BLOCK_DEVICE_ERROR_WRITE;
         }
     } else {
         // Pre-erase setting prior to multiple block write operation
@@ -996,7 +1179,8 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
             response = sd_write_block(pSD, buffer, SPI_START_BLK_MUL_WRITE, _block_size);
             if (response != SPI_DATA_ACCEPTED) {
                 DBG_PRINTF("Multiple Block Write failed: 0x%x\r\n", response);
-                status = SD_BLOCK_DEVICE_ERROR_WRITE;
+                status = (response == SPI_DATA_CRC_ERROR) ? SD_BLOCK_DEVICE_ERROR_CRC
+                                                          : SD_BLOCK_DEVICE_ERROR_WRITE;
                 break;
             }
             buffer += _block_size;
@@ -1010,20 +1194,288 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     uint32_t stat = 0;
     // Some SD cards want to be deselected between every bus transaction:
     sd_spi_deselect_pulse(pSD);
-    status = sd_cmd(pSD, CMD13_SEND_STATUS, 0, false, &stat);
-    return status;
+    int st13 = sd_cmd(pSD, CMD13_SEND_STATUS, 0, false, &stat);
+    return status ? status : st13;
 }
 
 int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
                     uint64_t ulSectorNumber, uint32_t blockCnt) {
+    sd_write_async_complete(pSD);
     sd_acquire(pSD);
     TRACE_PRINTF("sd_write_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, blockCnt);
     int status = in_sd_write_blocks(pSD, buffer, ulSectorNumber, blockCnt);
+    sd_check_crc_rate(pSD, status, blockCnt);
+    if (SD_BLOCK_DEVICE_ERROR_CRC == status) {  // Retry once
+        sd_card_event_hook(SD_EVENT_RETRY);
+        status = in_sd_write_blocks(pSD, buffer, ulSectorNumber, blockCnt);
+    }
+    sd_release(pSD);
+    return status;
+}
+
+/* Streaming write session
+ *
+ * A session keeps one open-ended CMD25 multiple block write alive across
+ * calls, so that a long run of consecutive sectors costs a single command and
+ * a single stop token instead of ACMD23 + CMD25 + STOP_TRAN + CMD13 per call.
+ * The card and the SPI are released between calls; the card tolerates CS
+ * being deasserted between data blocks. Any other access to the card (read,
+ * regular write, status) ends the session first.
+ */
+
+/** Start a streaming multiple block write
+ *
+ *  @param ulSectorNumber     LBA of the first block of the session
+ *  @param preEraseCnt  Number of blocks expected (ACMD23 pre-erase hint),
+ *                      0 if unknown
+ *  @return         SD_BLOCK_DEVICE_ERROR_NONE(0) - success, or an error
+ *                  from sd_cmd
+ */
+static int in_sd_write_session_begin(sd_card_t *pSD, uint64_t ulSectorNumber,
+                                     uint32_t preEraseCnt) {
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
+
+    if (ulSectorNumber >= pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+
+    uint64_t addr;
+    if (SDCARD_V2HC == pSD->card_type) {
+        addr = ulSectorNumber;
+    } else {
+        addr = ulSectorNumber * _block_size;
+    }
+    if (preEraseCnt) {
+        // Pre-erase setting prior to multiple block write operation
+        sd_cmd(pSD, ACMD23_SET_WR_BLK_ERASE_COUNT, preEraseCnt, 1, 0);
+        // Some SD cards want to be deselected between every bus transaction:
+        sd_spi_deselect_pulse(pSD);
+    }
+    int status = sd_cmd(pSD, CMD25_WRITE_MULTIPLE_BLOCK, addr, false, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE != status) return status;
+
+    pSD->wr_session_open = true;
+    pSD->wr_session_next = ulSectorNumber;
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static int in_sd_write_session_end(sd_card_t *pSD) {
+    if (!pSD->wr_session_open) return SD_BLOCK_DEVICE_ERROR_NONE;
+    pSD->wr_session_open = false;
+
+    sd_spi_write(pSD, SPI_STOP_TRAN);
+    // Skip one byte, then wait for the card to finish programming
+    sd_spi_write(pSD, SPI_FILL_CHAR);
+    if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
+        DBG_PRINTF("%s:%d: Card not ready yet\r\n", __FILE__, __LINE__);
+    }
+    uint32_t stat = 0;
+    sd_spi_deselect_pulse(pSD);
+    return sd_cmd(pSD, CMD13_SEND_STATUS, 0, false, &stat);
+}
+
+int sd_write_session_begin(sd_card_t *pSD, uint64_t ulSectorNumber,
+                           uint32_t preEraseCnt) {
+    sd_write_async_complete(pSD);
+    sd_acquire(pSD);
+    TRACE_PRINTF("%s(0x%llx, 0x%lx)\r\n", __FUNCTION__, ulSectorNumber,
+                 preEraseCnt);
+    int status = in_sd_write_session_begin(pSD, ulSectorNumber, preEraseCnt);
+    sd_release(pSD);
+    return status;
+}
+
+/** Append blocks to the open session, at sd_write_session_next()
+ *
+ *  @return         SD_BLOCK_DEVICE_ERROR_NONE(0) - success
+ *                  SD_BLOCK_DEVICE_ERROR_PARAMETER - no open session, or
+ *                  past the end of the card
+ *                  SD_BLOCK_DEVICE_ERROR_WRITE - block rejected; the session
+ *                  is ended
+ *                  SD_BLOCK_DEVICE_ERROR_CRC - block rejected twice by the
+ *                  card's CRC check; the session is ended
+ */
+int sd_write_session_append(sd_card_t *pSD, const uint8_t *buffer,
+                            uint32_t blockCnt) {
+    sd_write_async_complete(pSD);
+    sd_acquire(pSD);
+    uint32_t blocks = blockCnt;
+    bool retried = false;
+    int status = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (!pSD->wr_session_open ||
+        pSD->wr_session_next + blockCnt > pSD->sectors) {
+        status = SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    }
+    while (SD_BLOCK_DEVICE_ERROR_NONE == status && blockCnt) {
+        uint8_t response =
+            sd_write_block(pSD, buffer, SPI_START_BLK_MUL_WRITE, _block_size);
+        if (response != SPI_DATA_ACCEPTED) {
+            DBG_PRINTF("Streaming Block Write failed: 0x%x\r\n", response);
+            in_sd_write_session_end(pSD);
+            status = (response == SPI_DATA_CRC_ERROR) ? SD_BLOCK_DEVICE_ERROR_CRC
+                                                      : SD_BLOCK_DEVICE_ERROR_WRITE;
+            if (SD_BLOCK_DEVICE_ERROR_CRC == status && !retried) {
+                // Retry once: the earlier blocks were accepted, so a new
+                // session resumes at the rejected one
+                retried = true;
+                sd_card_event_hook(SD_EVENT_RETRY);
+                sd_check_crc_rate(pSD, status, 0);
+                status = in_sd_write_session_begin(pSD, pSD->wr_session_next, 0);
+                continue;
+            }
+            break;
+        }
+        buffer += _block_size;
+        ++pSD->wr_session_next;
+        --blockCnt;
+    }
+    sd_check_crc_rate(pSD, status, blocks);
     sd_release(pSD);
     return status;
 }
 
+/** Send the stop token and wait for the card to finish programming */
+int sd_write_session_end(sd_card_t *pSD) {
+    sd_write_async_complete(pSD);
+    sd_acquire(pSD);
+    int status = in_sd_write_session_end(pSD);
+    sd_release(pSD);
+    return status;
+}
+
+/** True if a session is open; *next_sector receives the next expected LBA */
+bool sd_write_session_is_open(sd_card_t *pSD, uint64_t *next_sector) {
+    if (next_sector) *next_sector = pSD->wr_session_next;
+    return pSD->wr_session_open;
+}
+
+/* Asynchronous streaming write
+ *
+ * Built on the streaming session: each 512-byte block is clocked out by
+ * spi_transfer_async while the caller does other work. The short steps
+ * between blocks (CRC, data response, busy polling) are done by
+ * sd_write_async_poll(), which never waits for the card. The card and its
+ * SPI stay acquired from sd_write_blocks_async() until the write completes;
+ * any other call into this driver from the same core completes it first,
+ * and calls from the other core block on the card mutex meanwhile.
+ */
+enum { SD_ASYNC_IDLE = 0, SD_ASYNC_DATA, SD_ASYNC_BUSY };
+
+static void sd_write_async_start_block(sd_card_t *pSD) {
+    sd_spi_write(pSD, SPI_START_BLK_MUL_WRITE);
+    pSD->wr_async_state = SD_ASYNC_DATA;
+#if SD_CRC_ENABLED
+    if (crc_on) {
+        // The CRC is collected when the data has gone out
+        spi_transfer_crc16_async(pSD->spi, pSD->wr_async_buffer, NULL, _block_size, NULL, NULL);
+        return;
+    }
+#endif
+    pSD->wr_async_crc = (~0);
+    spi_transfer_async(pSD->spi, pSD->wr_async_buffer, NULL, _block_size, NULL, NULL);
+}
+
+static int sd_write_async_finish(sd_card_t *pSD, int status) {
+    pSD->wr_async_state = SD_ASYNC_IDLE;
+    sd_check_crc_rate(pSD, status, 1);
+    sd_release(pSD);
+    return status;
+}
+
+int sd_write_blocks_async(sd_card_t *pSD, const uint8_t *buffer,
+                          uint64_t ulSectorNumber, uint32_t blockCnt) {
+    if (pSD->wr_async_state != SD_ASYNC_IDLE)
+        return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+    if (!blockCnt) return SD_BLOCK_DEVICE_ERROR_NONE;
+
+    sd_acquire(pSD);
+    TRACE_PRINTF("%s(0x%p, 0x%llx, 0x%lx)\r\n", __FUNCTION__, buffer,
+                 ulSectorNumber, blockCnt);
+    int status = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (!pSD->wr_session_open || pSD->wr_session_next != ulSectorNumber)
+        status = in_sd_write_session_begin(pSD, ulSectorNumber, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status &&
+        ulSectorNumber + blockCnt > pSD->sectors)
+        status = SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+        sd_release(pSD);
+        return status;
+    }
+    pSD->wr_async_buffer = buffer;
+    pSD->wr_async_remaining = blockCnt;
+    pSD->wr_async_core = get_core_num();
+    sd_write_async_start_block(pSD);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+/** Advance the asynchronous write
+ *
+ *  @return         SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK - still in progress
+ *                  SD_BLOCK_DEVICE_ERROR_NONE(0) - all blocks written, or
+ *                  nothing in flight
+ *                  other - the write failed and the session was ended
+ */
+int sd_write_async_poll(sd_card_t *pSD) {
+    switch (pSD->wr_async_state) {
+        case SD_ASYNC_DATA: {
+            if (spi_transfer_busy(pSD->spi)) return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+#if SD_CRC_ENABLED
+            if (crc_on) pSD->wr_async_crc = spi_transfer_crc16_result(pSD->spi);
+#endif
+            // write the checksum CRC16 and check the response token
+            sd_spi_write(pSD, pSD->wr_async_crc >> 8);
+            sd_spi_write(pSD, pSD->wr_async_crc);
+            uint8_t response = sd_spi_write(pSD, SPI_FILL_CHAR) & SPI_DATA_RESPONSE_MASK;
+            if (response != SPI_DATA_ACCEPTED) {
+                DBG_PRINTF("Async Block Write failed: 0x%x\r\n", response);
+                in_sd_write_session_end(pSD);
+                return sd_write_async_finish(
+                    pSD, (response == SPI_DATA_CRC_ERROR) ? SD_BLOCK_DEVICE_ERROR_CRC
+                                                          : SD_BLOCK_DEVICE_ERROR_WRITE);
+            }
+            pSD->wr_async_deadline = make_timeout_time_ms(SD_COMMAND_TIMEOUT);
+            pSD->wr_async_state = SD_ASYNC_BUSY;
+        }
+        // fall through
+        case SD_ASYNC_BUSY:
+            // The card holds DO low while it programs the block
+            if (0x00 == sd_spi_write(pSD, SPI_FILL_CHAR)) {
+                if (!time_reached(pSD->wr_async_deadline))
+                    return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+                DBG_PRINTF("%s: Card not ready yet\r\n", __FUNCTION__);
+                in_sd_write_session_end(pSD);
+                return sd_write_async_finish(pSD, SD_BLOCK_DEVICE_ERROR_NO_RESPONSE);
+            }
+            pSD->wr_async_buffer += _block_size;
+            ++pSD->wr_session_next;
+            if (--pSD->wr_async_remaining) {
+                sd_write_async_start_block(pSD);
+                return SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+            }
+            return sd_write_async_finish(pSD, SD_BLOCK_DEVICE_ERROR_NONE);
+        default:
+            return SD_BLOCK_DEVICE_ERROR_NONE;
+    }
+}
+
+int sd_write_async_wait(sd_card_t *pSD) {
+    int status;
+    while (SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK == (status = sd_write_async_poll(pSD)))
+        tight_loop_contents();
+    return status;
+}
+
+bool sd_write_async_busy(sd_card_t *pSD) {
+    return pSD->wr_async_state != SD_ASYNC_IDLE;
+}
+
+void sd_write_async_complete(sd_card_t *pSD) {
+    if (pSD->wr_async_state != SD_ASYNC_IDLE && pSD->wr_async_core == get_core_num())
+        sd_write_async_wait(pSD);
+}
+
 static int sd_init_medium(sd_card_t *pSD) {
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response, arg;
@@ -1134,6 +1586,9 @@ static bool sd_test_com(sd_card_t *pSD);
 static void sd_ctor(sd_card_t *pSD) {
     // State variables:
     pSD->m_Status = STA_NOINIT;
+    pSD->wr_session_open = false;
+    pSD->wr_async_state = SD_ASYNC_IDLE;
+
     pSD->init = sd_init;
     pSD->write_blocks = sd_write_blocks;
     pSD->read_blocks = sd_read_blocks;
@@ -1224,11 +1679,14 @@ static int sd_init(sd_card_t *pSD) {
         sd_unlock(pSD);
         return pSD->m_Status;
     }
-    // Set SCK for data transfer
-    sd_spi_go_high_frequency(pSD);
-
     // The card is now initialized
     pSD->m_Status &= ~STA_NOINIT;
+    sd_read_sd_status_nolock(pSD);
+
+    // Set SCK for data transfer: fastest clock that passes the CRC test
+    pSD->crc_errors = 0;
+    pSD->crc_window = 0;
+    sd_negotiate_baud_rate(pSD);
 
     sd_spi_release(pSD);
     sd_unlock(pSD);
@@ -1241,7 +1699,9 @@ static bool sd_test_com(sd_card_t *pSD) {
     // This is allowed to be called before initialization, so ensure mutex is created
     if (!mutex_is_initialized(&pSD->mutex)) mutex_init(&pSD->mutex);
 
+    sd_write_async_complete(pSD);
     sd_acquire(pSD);
+    if (pSD->wr_session_open) in_sd_write_session_end(pSD);
 
     bool success = false;
 
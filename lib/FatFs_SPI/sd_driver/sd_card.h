@@ -54,6 +54,22 @@ struct sd_card_t {
     mutex_t mutex;
     FATFS fatfs;
     bool mounted;
+    bool wr_session_open;      // Streaming CMD25 in progress (see sd_write_session_begin)
+    uint64_t wr_session_next;  // Next LBA expected by the open session
+    uint32_t crc_errors;       // CRC errors in the current window
+    // Asynchronous streaming write in flight (see sd_write_blocks_async)
+    volatile int wr_async_state;
+    const uint8_t *wr_async_buffer;
+    uint32_t wr_async_remaining;
+    uint16_t wr_async_crc;
+    uint wr_async_core;        // Core that started it; only it may complete it
+    absolute_time_t wr_async_deadline;
+    uint32_t crc_window;       // Blocks transferred in the current window
+    // From the SD status (ACMD13) read by sd_init; 0 if not reported
+    uint32_t au_sectors;       // Allocation unit (erase block) in sectors
+    uint16_t erase_size;       // AUs erased within erase_timeout_s
+    uint8_t erase_timeout_s;
+    uint8_t erase_offset_s;
 
     int (*init)(sd_card_t *sd_card_p);
     int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
@@ -93,6 +109,48 @@ uint64_t sd_sectors(sd_card_t *pSD);
 bool sd_init_driver();
 bool sd_card_detect(sd_card_t *sd_card_p);
 
+int sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
+                   uint32_t ulSectorCount);
+int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
+                    uint64_t ulSectorNumber, uint32_t blockCnt);
+
+// Streaming write session: one CMD25 kept open across calls
+int sd_write_session_begin(sd_card_t *pSD, uint64_t ulSectorNumber,
+                           uint32_t preEraseCnt);
+int sd_write_session_append(sd_card_t *pSD, const uint8_t *buffer,
+                            uint32_t blockCnt);
+int sd_write_session_end(sd_card_t *pSD);
+bool sd_write_session_is_open(sd_card_t *pSD, uint64_t *next_sector);
+
+// Asynchronous write: returns once the first block is clocked out by DMA.
+// Drive it with sd_write_async_poll() until it stops returning
+// SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK; the buffer must stay valid until then.
+int sd_write_blocks_async(sd_card_t *pSD, const uint8_t *buffer,
+                          uint64_t ulSectorNumber, uint32_t blockCnt);
+int sd_write_async_poll(sd_card_t *pSD);
+int sd_write_async_wait(sd_card_t *pSD);
+bool sd_write_async_busy(sd_card_t *pSD);
+// Completes an asynchronous write started by the calling core, if any; the
+// FatFs volume lock calls it first so that lock order stays volume -> card
+void sd_write_async_complete(sd_card_t *pSD);
+
+// Erases sectors first..last (CMD32/CMD33/CMD38); reads back as zeros or
+// ones (DATA_STAT_AFTER_ERASE) and the next write skips garbage collection
+int sd_erase_blocks(sd_card_t *pSD, uint64_t first, uint64_t last);
+
+// Data clock negotiated by sd_init (Hz)
+uint sd_get_baud_rate(sd_card_t *pSD);
+
+// Instrumentation hooks, called with the time spent waiting for a busy card
+// and on each CRC error or retried transfer. The weak definitions in
+// sd_card.c do nothing; the application may supply its own.
+typedef enum {
+    SD_EVENT_CRC_ERROR,
+    SD_EVENT_RETRY
+} sd_event_t;
+void sd_card_wait_hook(uint32_t wait_us);
+void sd_card_event_hook(sd_event_t event);
+
 #ifdef __cplusplus
 }
 #endif
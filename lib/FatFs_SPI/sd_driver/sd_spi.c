@@ -31,9 +31,17 @@ specific language governing permissions and limitations under the License.
 #pragma GCC diagnostic ignored "-Wunused-variable"
 
 void sd_spi_go_high_frequency(sd_card_t *pSD) {
-    uint actual = spi_set_baudrate(pSD->spi->hw_inst, pSD->spi->baud_rate);
+    uint baud_rate = pSD->spi->negotiated_baud_rate;
+    if (!baud_rate) baud_rate = pSD->spi->baud_rate;
+    uint actual = spi_set_baudrate(pSD->spi->hw_inst, baud_rate);
     TRACE_PRINTF("%s: Actual frequency: %lu\n", __FUNCTION__, (long)actual);
 }
+// Returns the actual frequency, which depends on clk_peri
+uint sd_spi_set_frequency(sd_card_t *pSD, uint baud_rate) {
+    uint actual = spi_set_baudrate(pSD->spi->hw_inst, baud_rate);
+    TRACE_PRINTF("%s: Actual frequency: %lu\n", __FUNCTION__, (long)actual);
+    return actual;
+}
 void sd_spi_go_low_frequency(sd_card_t *pSD) {
     uint actual = spi_set_baudrate(pSD->spi->hw_inst, 400 * 1000); // Actual frequency: 398089
     TRACE_PRINTF("%s: Actual frequency: %lu\n", __FUNCTION__, (long)actual);
@@ -90,6 +98,11 @@ bool sd_spi_transfer(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
                      size_t length) {
     return spi_transfer(pSD->spi, tx, rx, length);
 }
+// Transfer, also returning the CRC16 of the data (DMA sniffer when available)
+bool sd_spi_transfer_crc16(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
+                           size_t length, uint16_t *crc) {
+    return spi_transfer_crc16(pSD->spi, tx, rx, length, crc);
+}
 
 uint8_t sd_spi_write(sd_card_t *pSD, const uint8_t value) {
     // TRACE_PRINTF("%s\n", __FUNCTION__);
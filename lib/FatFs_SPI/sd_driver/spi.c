@@ -18,9 +18,11 @@ specific language governing permissions and limitations under the License.
 #include "pico/stdlib.h"
 #include "pico/mutex.h"
 #include "pico/sem.h"
+#include "hardware/claim.h"
 //
 #include "my_debug.h"
 #include "hw_config.h"
+#include "crc.h"
 //
 #include "spi.h"
 
@@ -36,8 +38,10 @@ static void in_spi_irq_handler(const uint DMA_IRQ_num, io_rw_32 *dma_hw_ints_p)
                 *dma_hw_ints_p = 1 << spi_p->rx_dma;  // Clear it.
                 assert(!dma_channel_is_busy(spi_p->rx_dma));
                 assert(!sem_available(&spi_p->sem));
+                spi_p->async_busy = false;
                 bool ok = sem_release(&spi_p->sem);
                 assert(ok);
+                if (spi_p->async_cb) spi_p->async_cb(spi_p, spi_p->async_ctx);
             }
         }
     }
@@ -54,16 +58,48 @@ void set_spi_dma_irq_channel(bool useChannel1, bool shared) {
     irqShared = shared;
 }
 
-// SPI Transfer: Read & Write (simultaneously) on SPI bus
-//   If the data that will be received is not important, pass NULL as rx.
-//   If the data that will be transmitted is not important,
-//     pass NULL as tx and then the SPI_FILL_CHAR is sent out as each data
-//     element.
-bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+// The DMA has a single sniffer, shared by all SPIs. It is claimed per
+// transfer; whoever finds it taken computes the CRC in software instead.
+static spi_t *sniff_owner;
+// 0: not yet checked, 1: sniffer agrees with crc16(), -1: it does not
+static int sniff_verified;
+
+static bool sniffer_claim(spi_t *spi_p) {
+    if (sniff_verified < 0) return false;
+    uint32_t save = hw_claim_lock();
+    bool ok = !sniff_owner;
+    if (ok) sniff_owner = spi_p;
+    hw_claim_unlock(save);
+    return ok;
+}
+
+static void sniffer_release(spi_t *spi_p) {
+    uint32_t save = hw_claim_lock();
+    if (sniff_owner == spi_p) {
+        dma_sniffer_disable();
+        sniff_owner = NULL;
+    }
+    hw_claim_unlock(save);
+}
+
+static bool in_spi_transfer_start(spi_t *spi_p, const uint8_t *tx, uint8_t *rx,
+                                  size_t length, spi_transfer_cb_t cb, void *ctx,
+                                  bool sniff) {
     // assert(512 == length || 1 == length);
     assert(tx || rx);
     // assert(!(tx && rx));
 
+    // Sniff the channel carrying the meaningful data: outgoing for writes,
+    // incoming for reads
+    channel_config_set_sniff_enable(&spi_p->tx_dma_cfg, sniff && tx);
+    channel_config_set_sniff_enable(&spi_p->rx_dma_cfg, sniff && !tx);
+    if (sniff) {
+        // CRC-16-CCITT, seed 0, no output inversion/reversal: as used by SD
+        dma_sniffer_enable(tx ? spi_p->tx_dma : spi_p->rx_dma,
+                           DMA_SNIFF_CTRL_CALC_VALUE_CRC16, false);
+        dma_sniffer_set_data_accumulator(0);
+    }
+
     // tx write increment is already false
     if (tx) {
         channel_config_set_read_increment(&spi_p->tx_dma_cfg, true);
@@ -106,15 +142,87 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
             assert(false);
     }
     sem_reset(&spi_p->sem, 0);
+    spi_p->async_cb = cb;
+    spi_p->async_ctx = ctx;
+    spi_p->async_busy = true;
 
     // start them exactly simultaneously to avoid races (in extreme cases
     // the FIFO could overflow)
     dma_start_channel_mask((1u << spi_p->tx_dma) | (1u << spi_p->rx_dma));
+    return true;
+}
+
+// Start a DMA transfer and return immediately
+//   Same buffer conventions as spi_transfer. The buffers must stay valid until
+//   the transfer completes. cb (may be NULL) is called from the DMA interrupt
+//   on completion; alternatively, poll spi_transfer_busy() or block in
+//   spi_transfer_wait(). The caller must hold the SPI (spi_lock) throughout.
+bool spi_transfer_async(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length,
+                        spi_transfer_cb_t cb, void *ctx) {
+    spi_p->crc_sniffing = false;
+    return in_spi_transfer_start(spi_p, tx, rx, length, cb, ctx, false);
+}
+
+// As spi_transfer_async, also computing the CRC-16-CCITT of the data
+//   (tx if given, otherwise rx) as it streams, using the DMA sniffer.
+//   Collect it with spi_transfer_crc16_result() once the transfer is done.
+bool spi_transfer_crc16_async(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length,
+                              spi_transfer_cb_t cb, void *ctx) {
+    spi_p->crc_data = tx ? tx : rx;
+    spi_p->crc_length = length;
+    spi_p->crc_sniffing = sniffer_claim(spi_p);
+    return in_spi_transfer_start(spi_p, tx, rx, length, cb, ctx, spi_p->crc_sniffing);
+}
 
+// CRC of the last spi_transfer_crc16_async; call only after it completed
+//   Falls back to the table crc16() when the sniffer was not available. The
+//   first sniffed result is checked against crc16(), and the sniffer is
+//   abandoned if the two ever disagree.
+uint16_t spi_transfer_crc16_result(spi_t *spi_p) {
+    assert(!spi_p->async_busy);
+    if (!spi_p->crc_sniffing)
+        return crc16((const char *)spi_p->crc_data, spi_p->crc_length);
+
+    uint16_t crc = dma_sniffer_get_data_accumulator() & 0xFFFF;
+    spi_p->crc_sniffing = false;
+    sniffer_release(spi_p);
+    if (!sniff_verified) {
+        uint16_t sw = crc16((const char *)spi_p->crc_data, spi_p->crc_length);
+        if (sw != crc) {
+            DBG_PRINTF("%s: DMA sniffer CRC 0x%04x != 0x%04x; using software CRC\n",
+                       __FUNCTION__, crc, sw);
+            sniff_verified = -1;
+            return sw;
+        }
+        sniff_verified = 1;
+    }
+    return crc;
+}
+
+// Blocking transfer that also returns the CRC-16-CCITT of the data
+bool spi_transfer_crc16(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length,
+                        uint16_t *crc) {
+    if (!spi_transfer_crc16_async(spi_p, tx, rx, length, NULL, NULL)) return false;
+    bool ok = spi_transfer_wait(spi_p, 1000); /* Timeout 1 sec */
+    if (!ok) {
+        // Transfer abandoned: the sniffed value is meaningless
+        if (spi_p->crc_sniffing) sniffer_release(spi_p);
+        spi_p->crc_sniffing = false;
+        return false;
+    }
+    *crc = spi_transfer_crc16_result(spi_p);
+    return true;
+}
+
+bool spi_transfer_busy(spi_t *spi_p) {
+    return spi_p->async_busy;
+}
+
+// Block until the transfer in flight completes
+bool spi_transfer_wait(spi_t *spi_p, uint32_t timeout_ms) {
     /* Wait until master completes transfer or time out has occured. */
-    uint32_t timeOut = 1000; /* Timeout 1 sec */
     bool rc = sem_acquire_timeout_ms(
-        &spi_p->sem, timeOut);  // Wait for notification from ISR
+        &spi_p->sem, timeout_ms);  // Wait for notification from ISR
     if (!rc) {
         // If the timeout is reached the function will return false
         DBG_PRINTF("Notification wait timed out in %s\n", __FUNCTION__);
@@ -131,6 +239,16 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     return true;
 }
 
+// SPI Transfer: Read & Write (simultaneously) on SPI bus
+//   If the data that will be received is not important, pass NULL as rx.
+//   If the data that will be transmitted is not important,
+//     pass NULL as tx and then the SPI_FILL_CHAR is sent out as each data
+//     element.
+bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    if (!spi_transfer_async(spi_p, tx, rx, length, NULL, NULL)) return false;
+    return spi_transfer_wait(spi_p, 1000); /* Timeout 1 sec */
+}
+
 void spi_lock(spi_t *spi_p) {
     assert(mutex_is_initialized(&spi_p->mutex));
     mutex_enter_blocking(&spi_p->mutex);
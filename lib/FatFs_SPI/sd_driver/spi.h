@@ -27,14 +27,19 @@ specific language governing permissions and limitations under the License.
 
 #define SPI_FILL_CHAR (0xFF)
 
+typedef struct spi_t spi_t;
+
+// Completion callback for spi_transfer_async; runs in the DMA interrupt
+typedef void (*spi_transfer_cb_t)(spi_t *pSPI, void *ctx);
+
 // "Class" representing SPIs
-typedef struct {
+struct spi_t {
     // SPI HW
     spi_inst_t *hw_inst;
     uint miso_gpio;  // SPI MISO GPIO number (not pin number)
     uint mosi_gpio;
     uint sck_gpio;
-    uint baud_rate;
+    uint baud_rate;    // Ceiling for the data transfer clock
     uint DMA_IRQ_num; // DMA_IRQ_0 or DMA_IRQ_1
 
     // Drive strength levels for GPIO outputs.
@@ -51,15 +56,32 @@ typedef struct {
     dma_channel_config rx_dma_cfg;
     irq_handler_t dma_isr; // Ignored: no longer used
     bool initialized;  
+    uint negotiated_baud_rate;  // Actual data clock chosen by sd_init (0: not yet)
     semaphore_t sem;
     mutex_t mutex;    
-} spi_t;
+    volatile bool async_busy;   // Transfer started by spi_transfer_async in flight
+    spi_transfer_cb_t async_cb;
+    void *async_ctx;
+    bool crc_sniffing;          // DMA sniffer computing the CRC of this transfer
+    const uint8_t *crc_data;    // Buffer covered by the CRC (software fallback)
+    size_t crc_length;
+};
 
 #ifdef __cplusplus
 extern "C" {
 #endif
   
 bool __not_in_flash_func(spi_transfer)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);  
+bool spi_transfer_async(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length,
+                        spi_transfer_cb_t cb, void *ctx);
+bool spi_transfer_busy(spi_t *pSPI);
+bool spi_transfer_wait(spi_t *pSPI, uint32_t timeout_ms);
+bool spi_transfer_crc16_async(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length,
+                              spi_transfer_cb_t cb, void *ctx);
+uint16_t spi_transfer_crc16_result(spi_t *pSPI);
+bool spi_transfer_crc16(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length,
+                        uint16_t *crc);
+
 void spi_lock(spi_t *pSPI);
 void spi_unlock(spi_t *pSPI);
 bool my_spi_init(spi_t *pSPI);
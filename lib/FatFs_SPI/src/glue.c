@@ -32,6 +32,12 @@ specific language governing permissions and limitations under the License.
 #define TRACE_PRINTF(fmt, args...)
 //#define TRACE_PRINTF printf  // task_printf
 
+// Keep a CMD25 multiple block write open while FatFs writes consecutive
+// sectors (see sd_write_session_begin in sd_card.c)
+#ifndef SD_STREAMING_WRITES
+#define SD_STREAMING_WRITES 1
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -116,7 +122,19 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+#if SD_STREAMING_WRITES
+    // Continue the open session if this write picks up where the last one
+    // ended; otherwise start a new one here. Reads, CTRL_SYNC and any other
+    // card command end the session.
+    uint64_t next;
+    int rc = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (!sd_write_session_is_open(p_sd, &next) || next != sector)
+        rc = sd_write_session_begin(p_sd, sector, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == rc)
+        rc = sd_write_session_append(p_sd, buff, count);
+#else
     int rc = p_sd->write_blocks(p_sd, buff, sector, count);
+#endif
     return sdrc2dresult(rc);
 }
 
@@ -156,11 +174,37 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
                                 // f_mkfs function and it attempts to align data
                                 // area on the erase block boundary. It is
                                 // required when FF_USE_MKFS == 1.
-            static DWORD bs = 1;
+            // AU from the SD status; 12 MiB and 24 MiB AUs are not powers
+            // of 2, so align to the largest power of 2 that divides them
+            DWORD bs = p_sd->au_sectors & -p_sd->au_sectors;
+            if (!bs) bs = 1;
+            if (bs > 32768) bs = 32768;
             *(DWORD *)buff = bs;
             return RES_OK;
         }
+#if FF_USE_TRIM
+        case CTRL_TRIM: {  // Informs the device the data on the block of
+                           // sectors is no longer needed and it can be
+                           // erased. The sector block is specified by an LBA_t
+                           // array {<Start LBA>, <End LBA>} pointed by buff.
+            // Only whole AUs: erasing part of one buys nothing and costs a copy
+            LBA_t *range = (LBA_t *)buff;
+            LBA_t au = p_sd->au_sectors;
+            if (!au) return RES_OK;
+            LBA_t first = (range[0] + au - 1) / au * au;
+            LBA_t end = (range[1] + 1) / au * au;  // Exclusive
+            if (first >= end) return RES_OK;
+            if (sd_erase_blocks(p_sd, first, end - 1) != SD_BLOCK_DEVICE_ERROR_NONE)
+                return RES_ERROR;
+            return RES_OK;
+        }
+#endif
         case CTRL_SYNC:
+#if SD_STREAMING_WRITES
+            // Stop token: the card finishes programming before f_sync returns
+            if (sd_write_session_end(p_sd) != SD_BLOCK_DEVICE_ERROR_NONE)
+                return RES_ERROR;
+#endif
             return RES_OK;
         default:
             return RES_PARERR;
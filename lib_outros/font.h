@@ -1,4 +1,10 @@
-static uint8_t font[] = {
+// Fonte 8x8 para ' '..'~', já no formato do display: 8 bytes por caractere,
+// um por coluna, bit 0 = linha superior (pode ser copiada direto para as páginas)
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR  '~'
+#define FONT_GLYPH_WIDTH 8
+
+static const uint8_t font[] = {
 
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //  
 0x00, 0x00, 0x00, 0x5F, 0x5F, 0x00, 0x00, 0x00, // !
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
@@ -11,6 +12,47 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->page_buffer = calloc(ssd->width + 1, sizeof(uint8_t));
+  ssd->page_buffer[0] = 0x40;
+  ssd->back_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->back_valid = false;
+  ssd->tx_stream = NULL;
+  ssd->dma_chan = -1;
+  ssd->dma_pending = false;
+  ssd1306_invalidate(ssd);
+}
+
+// Reserva o canal DMA e o buffer de saída para ssd1306_send_data_async
+void ssd1306_dma_init(ssd1306_t *ssd) {
+  if (ssd->dma_chan >= 0)
+    return;
+  ssd->tx_stream = calloc(SSD1306_STREAM_WORDS, sizeof(uint32_t));
+  ssd->dma_chan = dma_claim_unused_channel(true);
+}
+
+// Aguarda o fim de um envio por DMA antes de usar o barramento diretamente
+static void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
+}
+
+// Marca a coluna x da página como alterada
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x, uint8_t page) {
+  if (x < ssd->dirty_x0[page]) ssd->dirty_x0[page] = x;
+  if (x > ssd->dirty_x1[page]) ssd->dirty_x1[page] = x;
+}
+
+// Liga ou apaga o painel; o conteúdo da memória do display é mantido
+void ssd1306_set_power(ssd1306_t *ssd, bool on) {
+  ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+}
+
+// Força o próximo envio a transmitir a tela inteira
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    ssd->dirty_x0[p] = 0;
+    ssd->dirty_x1[p] = ssd->width - 1;
+  }
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -42,6 +84,7 @@ void ssd1306_config(ssd1306_t *ssd) {
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,69 +95,194 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
+// Envia apenas as colunas alteradas de cada página
+// O buffer é organizado por colunas (modo de endereçamento vertical); cada
+// faixa é copiada para page_buffer e enviada numa janela de uma página
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd1306_wait(ssd);
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    uint8_t x0 = ssd->dirty_x0[p], x1 = ssd->dirty_x1[p];
+    if (x0 > x1)
+      continue;
+
+    // Janela de escrita: comandos numa única transação (byte de controle 0x00)
+    uint8_t window[7] = {0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p, p};
+    i2c_write_blocking(ssd->i2c_port, ssd->address, window, sizeof window, false);
+
+    uint16_t n = x1 - x0 + 1;
+    const uint8_t *src = ssd->ram_buffer + 1 + ((uint16_t)x0 << 3) + p;
+    for (uint16_t i = 0; i < n; ++i)
+      ssd->page_buffer[1 + i] = src[i << 3];
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->page_buffer, n + 1, false);
+
+    ssd->dirty_x0[p] = 0xFF;
+    ssd->dirty_x1[p] = 0;
+  }
+}
+
+// Versão não bloqueante de ssd1306_send_data (requer ssd1306_dma_init)
+// As faixas alteradas são copiadas para tx_stream como palavras de
+// IC_DATA_CMD (stop no fim de cada transação) e enviadas por DMA; o desenho
+// do próximo quadro pode começar logo em seguida
+// @return false se o envio anterior ainda estiver em andamento
+bool ssd1306_send_data_async(ssd1306_t *ssd, ssd1306_done_cb_t cb, void *ctx) {
+  if (ssd1306_busy(ssd))
+    return false;
+
+  uint32_t *w = ssd->tx_stream;
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    uint8_t x0 = ssd->dirty_x0[p], x1 = ssd->dirty_x1[p];
+    if (x0 > x1)
+      continue;
+
+    const uint8_t window[7] = {0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p, p};
+    for (uint8_t i = 0; i < sizeof window; ++i)
+      *w++ = window[i];
+    w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    *w++ = 0x40;
+    const uint8_t *src = ssd->ram_buffer + 1 + ((uint16_t)x0 << 3) + p;
+    for (uint16_t i = 0; i <= (uint16_t)(x1 - x0); ++i)
+      *w++ = src[i << 3];
+    w[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    ssd->dirty_x0[p] = 0xFF;
+    ssd->dirty_x1[p] = 0;
+  }
+
+  uint32_t count = w - ssd->tx_stream;
+  if (!count) {
+    if (cb)
+      cb(ssd, true, ctx);
+    return true;
+  }
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+
+  dma_channel_config cfg = dma_channel_get_default_config(ssd->dma_chan);
+  channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+  channel_config_set_read_increment(&cfg, true);
+  channel_config_set_write_increment(&cfg, false);
+  channel_config_set_dreq(&cfg, i2c_get_dreq(ssd->i2c_port, true));
+  ssd->done_cb = cb;
+  ssd->done_ctx = ctx;
+  ssd->dma_pending = true;
+  dma_channel_configure(ssd->dma_chan, &cfg, &hw->data_cmd, ssd->tx_stream, count, true);
+  return true;
+}
+
+// Indica se um envio por DMA ainda está em andamento
+// Ao detectar o fim (último byte fora da FIFO ou NACK do display), chama o
+// callback registrado; em caso de falha, a tela inteira é reenviada depois
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (!ssd->dma_pending)
+    return false;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  bool ok = true;
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    dma_channel_abort(ssd->dma_chan);
+    (void)hw->clr_tx_abrt;
+    ok = false;
+  } else if (dma_channel_is_busy(ssd->dma_chan) ||
+             !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+             (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+    return true;
+  }
+
+  ssd->dma_pending = false;
+  if (!ok)
+    ssd1306_invalidate(ssd);
+  if (ssd->done_cb)
+    ssd->done_cb(ssd, ok, ssd->done_ctx);
+  return false;
+}
+
+// Guarda a tela atual como fundo estático identificado por tag
+void ssd1306_save_background(ssd1306_t *ssd, uint16_t tag) {
+  memcpy(ssd->back_buffer, ssd->ram_buffer, ssd->bufsize);
+  ssd->back_tag = tag;
+  ssd->back_valid = true;
+}
+
+// Restaura o fundo guardado com a mesma tag, marcando só os bytes que mudam
+// @return false se não houver fundo guardado para essa tag (redesenhar)
+bool ssd1306_restore_background(ssd1306_t *ssd, uint16_t tag) {
+  if (!ssd->back_valid || ssd->back_tag != tag)
+    return false;
+  for (uint16_t i = 1; i < ssd->bufsize; ++i) {
+    if (ssd->ram_buffer[i] != ssd->back_buffer[i]) {
+      ssd->ram_buffer[i] = ssd->back_buffer[i];
+      ssd1306_mark_dirty(ssd, (i - 1) >> 3, (i - 1) & 0b111);
+    }
+  }
+  return true;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+  uint8_t old = ssd->ram_buffer[index];
+  uint8_t byte = value ? (old | (1 << pixel)) : (old & ~(1 << pixel));
+  if (byte != old) {
+    ssd->ram_buffer[index] = byte;
+    ssd1306_mark_dirty(ssd, x, y >> 3);
+  }
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Aplica value aos bits de mask no byte (coluna x, página page)
+static inline void ssd1306_write_bits(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, bool value) {
+  uint8_t *p = &ssd->ram_buffer[1 + ((uint16_t)x << 3) + page];
+  uint8_t byte = value ? (*p | mask) : (*p & ~mask);
+  if (byte != *p) {
+    *p = byte;
+    ssd1306_mark_dirty(ssd, x, page);
+  }
+}
 
+// Preenche a tela inteira byte a byte (8 pixels por acesso); apenas os
+// bytes que mudam são marcados para envio
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+  uint8_t byte = value ? 0xFF : 0x00;
+  for (uint16_t i = 1; i < ssd->bufsize; ++i) {
+    if (ssd->ram_buffer[i] != byte) {
+      ssd->ram_buffer[i] = byte;
+      ssd1306_mark_dirty(ssd, (i - 1) >> 3, (i - 1) & 0b111);
     }
+  }
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (!width || !height)
+    return;
+  uint8_t right = left + width - 1, bottom = top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    // Uma faixa vertical por coluna cobre borda superior, interior e inferior
+    for (uint16_t x = left + 1; x < right; ++x)
+      ssd1306_vline(ssd, x, top, bottom, value);
+  } else {
+    ssd1306_hline(ssd, left, right, top, value);
+    ssd1306_hline(ssd, left, right, bottom, value);
   }
+  ssd1306_vline(ssd, left, top, bottom, value);
+  ssd1306_vline(ssd, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Linhas horizontais e verticais usam os caminhos por byte
+    if (y0 == y1) {
+        ssd1306_hline(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, value);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_vline(ssd, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -143,40 +311,67 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 
+// Linha horizontal: a mesma máscara de bit em bytes consecutivos da página
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y >= ssd->height)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+  uint8_t page = y >> 3, mask = 1 << (y & 0b111);
+  for (uint16_t x = x0; x <= x1; ++x)
+    ssd1306_write_bits(ssd, x, page, mask, value);
 }
 
+// Linha vertical: bytes inteiros da coluna, com máscaras só nas pontas
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x >= ssd->width || y0 > y1 || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  for (uint8_t p = p0; p <= p1; ++p) {
+    uint8_t mask = 0xFF;
+    if (p == p0)
+      mask &= 0xFF << (y0 & 0b111);
+    if (p == p1)
+      mask &= 0xFF >> (7 - (y1 & 0b111));
+    ssd1306_write_bits(ssd, x, p, mask, value);
+  }
+}
+
+// Substitui os bits de mask no byte (coluna x, página page) pelos de bits
+static inline void ssd1306_write_masked(ssd1306_t *ssd, uint8_t x, uint8_t page, uint8_t mask, uint8_t bits) {
+  uint8_t *p = &ssd->ram_buffer[1 + ((uint16_t)x << 3) + page];
+  uint8_t byte = (*p & ~mask) | (bits & mask);
+  if (byte != *p) {
+    *p = byte;
+    ssd1306_mark_dirty(ssd, x, page);
+  }
 }
 
 // Função para desenhar um caractere
+// Cada coluna do glifo é um byte da fonte, copiado inteiro para a página;
+// com y fora do múltiplo de 8, a coluna é deslocada e dividida entre duas
+// páginas. A célula 8x8 é sobrescrita (fundo apagado), como antes
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
+  // Caractere inválido desenha um espaço (índice 0)
   uint16_t index = 0;
+  if (c >= FONT_FIRST_CHAR && c <= FONT_LAST_CHAR)
+    index = (c - FONT_FIRST_CHAR) * FONT_GLYPH_WIDTH;
+  const uint8_t *glyph = &font[index];
 
-  // Verifica o caractere e calcula o índice correspondente na fonte
-  if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
-  {
-    index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
-  }
-  else
-  {
-    // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-    index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
-  }
+  uint8_t page = y >> 3, shift = y & 0b111;
+  if (page >= ssd->pages)
+    return;
+  bool lower = shift && page + 1 < ssd->pages;
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  for (uint8_t i = 0; i < FONT_GLYPH_WIDTH && x + i < ssd->width; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
+    uint8_t col = glyph[i];
+    ssd1306_write_masked(ssd, x + i, page, 0xFF << shift, col << shift);
+    if (lower)
+      ssd1306_write_masked(ssd, x + i, page + 1, 0xFF >> (8 - shift), col >> (8 - shift));
   }
 }
 
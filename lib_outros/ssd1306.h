@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -25,19 +26,51 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
-typedef struct {
+#define SSD1306_MAX_PAGES (HEIGHT / 8)
+
+// Palavras de IC_DATA_CMD para enviar a tela inteira por DMA: por página,
+// janela (controle + 6 comandos) e dados (controle + WIDTH bytes)
+#define SSD1306_STREAM_WORDS (SSD1306_MAX_PAGES * (7 + 1 + WIDTH))
+
+typedef struct ssd1306_t ssd1306_t;
+
+// Chamada por ssd1306_busy() quando o envio por DMA termina
+typedef void (*ssd1306_done_cb_t)(ssd1306_t *ssd, bool ok, void *ctx);
+
+struct ssd1306_t {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
-} ssd1306_t;
+  // Faixa de colunas alterada em cada página desde o último envio (x0 > x1: limpa)
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];
+  uint8_t *page_buffer;   // Uma página a enviar, precedida do byte de controle
+  uint8_t *back_buffer;   // Cópia da tela estática (moldura e rótulos)
+  uint16_t back_tag;      // Identifica a tela guardada em back_buffer
+  bool back_valid;
+  // Envio por DMA: o quadro é copiado para tx_stream, liberando ram_buffer
+  // para o próximo desenho enquanto o anterior segue pelo I2C
+  uint32_t *tx_stream;
+  int dma_chan;
+  bool dma_pending;
+  ssd1306_done_cb_t done_cb;
+  void *done_ctx;
+};
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_invalidate(ssd1306_t *ssd);
+void ssd1306_set_power(ssd1306_t *ssd, bool on);
+void ssd1306_dma_init(ssd1306_t *ssd);
+bool ssd1306_send_data_async(ssd1306_t *ssd, ssd1306_done_cb_t cb, void *ctx);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_save_background(ssd1306_t *ssd, uint16_t tag);
+bool ssd1306_restore_background(ssd1306_t *ssd, uint16_t tag);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
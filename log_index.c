@@ -0,0 +1,238 @@
+/*
+ * ================================================================================
+ * ÍNDICE ESPARSO DOS ARQUIVOS DE DADOS
+ * ================================================================================
+ *
+ * Os instantes das entradas são time_us_32 e dão a volta a cada ~71 min: a
+ * extração acumula as diferenças entre entradas consecutivas para obter o
+ * tempo desde o início do arquivo.
+ * ================================================================================
+ */
+
+#include "log_index.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "f_util.h"
+#include "journal.h"
+#include "mpu_log.h"
+
+// Tabela de clusters do f_lseek rápido: 2 itens por fragmento do arquivo
+#define LIDX_CLMT_SIZE 64
+
+/**
+ * Reinicia o índice
+ * @param stride Amostras entre entradas (ao menos)
+ */
+void lidx_init(lidx_t *ix, uint32_t stride) {
+    ix->count = 0;
+    ix->stride = stride ? stride : 1;
+    ix->next_sample = 0;
+}
+
+/**
+ * Informa um ponto de reinício; só é guardado se a distância até a entrada
+ * anterior atingiu o passo
+ */
+void lidx_mark(lidx_t *ix, uint32_t sample, uint32_t t_us, uint32_t offset) {
+    if (ix->count && sample < ix->next_sample)
+        return;
+    if (ix->count == LIDX_MAX_ENTRIES) {
+        for (uint32_t i = 0; i < LIDX_MAX_ENTRIES / 2; i++)
+            ix->e[i] = ix->e[2 * i];
+        ix->count = LIDX_MAX_ENTRIES / 2;
+        ix->stride *= 2;
+        if (sample < ix->e[ix->count - 1].sample + ix->stride)
+            return;
+    }
+    ix->e[ix->count++] = (lidx_entry_t){sample, t_us, offset};
+    ix->next_sample = sample + ix->stride;
+}
+
+/**
+ * Nome do índice: o do arquivo de dados com a extensão .six
+ */
+void lidx_path(char *dst, size_t size, const char *data_path) {
+    const char *ponto = strrchr(data_path, '.');
+    int base = ponto ? (int)(ponto - data_path) : (int)strlen(data_path);
+    snprintf(dst, size, "%.*s.six", base, data_path);
+}
+
+/**
+ * Grava o índice ao lado do arquivo de dados (já fechado)
+ */
+FRESULT lidx_save(const lidx_t *ix, const char *data_path, uint32_t data_size) {
+    char path[40];
+    lidx_path(path, sizeof path, data_path);
+
+    lidx_header_t h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, LIDX_MAGIC, 4);
+    h.version = LIDX_VERSION;
+    h.header_size = sizeof h;
+    h.entry_size = sizeof(lidx_entry_t);
+    h.stride = ix->stride;
+    h.count = ix->count;
+    h.data_size = data_size;
+
+    static FIL fil;
+    UINT bw;
+    FRESULT fr = f_open(&fil, path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_write(&fil, &h, sizeof h, &bw);
+    if (fr == FR_OK)
+        fr = f_write(&fil, ix->e, ix->count * sizeof(lidx_entry_t), &bw);
+    FRESULT rc = f_close(&fil);
+    return fr != FR_OK ? fr : rc;
+}
+
+/**
+ * Procura no índice os deslocamentos que cobrem [t0_s, t1_s]
+ * @param start Ponto de reinício anterior ou igual a t0
+ * @param end_offset Fim da cópia (primeiro ponto depois de t1, ou o fim)
+ */
+static FRESULT find_range(const char *data_path, float t0_s, float t1_s,
+                          lidx_entry_t *start, uint32_t *end_offset, uint32_t *stride) {
+    char path[40];
+    lidx_path(path, sizeof path, data_path);
+
+    static FIL fil;
+    UINT br;
+    lidx_header_t h;
+    FRESULT fr = f_open(&fil, path, FA_READ);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_read(&fil, &h, sizeof h, &br);
+    if (fr == FR_OK && (br != sizeof h || memcmp(h.magic, LIDX_MAGIC, 4) ||
+                        h.entry_size != sizeof(lidx_entry_t) || !h.count))
+        fr = FR_INVALID_OBJECT;
+    if (fr == FR_OK)
+        fr = f_lseek(&fil, h.header_size);
+
+    uint64_t t0 = (uint64_t)(t0_s * 1e6f), t1 = (uint64_t)(t1_s * 1e6f);
+    uint64_t rel = 0;
+    uint32_t prev_t = 0;
+    *end_offset = h.data_size;
+    *stride = h.stride;
+    for (uint32_t i = 0; fr == FR_OK && i < h.count; i++) {
+        lidx_entry_t e;
+        fr = f_read(&fil, &e, sizeof e, &br);
+        if (fr != FR_OK || br != sizeof e)
+            break;
+        if (i)
+            rel += (uint32_t)(e.t_us - prev_t);
+        prev_t = e.t_us;
+        if (i == 0 || rel <= t0)
+            *start = e;
+        if (rel > t1) {
+            *end_offset = e.offset;
+            break;
+        }
+    }
+    f_close(&fil);
+    return fr;
+}
+
+/**
+ * Copia para out_path o trecho do arquivo de dados entre t0_s e t1_s
+ * (segundos desde o início do arquivo), arredondado para os pontos do índice
+ * O cabeçalho é reproduzido, com o instante de referência do trecho.
+ */
+FRESULT lidx_extract(const char *data_path, const char *out_path, float t0_s, float t1_s) {
+    lidx_entry_t start;
+    uint32_t end_offset, stride;
+    FRESULT fr = find_range(data_path, t0_s, t1_s, &start, &end_offset, &stride);
+    if (fr != FR_OK) {
+        printf("[ERRO] Índice de %s indisponível (%s)\n", data_path, FRESULT_str(fr));
+        return fr;
+    }
+    if (end_offset <= start.offset) {
+        printf("[AVISO] Intervalo fora da captura\n");
+        return FR_OK;
+    }
+
+    // Com FF_FS_TINY = 0 cada FIL carrega um buffer de setor de 512 bytes:
+    // estáticos, como os demais FIL de uso pontual do firmware, não pesam
+    // na pilha de 2 KB do núcleo 1
+    static FIL src, dst;
+    DWORD clmt[LIDX_CLMT_SIZE];
+    fr = f_open(&src, data_path, FA_READ);
+    if (fr != FR_OK)
+        return fr;
+
+    // Cabeçalho: binário (mpu_log.h) ou a linha de colunas do CSV, com o
+    // comentário da hora de início que a precede
+    uint8_t buf[1024];
+    UINT n = 0, bw;
+    mpu_log_header_t h;
+    fr = f_read(&src, &h, sizeof h, &n);
+    bool binario = fr == FR_OK && n == sizeof h && !memcmp(h.magic, MPU_LOG_MAGIC, 4);
+    if (binario && h.stripe_sectors) {
+        // Só metade dos blocos está neste cartão (log_writer.h)
+        printf("[ERRO] %s está distribuído entre dois cartões; junte as faixas no computador\n", data_path);
+        f_close(&src);
+        return FR_INVALID_OBJECT;
+    }
+    if (fr == FR_OK && !binario) {
+        f_lseek(&src, 0);
+        n = f_gets((char *)buf, sizeof buf, &src) ? strlen((char *)buf) : 0;
+        if (n && buf[0] == '#' && f_gets((char *)buf + n, sizeof buf - n, &src))
+            n += strlen((char *)buf + n);
+    }
+
+    // Tabela de clusters: os f_lseek seguintes não percorrem a FAT
+    src.cltbl = clmt;
+    clmt[0] = LIDX_CLMT_SIZE;
+    if (fr == FR_OK && f_lseek(&src, CREATE_LINKMAP) != FR_OK)
+        src.cltbl = NULL;                       // Muito fragmentado: seek comum
+    if (fr == FR_OK)
+        fr = f_lseek(&src, start.offset);
+    if (fr == FR_OK)
+        fr = f_open(&dst, out_path, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK) {
+        f_close(&src);
+        return fr;
+    }
+
+    if (binario) {
+        // A hora do RTC acompanha a nova referência (até ~71 min depois)
+        if (h.start_unix_us)
+            h.start_unix_us += (uint32_t)(start.t_us - h.start_us);
+        h.start_us = start.t_us;
+        h.flags &= ~MPU_LOG_FLAG_EVENT;
+        h.pre_samples = 0;
+        fr = f_write(&dst, &h, sizeof h, &bw);
+        // Blocos comprimidos: o primeiro bloco do arquivo ocupa o resto do setor
+        if (fr == FR_OK && (h.flags & MPU_LOG_FLAG_PACKED) && start.offset % h.block_size == 0) {
+            memset(buf, 0, sizeof buf);
+            fr = f_write(&dst, buf, h.block_size - sizeof h, &bw);
+        }
+        // Diário: o cabeçalho ocupa o primeiro setor e a cópia começa num setor
+        if (fr == FR_OK && (h.flags & MPU_LOG_FLAG_JOURNAL)) {
+            memset(buf, 0, sizeof buf);
+            fr = f_write(&dst, buf, JRNL_SECTOR_SIZE - sizeof h, &bw);
+        }
+    } else {
+        fr = f_write(&dst, buf, n, &bw);
+    }
+
+    uint32_t left = end_offset - start.offset;
+    while (fr == FR_OK && left) {
+        UINT br;
+        fr = f_read(&src, buf, left < sizeof buf ? left : sizeof buf, &br);
+        if (fr != FR_OK || !br)
+            break;
+        fr = f_write(&dst, buf, br, &bw);
+        left -= br;
+    }
+    printf("Extraídos %lu bytes a partir da amostra %lu (passo do índice: %lu amostras%s)\n",
+           end_offset - start.offset - left, start.sample, stride,
+           src.cltbl ? ", seek pela tabela de clusters" : "");
+
+    FRESULT rc = f_close(&dst);
+    f_close(&src);
+    return fr != FR_OK ? fr : rc;
+}
@@ -0,0 +1,68 @@
+/*
+ * ================================================================================
+ * ÍNDICE ESPARSO DOS ARQUIVOS DE DADOS
+ * ================================================================================
+ *
+ * Descrição: Durante a captura guarda em RAM, a cada `stride` amostras, o
+ *            número da amostra, o instante de referência e o deslocamento em
+ *            bytes de um ponto onde a decodificação pode recomeçar. Ao fechar
+ *            o arquivo o índice é gravado ao lado (<nome>.six) e permite
+ *            extrair um intervalo de tempo com f_lseek sobre a tabela de
+ *            clusters (FF_USE_FASTSEEK), sem ler o arquivo desde o início.
+ * ================================================================================
+ */
+
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ff.h"
+
+// Entradas mantidas em RAM; ao encher, o passo dobra e metade é descartada
+#ifndef LIDX_MAX_ENTRIES
+#define LIDX_MAX_ENTRIES 512
+#endif
+
+#define LIDX_MAGIC   "MPUI"
+#define LIDX_VERSION 1
+
+/**
+ * Ponto de reinício da decodificação
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t sample;            // Número da primeira amostra a partir do ponto
+    uint32_t t_us;              // Referência do dt dessa amostra (time_us_32)
+    uint32_t offset;            // Deslocamento no arquivo de dados
+} lidx_entry_t;
+
+/**
+ * Cabeçalho do arquivo de índice (32 bytes), seguido das entradas
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "MPUI"
+    uint8_t  version;           // LIDX_VERSION
+    uint8_t  header_size;       // sizeof(lidx_header_t)
+    uint8_t  entry_size;        // sizeof(lidx_entry_t)
+    uint8_t  reserved0;
+    uint32_t stride;            // Amostras entre entradas (no mínimo)
+    uint32_t count;             // Entradas no arquivo
+    uint32_t data_size;         // Tamanho final do arquivo de dados
+    uint8_t  reserved[12];
+} lidx_header_t;
+
+typedef struct {
+    lidx_entry_t e[LIDX_MAX_ENTRIES];
+    uint32_t count;
+    uint32_t stride;
+    uint32_t next_sample;       // Próxima amostra a indexar
+} lidx_t;
+
+void lidx_init(lidx_t *ix, uint32_t stride);
+void lidx_mark(lidx_t *ix, uint32_t sample, uint32_t t_us, uint32_t offset);
+FRESULT lidx_save(const lidx_t *ix, const char *data_path, uint32_t data_size);
+void lidx_path(char *dst, size_t size, const char *data_path);
+FRESULT lidx_extract(const char *data_path, const char *out_path, float t0_s, float t1_s);
+
+#endif // LOG_INDEX_H
@@ -0,0 +1,280 @@
+/*
+ * ================================================================================
+ * GRAVADOR ALINHADO A SETORES
+ * ================================================================================
+ *
+ * Os buffers formam uma fila circular: `active` recebe os dados e, ao
+ * encher, entra na fila de gravação. log_writer_service() grava um buffer da
+ * fila por chamada, de modo que o chamador pode intercalar a gravação com o
+ * esvaziamento do buffer de aquisição. O arquivo deve começar vazio para que
+ * os deslocamentos permaneçam alinhados a setores.
+ *
+ * No modo bruto o arquivo precisa ter sido pré-alocado (f_expand) e nenhum
+ * outro acesso ao cartão pode ocorrer até log_writer_flush(): qualquer
+ * comando intermediário encerraria a sessão CMD25.
+ *
+ * Com o segundo arquivo (somente via f_write) o espelho grava cada bloco nos
+ * dois; uma falha só no segundo é contada e a captura segue no principal.
+ * Nas faixas os blocos se alternam entre os arquivos, começando pelo
+ * principal: o arquivo original é a intercalação de blocos de
+ * LOG_WRITER_BUF_SIZE bytes, e só o último pode ser menor. Com os dois
+ * cartões no mesmo SPI o ganho vem da programação interna de um cartão
+ * enquanto o outro recebe dados, metade do desgaste em cada um.
+ *
+ * O gravador pode rodar no núcleo 1 enquanto o núcleo 0 lê busy_us, que tem
+ * 64 bits e não é escrito de uma só vez: ambos os lados passam pelo spin lock.
+ * ================================================================================
+ */
+
+#include "log_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "prof.h"
+
+static spin_lock_t *lock = NULL;                // Protege busy_us entre núcleos
+
+// Acumula o tempo de uma gravação
+static void add_busy(log_writer_t *w, uint32_t dt) {
+    uint32_t irq = spin_lock_blocking(lock);
+    w->busy_us += dt;
+    spin_unlock(lock, irq);
+}
+
+/**
+ * Associa o gravador a um arquivo recém-criado
+ */
+void log_writer_init(log_writer_t *w, FIL *fp) {
+    if (!lock)
+        lock = spin_lock_init(spin_lock_claim_unused(true));
+    w->fp = fp;
+    w->fp2 = NULL;
+    w->split = LOG_WRITER_SINGLE;
+    w->sd = NULL;
+    w->raw_sectors = 0;
+    w->raw_capacity = 0;
+    w->bytes = 0;
+    w->fill = 0;
+    w->active = 0;
+    w->queued = 0;
+    w->next = 0;
+    w->writes = 0;
+    w->stalls = 0;
+    w->max_write_us = 0;
+    uint32_t irq = spin_lock_blocking(lock);
+    w->busy_us = 0;
+    spin_unlock(lock, irq);
+    w->inflight = false;
+    w->mirror_errors = 0;
+}
+
+/**
+ * Associa um segundo arquivo, recém-criado em outro cartão
+ * Chamar logo após log_writer_init, antes do primeiro append
+ */
+void log_writer_set_second(log_writer_t *w, FIL *fp2, log_writer_split_t split) {
+    w->fp2 = split == LOG_WRITER_SINGLE ? NULL : fp2;
+    w->split = w->fp2 ? split : LOG_WRITER_SINGLE;
+}
+
+/**
+ * Associa o gravador a uma extensão contígua e abre a sessão CMD25
+ * @param lba Primeiro setor da extensão (início do arquivo pré-alocado)
+ * @param sectors Tamanho da extensão, em setores
+ */
+FRESULT log_writer_init_raw(log_writer_t *w, FIL *fp, sd_card_t *sd, LBA_t lba, uint32_t sectors) {
+    log_writer_init(w, fp);
+    if (sd_write_session_begin(sd, lba, sectors) != SD_BLOCK_DEVICE_ERROR_NONE)
+        return FR_DISK_ERR;
+    w->sd = sd;
+    w->raw_capacity = sectors;
+    return FR_OK;
+}
+
+/**
+ * Grava um bloco (f_write ou sessão CMD25) e registra a duração
+ * No modo bruto len deve ser múltiplo de FF_MIN_SS
+ */
+static FRESULT log_writer_write(log_writer_t *w, const uint8_t *data, UINT len) {
+    FRESULT fr = FR_OK;
+    uint32_t t0 = time_us_32();
+    if (w->sd) {
+        uint32_t n = len / FF_MIN_SS;
+        if (w->raw_sectors + n > w->raw_capacity) {
+            fr = FR_DENIED;                         // Extensão esgotada
+        } else if (sd_write_session_append(w->sd, data, n) != SD_BLOCK_DEVICE_ERROR_NONE) {
+            fr = FR_DISK_ERR;
+        } else {
+            w->raw_sectors += n;
+        }
+    } else {
+        // Faixas: blocos pares no principal, ímpares no segundo
+        FIL *fp = (w->split == LOG_WRITER_STRIPE && (w->writes & 1)) ? w->fp2 : w->fp;
+        UINT bw;
+        fr = f_write(fp, data, len, &bw);
+        if (fr == FR_OK && bw != len) fr = FR_DENIED;   // Cartão cheio
+        if (w->split == LOG_WRITER_MIRROR) {
+            if (f_write(w->fp2, data, len, &bw) != FR_OK || bw != len)
+                w->mirror_errors++;
+        }
+    }
+    uint32_t dt = time_us_32() - t0;
+    PROF_RECORD(PROF_F_WRITE, dt);
+
+    w->writes++;
+    add_busy(w, dt);
+    if (dt > w->max_write_us) w->max_write_us = dt;
+    return fr;
+}
+
+/**
+ * Indica se há buffers cheios aguardando gravação
+ */
+bool log_writer_pending(const log_writer_t *w) {
+    return w->queued != 0;
+}
+
+#if LOG_WRITER_ASYNC
+/**
+ * Modo bruto assíncrono: dispara ou acompanha a gravação via DMA do buffer
+ * cheio mais antigo, sem esperar pelo cartão
+ * @return FR_OK enquanto não houver erro (o buffer só é liberado ao concluir)
+ */
+static FRESULT log_writer_service_async(log_writer_t *w) {
+    const uint32_t n = LOG_WRITER_BUF_SIZE / FF_MIN_SS;
+
+    if (!w->inflight) {
+        if (w->raw_sectors + n > w->raw_capacity)
+            return FR_DENIED;                       // Extensão esgotada
+        uint64_t lba;
+        sd_write_session_is_open(w->sd, &lba);
+        if (sd_write_blocks_async(w->sd, w->buf[w->next], lba, n) != SD_BLOCK_DEVICE_ERROR_NONE)
+            return FR_DISK_ERR;
+        w->inflight = true;
+        w->write_start_us = time_us_32();
+    }
+
+    int rc = sd_write_async_poll(w->sd);
+    if (rc == SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK)
+        return FR_OK;
+
+    uint32_t dt = time_us_32() - w->write_start_us;
+    PROF_RECORD(PROF_F_WRITE, dt);
+    w->inflight = false;
+    w->writes++;
+    add_busy(w, dt);
+    if (dt > w->max_write_us) w->max_write_us = dt;
+    if (rc != SD_BLOCK_DEVICE_ERROR_NONE)
+        return FR_DISK_ERR;
+
+    w->raw_sectors += n;
+    w->next = (w->next + 1) % LOG_WRITER_BUFFERS;
+    w->queued--;
+    return FR_OK;
+}
+#endif
+
+/**
+ * Grava o buffer cheio mais antigo, se houver
+ * No modo bruto assíncrono apenas avança a gravação em andamento; o chamador
+ * continua preenchendo o buffer ativo enquanto o DMA envia os setores
+ */
+FRESULT log_writer_service(log_writer_t *w) {
+    if (!w->queued) return FR_OK;
+#if LOG_WRITER_ASYNC
+    if (w->sd) return log_writer_service_async(w);
+#endif
+
+    FRESULT fr = log_writer_write(w, w->buf[w->next], LOG_WRITER_BUF_SIZE);
+    w->next = (w->next + 1) % LOG_WRITER_BUFFERS;
+    w->queued--;
+    return fr;
+}
+
+/**
+ * Copia os dados para o buffer ativo, trocando de buffer quando ele enche
+ * Se todos os buffers estiverem cheios, grava o mais antigo antes de seguir
+ */
+FRESULT log_writer_append(log_writer_t *w, const void *data, UINT len) {
+    const uint8_t *src = data;
+    w->bytes += len;
+
+    while (len) {
+        UINT n = LOG_WRITER_BUF_SIZE - w->fill;
+        if (n > len) n = len;
+        memcpy(&w->buf[w->active][w->fill], src, n);
+        w->fill += n;
+        src += n;
+        len -= n;
+
+        if (w->fill < LOG_WRITER_BUF_SIZE) break;
+
+        // Buffer completo: entra na fila e o próximo passa a ser o ativo
+        w->queued++;
+        w->active = (w->active + 1) % LOG_WRITER_BUFFERS;
+        w->fill = 0;
+        if (w->queued == LOG_WRITER_BUFFERS)
+            w->stalls++;
+        while (w->queued == LOG_WRITER_BUFFERS) {
+            FRESULT fr = log_writer_service(w);
+            if (fr != FR_OK) return fr;
+        }
+    }
+    return FR_OK;
+}
+
+/**
+ * Grava todos os buffers pendentes e o buffer parcial
+ * Quebra o alinhamento: usar apenas ao encerrar o arquivo
+ * No modo bruto o último setor é completado com zeros e a sessão CMD25 é
+ * encerrada; o tamanho real fica em w->bytes
+ */
+FRESULT log_writer_flush(log_writer_t *w) {
+    FRESULT fr = FR_OK;
+    while (fr == FR_OK && w->queued)
+        fr = log_writer_service(w);
+    if (fr == FR_OK && w->fill) {
+        UINT len = w->fill;
+        if (w->sd) {
+            len = (len + FF_MIN_SS - 1) / FF_MIN_SS * FF_MIN_SS;
+            memset(&w->buf[w->active][w->fill], 0, len - w->fill);
+        }
+        fr = log_writer_write(w, w->buf[w->active], len);
+        w->fill = 0;
+    }
+    if (w->sd) {
+        if (sd_write_session_end(w->sd) != SD_BLOCK_DEVICE_ERROR_NONE && fr == FR_OK)
+            fr = FR_DISK_ERR;
+        w->sd = NULL;
+    }
+    return fr;
+}
+
+/**
+ * Tempo total de gravação no cartão; pode ser lido do outro núcleo
+ */
+uint64_t log_writer_busy_us(const log_writer_t *w) {
+    if (!lock)
+        return 0;
+    uint32_t irq = spin_lock_blocking(lock);
+    uint64_t us = w->busy_us;
+    spin_unlock(lock, irq);
+    return us;
+}
+
+/**
+ * Exibe as estatísticas de gravação no terminal
+ */
+void log_writer_print_stats(const log_writer_t *w) {
+    printf("Gravação: %lu blocos de %u bytes, maior f_write: %lu us, %lu espera(s) por buffer livre\n",
+           (unsigned long)w->writes, LOG_WRITER_BUF_SIZE,
+           (unsigned long)w->max_write_us, (unsigned long)w->stalls);
+    if (w->split == LOG_WRITER_STRIPE)
+        printf("Gravação em faixas: %lu blocos no cartão principal, %lu no segundo\n",
+               (unsigned long)((w->writes + 1) / 2), (unsigned long)(w->writes / 2));
+    if (w->mirror_errors)
+        printf("[AVISO] %lu bloco(s) não gravados no cartão espelho\n", (unsigned long)w->mirror_errors);
+}
@@ -0,0 +1,87 @@
+/*
+ * ================================================================================
+ * GRAVADOR ALINHADO A SETORES
+ * ================================================================================
+ *
+ * Descrição: Acumula os registros em N buffers de k setores e entrega ao
+ *            f_write apenas buffers completos, em deslocamentos múltiplos de
+ *            512 bytes. Assim o FatFs grava direto no cartão (multi-bloco),
+ *            sem o ciclo leitura-modificação-escrita da sua janela, e o buffer
+ *            seguinte continua recebendo amostras.
+ *            No modo de setores brutos os buffers vão direto para uma sessão
+ *            CMD25 aberta sobre uma extensão contígua pré-alocada, sem passar
+ *            pelo FatFs.
+ *            Um segundo arquivo, em outro cartão, pode receber cópia de cada
+ *            buffer (espelho, redundância) ou os buffers alternados
+ *            (faixas, metade do volume em cada cartão).
+ * ================================================================================
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+#include "sd_card.h"
+
+// Setores por buffer e quantidade de buffers (2 = buffer duplo)
+#ifndef LOG_WRITER_SECTORS
+#define LOG_WRITER_SECTORS 8
+#endif
+#ifndef LOG_WRITER_BUFFERS
+#define LOG_WRITER_BUFFERS 2
+#endif
+
+// Modo bruto: gravação dos buffers via DMA, sem bloquear o chamador
+#ifndef LOG_WRITER_ASYNC
+#define LOG_WRITER_ASYNC 1
+#endif
+
+#define LOG_WRITER_BUF_SIZE (LOG_WRITER_SECTORS * FF_MIN_SS)
+
+/**
+ * Uso do segundo arquivo
+ */
+typedef enum {
+    LOG_WRITER_SINGLE,                          // Só o arquivo principal
+    LOG_WRITER_MIRROR,                          // Cada buffer gravado nos dois arquivos
+    LOG_WRITER_STRIPE                           // Buffers alternados: pares no principal, ímpares no segundo
+} log_writer_split_t;
+
+typedef struct {
+    FIL *fp;                                    // Arquivo de destino
+    FIL *fp2;                                   // Segundo arquivo (outro cartão)
+    log_writer_split_t split;                   // Uso do segundo arquivo
+    sd_card_t *sd;                              // Modo setores brutos (NULL = f_write)
+    uint32_t raw_sectors;                       // Setores já gravados na extensão
+    uint32_t raw_capacity;                      // Tamanho da extensão, em setores
+    FSIZE_t bytes;                              // Total de bytes recebidos
+    uint8_t buf[LOG_WRITER_BUFFERS][LOG_WRITER_BUF_SIZE] __attribute__((aligned(4)));
+    uint32_t fill;                              // Bytes no buffer ativo
+    uint8_t active;                             // Buffer sendo preenchido
+    uint8_t queued;                             // Buffers cheios aguardando gravação
+    uint8_t next;                               // Próximo buffer cheio a gravar
+
+    // Estatísticas
+    uint32_t writes;                            // Chamadas f_write realizadas
+    uint32_t stalls;                            // Append sem buffer livre (gravação forçada)
+    uint32_t max_write_us;                      // Maior duração de um f_write
+    uint64_t busy_us;                           // Tempo total de gravação (log_writer_busy_us)
+    bool inflight;                              // Buffer `next` em gravação assíncrona
+    uint32_t write_start_us;                    // Início da gravação assíncrona
+    uint32_t mirror_errors;                     // Falhas no segundo arquivo (modo espelho)
+} log_writer_t;
+
+void log_writer_init(log_writer_t *w, FIL *fp);
+void log_writer_set_second(log_writer_t *w, FIL *fp2, log_writer_split_t split);
+FRESULT log_writer_init_raw(log_writer_t *w, FIL *fp, sd_card_t *sd, LBA_t lba, uint32_t sectors);
+FRESULT log_writer_append(log_writer_t *w, const void *data, UINT len);
+bool log_writer_pending(const log_writer_t *w);
+FRESULT log_writer_service(log_writer_t *w);
+FRESULT log_writer_flush(log_writer_t *w);
+uint64_t log_writer_busy_us(const log_writer_t *w);
+void log_writer_print_stats(const log_writer_t *w);
+
+#endif // LOG_WRITER_H
@@ -0,0 +1,90 @@
+/*
+ * ================================================================================
+ * MODO DE BAIXO CONSUMO E ESTIMATIVA DE CARGA POR AMOSTRA
+ * ================================================================================
+ *
+ * O timer do sistema e o USB não dependem de clk_sys, portanto amostragem e
+ * terminal continuam corretos com o clock reduzido; apenas os periféricos
+ * derivados de clk_peri (I2C, SPI, PWM) precisam ter seus divisores
+ * recalculados pelo chamador após a troca.
+ * ================================================================================
+ */
+
+#include "lowpower.h"
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+static uint32_t normal_khz = 0;                // clk_sys antes da redução
+
+/**
+ * Alterna clk_sys entre LP_SYS_CLOCK_KHZ e o clock original
+ * @return true se o clock foi alterado (recalcular I2C/SPI em seguida)
+ */
+bool lp_set_reduced_clock(bool reduced) {
+    if (!LP_SYS_CLOCK_KHZ)
+        return false;
+    if (reduced) {
+        if (normal_khz)
+            return false;                     // Já reduzido
+        normal_khz = clock_get_hz(clk_sys) / 1000;
+        if (!set_sys_clock_khz(LP_SYS_CLOCK_KHZ, false)) {
+            printf("[AVISO] Clock de %u kHz indisponível; mantendo %lu kHz\n",
+                   LP_SYS_CLOCK_KHZ, (unsigned long)normal_khz);
+            normal_khz = 0;
+            return false;
+        }
+        return true;
+    }
+    if (!normal_khz)
+        return false;
+    set_sys_clock_khz(normal_khz, true);
+    normal_khz = 0;
+    return true;
+}
+
+/**
+ * Marca o início da janela de medição (início da captura)
+ */
+void lp_meter_start(lp_meter_t *m, uint64_t sleep_us, uint64_t sd_busy_us) {
+    m->start_us = time_us_64();
+    m->sleep_us = sleep_us;
+    m->sd_busy_us = sd_busy_us;
+    m->active = true;
+}
+
+/**
+ * Encerra a janela e imprime corrente média, carga por amostra e autonomia
+ * No modo dual-core o núcleo 1 é considerado acordado apenas enquanto grava
+ */
+void lp_meter_report(lp_meter_t *m, uint64_t sleep_us, uint64_t sd_busy_us,
+                     uint32_t samples, bool dual_core, bool display_on) {
+    if (!m->active)
+        return;
+    m->active = false;
+
+    float total = (float)(time_us_64() - m->start_us);
+    if (total <= 0)
+        return;
+    float f_sd = (float)(sd_busy_us - m->sd_busy_us) / total;
+    float f_core0 = 1.0f - (float)(sleep_us - m->sleep_us) / total;
+    float f_core1 = dual_core ? f_sd : 0.0f;
+    if (f_core0 < 0) f_core0 = 0;
+
+    float i_ma = LP_I_BASE_MA + LP_I_MPU_MA
+               + LP_I_CORE_MA * (f_core0 + f_core1)
+               + LP_I_SD_IDLE_MA + (LP_I_SD_WRITE_MA - LP_I_SD_IDLE_MA) * f_sd
+               + (display_on ? LP_I_OLED_MA : 0.0f);
+
+    printf("\n=== Consumo estimado da captura ===\n");
+    printf("Duração: %.1f s | núcleo 0 acordado: %.1f%% | SD gravando: %.2f%%\n",
+           total / 1e6f, f_core0 * 100.0f, f_sd * 100.0f);
+    printf("Corrente média: %.2f mA", i_ma);
+    if (samples) {
+        // mA x s = mC; por amostra em µC
+        float uc = i_ma * (total / 1e6f) * 1000.0f / samples;
+        printf(" | carga por amostra: %.2f uC", uc);
+    }
+    printf("\nAutonomia com %u mAh: %.1f h\n", LP_BATTERY_MAH, LP_BATTERY_MAH / i_ma);
+}
@@ -0,0 +1,53 @@
+/*
+ * ================================================================================
+ * MODO DE BAIXO CONSUMO E ESTIMATIVA DE CARGA POR AMOSTRA
+ * ================================================================================
+ *
+ * Descrição: Reduz o clock do sistema durante a captura e estima a corrente
+ *            média a partir da fração de tempo de cada subsistema (núcleos
+ *            acordados, gravação no SD, display). As correntes são valores
+ *            típicos; calibre-os com uma medição da placa real para
+ *            dimensionar baterias.
+ * ================================================================================
+ */
+
+#ifndef LOWPOWER_H
+#define LOWPOWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// clk_sys durante a captura (0 mantém o clock atual)
+#ifndef LP_SYS_CLOCK_KHZ
+#define LP_SYS_CLOCK_KHZ 48000
+#endif
+
+// Capacidade da bateria para a estimativa de autonomia
+#ifndef LP_BATTERY_MAH
+#define LP_BATTERY_MAH 2000
+#endif
+
+// Modelo de corrente (mA)
+#define LP_I_BASE_MA       4.0f   // Placa com os dois núcleos em __wfe (clocks ativos)
+#define LP_I_CORE_MA       4.0f   // Acréscimo por núcleo executando a 48 MHz
+#define LP_I_MPU_MA        3.9f   // MPU6050 com acelerômetro e giroscópio
+#define LP_I_SD_IDLE_MA    0.5f   // Cartão SD desselecionado em espera
+#define LP_I_SD_WRITE_MA  50.0f   // Cartão SD gravando
+#define LP_I_OLED_MA      10.0f   // SSD1306 ligado (tela típica)
+
+/**
+ * Contadores no início da janela medida
+ */
+typedef struct {
+    uint64_t start_us;
+    uint64_t sleep_us;     // Sono acumulado do núcleo 0 (evt_sleep_us)
+    uint64_t sd_busy_us;   // Tempo de gravação no SD (log_writer_t.busy_us)
+    bool active;
+} lp_meter_t;
+
+bool lp_set_reduced_clock(bool reduced);
+void lp_meter_start(lp_meter_t *m, uint64_t sleep_us, uint64_t sd_busy_us);
+void lp_meter_report(lp_meter_t *m, uint64_t sleep_us, uint64_t sd_busy_us,
+                     uint32_t samples, bool dual_core, bool display_on);
+
+#endif // LOWPOWER_H
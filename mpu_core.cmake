@@ -0,0 +1,11 @@
+# Partes portáteis do registro (sem acesso ao hardware; journal.c e config.c
+# usam só o FatFs): compiladas no firmware e também no PC pela build de host
+# (host/CMakeLists.txt)
+set(MPU_CORE_SOURCES
+        ${CMAKE_CURRENT_LIST_DIR}/attitude.c
+        ${CMAKE_CURRENT_LIST_DIR}/spectrum.c
+        ${CMAKE_CURRENT_LIST_DIR}/trigger.c
+        ${CMAKE_CURRENT_LIST_DIR}/mpu_pack.c
+        ${CMAKE_CURRENT_LIST_DIR}/journal.c
+        ${CMAKE_CURRENT_LIST_DIR}/config.c
+        )
@@ -0,0 +1,292 @@
+/*
+ * ================================================================================
+ * FORMATO BINÁRIO DO REGISTRO DE DADOS DO MPU6050
+ * ================================================================================
+ *
+ * Descrição: Arquivo = cabeçalho de 64 bytes seguido de registros de 16 bytes,
+ *            todos little-endian. Cada registro guarda as leituras brutas do
+ *            sensor e o intervalo desde a amostra anterior; a conversão para
+ *            unidades físicas fica a cargo do decodificador
+ *            (ArquivosDados/PlotaDados.py), usando as escalas do cabeçalho.
+ * ================================================================================
+ */
+
+#ifndef MPU_LOG_H
+#define MPU_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "acquisition.h"
+
+#define FIRMWARE_VERSION   "1.2.0"
+
+#define MPU_LOG_MAGIC      "MPUL"
+#define MPU_LOG_VERSION    2
+
+// Faixas de medida aplicadas aos sensores (MPU6050_ACCEL_* / MPU6050_GYRO_*)
+// As escalas acompanham a faixa: ±2 g e ±250 °/s dão 16384 LSB/g e 131 LSB/(°/s)
+#ifndef MPU_LOG_ACCEL_RANGE
+#define MPU_LOG_ACCEL_RANGE        0
+#endif
+#ifndef MPU_LOG_GYRO_RANGE
+#define MPU_LOG_GYRO_RANGE         0
+#endif
+#define MPU_LOG_ACCEL_LSB_PER_G    (16384.0f / (1 << MPU_LOG_ACCEL_RANGE))
+#define MPU_LOG_GYRO_LSB_PER_DPS   (131.0f / (1 << MPU_LOG_GYRO_RANGE))
+#define MPU_LOG_TEMP_LSB_PER_C     340.0f
+#define MPU_LOG_TEMP_OFFSET_C      36.53f
+
+// Bits de flags do cabeçalho
+#define MPU_LOG_FLAG_EVENT         0x01    // Arquivo de evento (pré/pós-gatilho)
+#define MPU_LOG_FLAG_PACKED        0x02    // Registros comprimidos em blocos (mpu_pack.h)
+#define MPU_LOG_FLAG_DUAL          0x04    // Cada amostra tem um 2º registro (dt = 0) do segundo sensor
+#define MPU_LOG_FLAG_JOURNAL       0x08    // Registros em setores com diário (journal.h)
+
+// Valor de dt que indica intervalo maior que o representável
+#define MPU_LOG_DT_OVERFLOW        0xFFFF
+
+/**
+ * Cabeçalho do arquivo (64 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "MPUL"
+    uint8_t  version;           // MPU_LOG_VERSION
+    uint8_t  header_size;       // sizeof(mpu_log_header_t)
+    uint8_t  record_size;       // sizeof(mpu_log_record_t)
+    uint8_t  flags;             // MPU_LOG_FLAG_*
+    uint32_t sample_rate_hz;    // Taxa de amostragem configurada
+    uint32_t dt_unit_us;        // Resolução do campo dt dos registros
+    uint32_t start_us;          // Instante de referência do primeiro dt (time_us_32)
+    float    accel_lsb_per_g;   // Escala do acelerômetro
+    float    gyro_lsb_per_dps;  // Escala do giroscópio
+    float    temp_lsb_per_c;    // Escala do sensor de temperatura
+    float    temp_offset_c;     // Temperatura = bruto / escala + offset
+    char     firmware[8];       // Versão do firmware que gravou o arquivo
+    int64_t  start_unix_us;     // start_us no relógio do RTC, em µs desde 1970 (0: RTC não ajustado)
+    float    att_tau_s;         // Constante do filtro de atitude (0: sem filtro)
+    uint32_t pre_samples;       // Registros anteriores ao disparo (arquivos de evento)
+    uint16_t block_size;        // Blocos comprimidos: terminam em múltiplos deste valor
+    uint8_t  stripe_sectors;    // Distribuído entre 2 cartões em fatias deste tamanho (0: não)
+    uint8_t  reserved;
+} mpu_log_header_t;
+
+/**
+ * Um registro por amostra (16 bytes, 32 por setor)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t dt;                // Intervalo desde a amostra anterior, em dt_unit_us
+    int16_t  accel[3];          // Aceleração bruta [x, y, z]
+    int16_t  gyro[3];           // Velocidade angular bruta [x, y, z]
+    int16_t  temp;              // Temperatura bruta
+} mpu_log_record_t;
+
+_Static_assert(sizeof(mpu_log_header_t) == 64, "cabeçalho deve ter 64 bytes");
+_Static_assert(sizeof(mpu_log_record_t) == 16, "registro deve ter 16 bytes");
+_Static_assert(sizeof FIRMWARE_VERSION <= 8, "versão não cabe no cabeçalho");
+
+/**
+ * Preenche o cabeçalho para a taxa de amostragem informada
+ * A resolução de dt é escolhida para que 16 períodos caibam em 16 bits
+ */
+static inline void mpu_log_header_init(mpu_log_header_t *h, uint32_t rate_hz, uint32_t start_us) {
+    memset(h, 0, sizeof *h);
+    memcpy(h->magic, MPU_LOG_MAGIC, 4);
+    h->version = MPU_LOG_VERSION;
+    h->header_size = sizeof(mpu_log_header_t);
+    h->record_size = sizeof(mpu_log_record_t);
+    h->sample_rate_hz = rate_hz;
+    h->dt_unit_us = 1 + (1000000u / rate_hz) / 4096u;
+    h->start_us = start_us;
+    h->accel_lsb_per_g = MPU_LOG_ACCEL_LSB_PER_G;
+    h->gyro_lsb_per_dps = MPU_LOG_GYRO_LSB_PER_DPS;
+    h->temp_lsb_per_c = MPU_LOG_TEMP_LSB_PER_C;
+    h->temp_offset_c = MPU_LOG_TEMP_OFFSET_C;
+    strncpy(h->firmware, FIRMWARE_VERSION, sizeof h->firmware);
+}
+
+/**
+ * Converte uma amostra de aquisição em registro
+ * @param last_us Instante reconstruído da amostra anterior; avança apenas o
+ *                que foi gravado em dt, para o arredondamento não acumular
+ */
+static inline void mpu_log_encode(mpu_log_record_t *r, const mpu_sample_t *s,
+                                  uint32_t *last_us, uint32_t dt_unit_us) {
+    int32_t delta = (int32_t)(s->t_us - *last_us);
+    uint32_t dt = delta > 0 ? (uint32_t)delta / dt_unit_us : 0;
+    if (dt >= MPU_LOG_DT_OVERFLOW) {
+        r->dt = MPU_LOG_DT_OVERFLOW;
+        *last_us = s->t_us;
+    } else {
+        r->dt = (uint16_t)dt;
+        *last_us += dt * dt_unit_us;
+    }
+    memcpy(r->accel, s->accel, sizeof r->accel);
+    memcpy(r->gyro, s->gyro, sizeof r->gyro);
+    r->temp = s->temp;
+}
+
+/**
+ * Conversão de LSB para milésimos da unidade (mg, m°/s) sem divisão em ponto
+ * flutuante: v = (raw * mul) >> shift, com 1000 / (LSB por unidade) em
+ * Q(shift). O shift é o maior que mantém mul < 2^31, então a precisão não
+ * depende da faixa; calculada uma vez por captura (mpu_log_scale_init).
+ */
+typedef struct {
+    int32_t mul;
+    uint8_t shift;
+} mpu_log_q_t;
+
+typedef struct {
+    mpu_log_q_t accel;
+    mpu_log_q_t gyro;
+} mpu_log_scale_t;
+
+// Maior linha de mpu_log_format_csv: contador, tempo, 6 eixos, roll, pitch e \n
+#define MPU_LOG_CSV_LINE_MAX 112
+// Colunas de um sensor em mpu_log_put_axes (",-16.000" e ",-2000.000")
+#define MPU_LOG_CSV_AXES_MAX 64
+
+static inline mpu_log_q_t mpu_log_q_init(float lsb_per_unit) {
+    mpu_log_q_t q = {0, 0};
+    float k = 1000.0f / lsb_per_unit;
+    while (q.shift < 40 && k * (float)(1ull << (q.shift + 1)) < 2147483647.0f)
+        q.shift++;
+    q.mul = (int32_t)(k * (float)(1ull << q.shift) + 0.5f);
+    return q;
+}
+
+static inline void mpu_log_scale_init(mpu_log_scale_t *sc, float accel_lsb_per_g,
+                                      float gyro_lsb_per_dps) {
+    sc->accel = mpu_log_q_init(accel_lsb_per_g);
+    sc->gyro = mpu_log_q_init(gyro_lsb_per_dps);
+}
+
+// Leitura bruta em milésimos da unidade, arredondada como o printf: empates
+// (0,0625 g = 1024 LSB em ±2 g) vão para o par
+static inline int32_t mpu_log_q_apply(mpu_log_q_t q, int16_t raw) {
+    int64_t p = (int64_t)raw * q.mul;
+    int64_t half = 1ll << (q.shift - 1);
+    int64_t rem = p & ((half << 1) - 1);
+    int64_t v = p >> q.shift;
+    if (rem > half || (rem == half && (v & 1)))
+        v++;
+    return (int32_t)v;
+}
+
+static inline char *mpu_log_put_u32(char *p, uint32_t v) {
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n)
+        *p++ = tmp[--n];
+    return p;
+}
+
+/**
+ * Escreve v / 10^decimals com `decimals` casas, como "%.Nf" (só inteiros)
+ */
+static inline char *mpu_log_put_fixed(char *p, int32_t v, unsigned decimals) {
+    uint32_t u = (uint32_t)v;
+    if (v < 0) {
+        *p++ = '-';
+        u = 0u - u;
+    }
+    uint32_t d = 1;
+    for (unsigned i = 0; i < decimals; i++)
+        d *= 10;
+    p = mpu_log_put_u32(p, u / d);
+    *p++ = '.';
+    for (u %= d; d > 1; u %= d) {
+        d /= 10;
+        *p++ = (char)('0' + u / d);
+    }
+    return p;
+}
+
+/**
+ * Escreve ",ax,ay,az,gx,gy,gz" em g e °/s com três casas
+ */
+static inline char *mpu_log_put_axes(char *p, const int16_t accel[3], const int16_t gyro[3],
+                                     const mpu_log_scale_t *sc) {
+    for (int i = 0; i < 3; i++) {
+        *p++ = ',';
+        p = mpu_log_put_fixed(p, mpu_log_q_apply(sc->accel, accel[i]), 3);
+    }
+    for (int i = 0; i < 3; i++) {
+        *p++ = ',';
+        p = mpu_log_put_fixed(p, mpu_log_q_apply(sc->gyro, gyro[i]), 3);
+    }
+    return p;
+}
+
+/**
+ * Tempo da amostra desde o início do arquivo (coluna Time do CSV), somado em
+ * segundos e microssegundos a partir dos instantes de 32 bits das amostras:
+ * a volta do time_us_32 não afeta as diferenças e não há divisão de 64 bits
+ */
+typedef struct {
+    uint32_t last_us;           // Instante da amostra anterior (time_us_32)
+    uint32_t s;
+    uint32_t us;                // Fração do segundo, 0 a 999999
+} mpu_log_clock_t;
+
+static inline void mpu_log_clock_init(mpu_log_clock_t *c, uint32_t start_us) {
+    c->last_us = start_us;
+    c->s = 0;
+    c->us = 0;
+}
+
+/**
+ * Avança até o instante da amostra; amostras anteriores à referência (pré-
+ * gatilho) ficam no instante zero, como o dt = 0 dos registros binários
+ */
+static inline void mpu_log_clock_advance(mpu_log_clock_t *c, uint32_t t_us) {
+    int32_t delta = (int32_t)(t_us - c->last_us);
+    if (delta <= 0)
+        return;
+    c->last_us = t_us;
+    c->s += (uint32_t)delta / 1000000u;
+    c->us += (uint32_t)delta % 1000000u;
+    if (c->us >= 1000000u) {
+        c->us -= 1000000u;
+        c->s++;
+    }
+}
+
+/**
+ * Formata uma amostra como linha do CSV em unidades físicas, só com
+ * aritmética inteira (roll e pitch passam a centésimos de grau)
+ * @param t Tempo da amostra (Time, em segundos com seis casas)
+ * @param size Deve ser de pelo menos MPU_LOG_CSV_LINE_MAX
+ * @return Comprimento da linha (sem o terminador), ou 0 se não couber
+ */
+static inline int mpu_log_format_csv(char *buf, size_t size, uint32_t n, const mpu_log_clock_t *t,
+                                     const int16_t accel[3], const int16_t gyro[3],
+                                     const mpu_log_scale_t *sc, float roll, float pitch) {
+    if (size < MPU_LOG_CSV_LINE_MAX) {
+        if (size)
+            buf[0] = '\0';
+        return 0;
+    }
+    char *p = mpu_log_put_u32(buf, n);
+    *p++ = ',';
+    p = mpu_log_put_u32(p, t->s);
+    *p++ = '.';
+    for (uint32_t d = 100000u, u = t->us; d; u %= d, d /= 10)
+        *p++ = (char)('0' + u / d);
+    p = mpu_log_put_axes(p, accel, gyro, sc);
+    *p++ = ',';
+    p = mpu_log_put_fixed(p, (int32_t)(roll * 100.0f + (roll < 0.0f ? -0.5f : 0.5f)), 2);
+    *p++ = ',';
+    p = mpu_log_put_fixed(p, (int32_t)(pitch * 100.0f + (pitch < 0.0f ? -0.5f : 0.5f)), 2);
+    *p++ = '\n';
+    *p = '\0';
+    return (int)(p - buf);
+}
+
+#endif // MPU_LOG_H
@@ -0,0 +1,131 @@
+/*
+ * ================================================================================
+ * COMPRESSÃO SEM PERDAS DOS REGISTROS DO MPU6050
+ * ================================================================================
+ *
+ * As diferenças são tomadas módulo 2^16, de modo que cabem em int16 e o
+ * varint nunca passa de 3 bytes por campo. Registros em que a codificação
+ * diferencial sairia maior que os próprios campos são gravados brutos.
+ * ================================================================================
+ */
+
+#include "mpu_pack.h"
+
+#include <string.h>
+
+#define HDR_SIZE 4                     // u16 registros + u16 bytes úteis
+
+static inline uint32_t zigzag(int16_t d) {
+    return ((uint32_t)(int32_t)d << 1) ^ (uint32_t)((int32_t)d >> 31);
+}
+
+static inline uint32_t put_varint(uint8_t *dst, uint32_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80) {
+        dst[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    dst[n++] = (uint8_t)v;
+    return n;
+}
+
+static void start_block(mpu_pack_t *p, uint32_t size) {
+    p->active ^= 1;                    // O bloco anterior continua válido para o chamador
+    p->limit = size;
+    p->pos = HDR_SIZE;
+    p->count = 0;
+}
+
+/**
+ * Prepara o compressor
+ * @param first_block_size Tamanho do primeiro bloco; use o que falta para a
+ *        fronteira de setor após o cabeçalho do arquivo
+ */
+void mpu_pack_init(mpu_pack_t *p, uint32_t first_block_size) {
+    p->active = 1;
+    start_block(p, first_block_size);
+    p->raw_bytes = 0;
+    p->packed_bytes = 0;
+}
+
+// Fecha o bloco atual completando com zeros
+static const uint8_t *close_block(mpu_pack_t *p, uint32_t *len) {
+    uint8_t *b = p->block[p->active];
+    uint16_t used = (uint16_t)p->pos;
+    memcpy(&b[0], &p->count, 2);
+    memcpy(&b[2], &used, 2);
+    memset(&b[p->pos], 0, p->limit - p->pos);
+    *len = p->limit;
+    p->packed_bytes += p->limit;
+    return b;
+}
+
+// Codifica rec em relação a p->prev; devolve o tamanho
+static uint32_t encode_delta(const mpu_pack_t *p, const mpu_log_record_t *rec, uint8_t *dst) {
+    // Campos após dt (accel, gyro, temp), copiados do registro empacotado
+    enum { FIELDS = (sizeof(mpu_log_record_t) - 2) / 2 };
+    int16_t cur[FIELDS], old[FIELDS];
+    memcpy(cur, (const uint8_t *)rec + 2, sizeof cur);
+    memcpy(old, (const uint8_t *)&p->prev + 2, sizeof old);
+    uint32_t dt = zigzag((int16_t)(rec->dt - p->prev.dt)) << 1;
+
+    uint8_t tmp[3 * (FIELDS + 1)];
+    uint32_t n = put_varint(tmp, dt);
+    for (uint32_t i = 0; i < FIELDS; i++)
+        n += put_varint(&tmp[n], zigzag((int16_t)(cur[i] - old[i])));
+
+    if (n <= MPU_PACK_MAX_RECORD) {
+        memcpy(dst, tmp, n);
+        return n;
+    }
+    n = put_varint(dst, dt | 1);
+    memcpy(&dst[n], cur, sizeof cur);
+    return n + sizeof cur;
+}
+
+/**
+ * Acrescenta um registro
+ * @param len Tamanho do bloco devolvido
+ * @return Bloco completo a gravar, ou NULL se o registro coube no bloco atual
+ *         (o ponteiro vale até a próxima chamada)
+ */
+const uint8_t *mpu_pack_push(mpu_pack_t *p, const mpu_log_record_t *rec, uint32_t *len) {
+    const uint8_t *out = NULL;
+    p->raw_bytes += sizeof *rec;
+
+    uint8_t enc[MPU_PACK_MAX_RECORD];
+    uint32_t n = 0;
+    if (p->count)
+        n = encode_delta(p, rec, enc);
+    if (p->count && p->pos + n > p->limit) {
+        out = close_block(p, len);
+        start_block(p, MPU_PACK_BLOCK_SIZE);
+    }
+
+    uint8_t *b = p->block[p->active];
+    if (!p->count) {
+        // Registro inicial do bloco, completo
+        memcpy(&b[p->pos], rec, sizeof *rec);
+        p->pos += sizeof *rec;
+    } else {
+        memcpy(&b[p->pos], enc, n);
+        p->pos += n;
+    }
+    p->count++;
+    p->prev = *rec;
+    return out;
+}
+
+/**
+ * Fecha o bloco em andamento ao fim da captura
+ * @return Último bloco, ou NULL se não restou nenhum registro
+ */
+const uint8_t *mpu_pack_finish(mpu_pack_t *p, uint32_t *len) {
+    if (!p->count) {
+        *len = 0;
+        return NULL;
+    }
+    const uint8_t *out = close_block(p, len);
+    start_block(p, MPU_PACK_BLOCK_SIZE);
+    return out;
+}
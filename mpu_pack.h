@@ -0,0 +1,46 @@
+/*
+ * ================================================================================
+ * COMPRESSÃO SEM PERDAS DOS REGISTROS DO MPU6050
+ * ================================================================================
+ *
+ * Descrição: Agrupa os registros de 16 bytes (mpu_log.h) em blocos que
+ *            terminam em fronteiras de setor. Cada bloco começa com um
+ *            registro completo e segue com as diferenças campo a campo em
+ *            relação ao registro anterior, em varints zigzag; assim cada
+ *            bloco é decodificado sozinho.
+ *
+ *            Bloco: u16 registros, u16 bytes úteis, registro inicial de
+ *            16 bytes e, por registro seguinte, varint(zz(Δdt) << 1 | bruto)
+ *            seguido de 7 varints zz(Δcampo) ou, se bruto = 1, dos 14 bytes
+ *            dos campos. O restante do bloco é preenchido com zeros.
+ * ================================================================================
+ */
+
+#ifndef MPU_PACK_H
+#define MPU_PACK_H
+
+#include <stdint.h>
+
+#include "mpu_log.h"
+
+#define MPU_PACK_BLOCK_SIZE   512     // Blocos terminam em múltiplos de setor
+
+// Pior caso por registro: varint de 3 bytes + 14 bytes brutos
+#define MPU_PACK_MAX_RECORD   (3 + sizeof(mpu_log_record_t) - 2)
+
+typedef struct {
+    uint8_t block[2][MPU_PACK_BLOCK_SIZE] __attribute__((aligned(4))); // Em montagem e entregue
+    uint8_t active;                    // Bloco em montagem
+    uint32_t limit;                    // Tamanho do bloco atual
+    uint32_t pos;                      // Bytes ocupados no bloco
+    uint16_t count;                    // Registros no bloco
+    mpu_log_record_t prev;             // Último registro codificado
+    uint64_t raw_bytes;                // Bytes que seriam gravados sem compressão
+    uint64_t packed_bytes;             // Bytes entregues em blocos
+} mpu_pack_t;
+
+void mpu_pack_init(mpu_pack_t *p, uint32_t first_block_size);
+const uint8_t *mpu_pack_push(mpu_pack_t *p, const mpu_log_record_t *rec, uint32_t *len);
+const uint8_t *mpu_pack_finish(mpu_pack_t *p, uint32_t *len);
+
+#endif // MPU_PACK_H
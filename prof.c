@@ -0,0 +1,135 @@
+/*
+ * ================================================================================
+ * INSTRUMENTAÇÃO DOS CAMINHOS CRÍTICOS
+ * ================================================================================
+ *
+ * O Cortex-M0+ do RP2040 não tem contador de ciclos (DWT); os cronômetros
+ * usam o timer de 1 MHz, suficiente para os trechos medidos (de dezenas de
+ * microssegundos a centenas de milissegundos).
+ * ================================================================================
+ */
+
+#include "prof.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if PROF_ENABLED
+
+static const char *const timer_names[PROF_NUM_TIMERS] = {
+    [PROF_MPU_READ] = "Leitura do MPU6050",
+    [PROF_FORMAT]   = "Formatação do registro",
+    [PROF_F_WRITE]  = "Gravação de bloco",
+    [PROF_F_SYNC]   = "f_sync",
+    [PROF_DISPLAY]  = "Envio ao display",
+    [PROF_SD_WAIT]  = "Espera do cartão",
+};
+
+static const char *const counter_names[PROF_NUM_COUNTERS] = {
+    [PROF_SD_CRC_ERRORS] = "Erros de CRC no SD",
+    [PROF_SD_RETRIES]    = "Repetições de transferência no SD",
+};
+
+static volatile prof_timer_t timers[PROF_NUM_TIMERS];
+static volatile uint32_t counters[PROF_NUM_COUNTERS];
+
+/**
+ * Marco do boot: nome (literal) e instante desde o reset
+ */
+typedef struct {
+    const char *name;
+    uint32_t t_us;
+} prof_mark_t;
+
+static prof_mark_t marks[PROF_MAX_MARKS];
+static uint32_t n_marks;
+
+/**
+ * Acumula uma medida no cronômetro
+ */
+void prof_record(prof_timer_id_t id, uint32_t dt_us) {
+    volatile prof_timer_t *t = &timers[id];
+    if (!t->count || dt_us < t->min_us) t->min_us = dt_us;
+    if (dt_us > t->max_us) t->max_us = dt_us;
+    t->sum_us += dt_us;
+    t->count++;
+
+    uint32_t bin = dt_us ? 32u - (uint32_t)__builtin_clz(dt_us) : 0;
+    if (bin >= PROF_HIST_BINS) bin = PROF_HIST_BINS - 1;
+    t->hist[bin]++;
+}
+
+void prof_count(prof_counter_id_t id) {
+    counters[id]++;
+}
+
+/**
+ * Registra o fim de uma etapa do boot; o timer começa em zero no reset
+ * @param name Texto estático (apenas o ponteiro é guardado)
+ */
+void prof_mark(const char *name) {
+    if (n_marks < PROF_MAX_MARKS)
+        marks[n_marks++] = (prof_mark_t){name, time_us_32()};
+}
+
+/**
+ * Exibe os marcos do boot com o instante e a duração de cada etapa
+ */
+void prof_print_marks(void) {
+    uint32_t prev = 0;
+    printf("%-24s %8s %8s\n", "Boot", "ms", "etapa ms");
+    for (uint32_t i = 0; i < n_marks; i++) {
+        printf("%-24s %8lu %8lu\n", marks[i].name, (unsigned long)(marks[i].t_us / 1000),
+               (unsigned long)((marks[i].t_us - prev) / 1000));
+        prev = marks[i].t_us;
+    }
+}
+
+void prof_reset(void) {
+    memset((void *)timers, 0, sizeof timers);
+    memset((void *)counters, 0, sizeof counters);
+}
+
+/**
+ * Exibe os cronômetros com medidas, o histograma de cada um (apenas as
+ * faixas ocupadas, pelo limite superior) e os contadores
+ */
+void prof_print(void) {
+    printf("%-24s %8s %8s %8s %8s\n", "Trecho", "n", "mín us", "méd us", "máx us");
+    for (int i = 0; i < PROF_NUM_TIMERS; i++) {
+        prof_timer_t t = timers[i];
+        if (!t.count) {
+            printf("%-24s %8s\n", timer_names[i], "-");
+            continue;
+        }
+        printf("%-24s %8lu %8lu %8lu %8lu\n", timer_names[i], (unsigned long)t.count,
+               (unsigned long)t.min_us, (unsigned long)(t.sum_us / t.count),
+               (unsigned long)t.max_us);
+        printf("    ");
+        for (int k = 0; k < PROF_HIST_BINS; k++) {
+            if (!t.hist[k]) continue;
+            if (k == PROF_HIST_BINS - 1)
+                printf(" >=%lu:%lu", 1ul << (k - 1), (unsigned long)t.hist[k]);
+            else
+                printf(" <%lu:%lu", 1ul << k, (unsigned long)t.hist[k]);
+        }
+        printf("\n");
+    }
+    for (int i = 0; i < PROF_NUM_COUNTERS; i++)
+        printf("%-34s %lu\n", counter_names[i], (unsigned long)counters[i]);
+    prof_print_marks();
+}
+
+#else
+
+void prof_reset(void) {
+}
+
+void prof_print(void) {
+    printf("Instrumentação desabilitada (compile com PROF_ENABLED=1)\n");
+}
+
+void prof_print_marks(void) {
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * ================================================================================
+ * INSTRUMENTAÇÃO DOS CAMINHOS CRÍTICOS
+ * ================================================================================
+ *
+ * Descrição: Cronômetros em microssegundos (mínimo, máximo, média e
+ *            histograma em potências de 2) nos trechos que disputam o tempo
+ *            da captura, e contadores de falhas do cartão, exibidos pelo
+ *            comando "stats", e os marcos do boot (instante de cada etapa
+ *            desde o reset). Com PROF_ENABLED=0 as macros não geram código.
+ * ================================================================================
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED 1
+#endif
+
+// Faixa k do histograma: de 2^(k-1) a 2^k - 1 us (faixa 0: abaixo de 1 us);
+// a última acumula tudo acima de ~0,5 s
+#define PROF_HIST_BINS 20
+
+// Etapas do boot registradas (as seguintes são ignoradas)
+#define PROF_MAX_MARKS 12
+
+/**
+ * Trechos cronometrados
+ */
+typedef enum {
+    PROF_MPU_READ,         // Leitura do sensor na interrupção da aquisição
+    PROF_FORMAT,           // Conversão da amostra em registro (binário ou snprintf)
+    PROF_F_WRITE,          // Gravação de um bloco (f_write ou setores brutos)
+    PROF_F_SYNC,           // f_sync do arquivo de dados
+    PROF_DISPLAY,          // Envio do quadro ao display (ssd1306_send_data)
+    PROF_SD_WAIT,          // sd_wait_ready: espera pelo cartão ocupado
+    PROF_NUM_TIMERS
+} prof_timer_id_t;
+
+/**
+ * Contadores de ocorrências
+ */
+typedef enum {
+    PROF_SD_CRC_ERRORS,    // Transferências com erro de CRC
+    PROF_SD_RETRIES,       // Transferências repetidas após erro
+    PROF_NUM_COUNTERS
+} prof_counter_id_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[PROF_HIST_BINS];
+} prof_timer_t;
+
+#if PROF_ENABLED
+#include "hardware/timer.h"
+
+void prof_record(prof_timer_id_t id, uint32_t dt_us);
+void prof_count(prof_counter_id_t id);
+void prof_mark(const char *name);
+
+// Cada cronômetro é atualizado por um único contexto por vez (interrupção
+// da aquisição, núcleo do gravador ou laço principal), sem trava
+#define PROF_START(t)          uint32_t t = time_us_32()
+#define PROF_STOP(id, t)       prof_record((id), time_us_32() - (t))
+#define PROF_RECORD(id, dt_us) prof_record((id), (dt_us))
+#define PROF_COUNT(id)         prof_count(id)
+#define PROF_MARK(name)        prof_mark(name)
+#else
+#define PROF_START(t)          ((void)0)
+#define PROF_STOP(id, t)       ((void)0)
+#define PROF_RECORD(id, dt_us) ((void)0)
+#define PROF_COUNT(id)         ((void)0)
+#define PROF_MARK(name)        ((void)0)
+#endif
+
+void prof_reset(void);
+void prof_print(void);
+void prof_print_marks(void);
+
+#endif // PROF_H
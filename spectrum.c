@@ -0,0 +1,239 @@
+/*
+ * ================================================================================
+ * ESPECTRO DE VIBRAÇÃO EM JANELAS
+ * ================================================================================
+ *
+ * A janela real de N pontos é tratada como N/2 pontos complexos
+ * (pares em re, ímpares em im), transformada por uma FFT radix-2 em Q15 com
+ * divisão por 2 a cada estágio e separada no espectro real no fim. A saída
+ * fica na escala X[k] / N; antes da FFT a janela é normalizada para ocupar
+ * metade da faixa de 16 bits (ponto flutuante em bloco), e o deslocamento é
+ * descontado no cálculo dos RMS.
+ * ================================================================================
+ */
+
+#include "spectrum.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "mpu_log.h"
+
+#if (SPEC_FFT_N & (SPEC_FFT_N - 1)) != 0 || SPEC_FFT_N < 16
+#error "SPEC_FFT_N deve ser potência de 2 (mínimo 16)"
+#endif
+#if SPEC_FFT_N % SPEC_HOP != 0
+#error "SPEC_HOP deve dividir SPEC_FFT_N"
+#endif
+#if (SPEC_FFT_N / 2) % SPEC_BANDS != 0
+#error "SPEC_BANDS deve dividir SPEC_FFT_N / 2"
+#endif
+
+#define M       (SPEC_FFT_N / 2)               // Pontos da FFT complexa
+#define BAND_W  (M / SPEC_BANDS)               // Bins por faixa
+
+// Unidades dos campos do registro
+#define SPEC_UNIT_MG 0.1f
+#define SPEC_UNIT_HZ 0.1f
+
+// Potência média da janela de Hann (3/8), compensada nos RMS
+#define HANN_POWER 0.375f
+
+static int16_t hann[SPEC_FFT_N];               // Janela em Q15
+static int16_t cos_t[M + 1], sin_t[M + 1];     // W_N^k = cos - j sin, k = 0..N/2
+static bool tables_ready = false;
+
+static void build_tables(void) {
+    const float w = 6.28318531f / SPEC_FFT_N;
+    for (int n = 0; n < SPEC_FFT_N; n++)
+        hann[n] = (int16_t)(32767.0f * 0.5f * (1.0f - cosf(w * n)));
+    for (int k = 0; k <= M; k++) {
+        cos_t[k] = (int16_t)lroundf(32767.0f * cosf(w * k));
+        sin_t[k] = (int16_t)lroundf(32767.0f * sinf(w * k));
+    }
+    tables_ready = true;
+}
+
+/**
+ * Reinicia a análise (descarta a janela em andamento)
+ */
+void spec_init(spec_t *sp, uint32_t rate_hz, float accel_lsb_per_g) {
+    if (!tables_ready)
+        build_tables();
+    memset(sp, 0, sizeof *sp);
+    sp->rate_hz = rate_hz;
+    sp->accel_lsb_per_g = accel_lsb_per_g;
+}
+
+/**
+ * Preenche o cabeçalho do arquivo de espectro
+ */
+void spec_header_init(spec_header_t *h, const spec_t *sp, uint32_t start_us) {
+    memset(h, 0, sizeof *h);
+    memcpy(h->magic, SPEC_MAGIC, 4);
+    h->version = SPEC_VERSION;
+    h->header_size = sizeof(spec_header_t);
+    h->record_size = sizeof(spec_record_t);
+    h->axis = SPEC_AXIS;
+    h->fft_n = SPEC_FFT_N;
+    h->hop = SPEC_HOP;
+    h->bands = SPEC_BANDS;
+    h->window = SPEC_WINDOW_HANN;
+    h->sample_rate_hz = sp->rate_hz;
+    h->start_us = start_us;
+    h->unit_mg = SPEC_UNIT_MG;
+    h->unit_hz = SPEC_UNIT_HZ;
+    strncpy(h->firmware, FIRMWARE_VERSION, sizeof h->firmware);
+}
+
+// Produto Q15 com arredondamento
+static inline int32_t q15_mul(int32_t a, int32_t b) {
+    return (a * b + (1 << 14)) >> 15;
+}
+
+/**
+ * FFT complexa de M pontos in-place, decimação no tempo, escala 1/M
+ */
+static void fft_q15(int16_t *re, int16_t *im) {
+    // Reordenação por inversão de bits
+    for (uint32_t i = 1, j = 0; i < M; i++) {
+        uint32_t bit = M >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if (i < j) {
+            int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (uint32_t len = 2; len <= M; len <<= 1) {
+        uint32_t half = len >> 1;
+        uint32_t step = SPEC_FFT_N / len;      // W_len^i = W_N^(i * step)
+        for (uint32_t i = 0; i < M; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                int32_t c = cos_t[k * step], s = sin_t[k * step];
+                uint32_t a = i + k, b = a + half;
+                int32_t tr = q15_mul(re[b], c) + q15_mul(im[b], s);
+                int32_t ti = q15_mul(im[b], c) - q15_mul(re[b], s);
+                int32_t ar = re[a], ai = im[a];
+                re[a] = (int16_t)((ar + tr) >> 1);
+                im[a] = (int16_t)((ai + ti) >> 1);
+                re[b] = (int16_t)((ar - tr) >> 1);
+                im[b] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+static inline uint16_t clamp_u16(float v) {
+    return v >= 65535.0f ? 65535 : (uint16_t)(v + 0.5f);
+}
+
+/**
+ * Analisa a janela atual e preenche o registro
+ */
+static void analyze(spec_t *sp, spec_record_t *out) {
+    uint32_t t0 = time_us_32();
+    uint32_t first = sp->count - SPEC_FFT_N;   // Primeira amostra da janela
+
+    // Média e variância (RMS sem o valor médio) no domínio do tempo
+    int32_t sum = 0;
+    for (int n = 0; n < SPEC_FFT_N; n++)
+        sum += sp->ring[n];
+    int32_t mean = sum / SPEC_FFT_N;
+    uint64_t sq = 0;
+    for (int n = 0; n < SPEC_FFT_N; n++) {
+        int32_t d = sp->ring[n] - mean;
+        sq += (uint64_t)((int64_t)d * d);
+    }
+
+    // Janela de Hann, em ordem cronológica, com a média removida
+    int32_t peak_abs = 0;
+    for (int n = 0; n < SPEC_FFT_N; n++) {
+        int32_t d = sp->ring[(first + n) % SPEC_FFT_N] - mean;
+        if (d > 32767) d = 32767;
+        if (d < -32767) d = -32767;
+        int32_t v = q15_mul(d, hann[n]);
+        if (n & 1) sp->im[n >> 1] = (int16_t)v; else sp->re[n >> 1] = (int16_t)v;
+        int32_t a = v < 0 ? -v : v;
+        if (a > peak_abs) peak_abs = a;
+    }
+
+    // Ponto flutuante em bloco: amplia até a metade da faixa
+    int shift = 0;
+    while (peak_abs && (peak_abs << (shift + 1)) < 16384)
+        shift++;
+    if (shift) {
+        for (int i = 0; i < M; i++) {
+            sp->re[i] = (int16_t)(sp->re[i] << shift);
+            sp->im[i] = (int16_t)(sp->im[i] << shift);
+        }
+    }
+
+    fft_q15(sp->re, sp->im);
+
+    // Separa o espectro real: X[k] = (Z[k] + Z*[M-k]) / 2 + W^k (Z[k] - Z*[M-k]) / 2j
+    uint32_t best = 1;
+    for (uint32_t k = 1; k <= M; k++) {
+        uint32_t a = k % M, b = (M - k) % M;
+        int32_t er = (sp->re[a] + sp->re[b]) >> 1;
+        int32_t ei = (sp->im[a] - sp->im[b]) >> 1;
+        int32_t or_ = (sp->im[a] + sp->im[b]) >> 1;
+        int32_t oi = -((sp->re[a] - sp->re[b]) >> 1);
+        int32_t c = cos_t[k], s = sin_t[k];
+        int32_t xr = ((er + q15_mul(or_, c) + q15_mul(oi, s)) >> 1);
+        int32_t xi = ((ei + q15_mul(oi, c) - q15_mul(or_, s)) >> 1);
+        sp->power[k] = (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+        if (sp->power[k] > sp->power[best])
+            best = k;
+    }
+
+    // RMS por faixa (Parseval): bins 1..N/2-1 contam duas vezes (espectro bilateral)
+    const float lsb_to_unit = 1000.0f / sp->accel_lsb_per_g / SPEC_UNIT_MG;
+    const float fft_scale = lsb_to_unit / (float)(1 << shift);
+    for (int b = 0; b < SPEC_BANDS; b++) {
+        uint64_t e = 0;
+        for (uint32_t k = 1 + b * BAND_W; k < 1 + (b + 1) * BAND_W; k++)
+            e += (uint64_t)sp->power[k] * (k == M ? 1 : 2);
+        out->band[b] = clamp_u16(sqrtf((float)e / HANN_POWER) * fft_scale);
+    }
+    out->rms = clamp_u16(sqrtf((float)sq / SPEC_FFT_N) * lsb_to_unit);
+
+    // Pico com interpolação parabólica entre os bins vizinhos
+    float delta = 0.0f;
+    if (best > 1 && best < M) {
+        float y0 = sqrtf((float)sp->power[best - 1]);
+        float y1 = sqrtf((float)sp->power[best]);
+        float y2 = sqrtf((float)sp->power[best + 1]);
+        float den = y0 - 2.0f * y1 + y2;
+        if (den < 0.0f)
+            delta = 0.5f * (y0 - y2) / den;
+    }
+    float bin_hz = (float)sp->rate_hz / SPEC_FFT_N;
+    out->peak = sp->power[best] ? clamp_u16((best + delta) * bin_hz / SPEC_UNIT_HZ) : 0;
+    out->t_us = sp->t_block[(first / SPEC_HOP) % (SPEC_FFT_N / SPEC_HOP)];
+
+    sp->windows++;
+    uint32_t dt = time_us_32() - t0;
+    if (dt > sp->max_us)
+        sp->max_us = dt;
+}
+
+/**
+ * Acrescenta uma amostra; a cada SPEC_HOP amostras (com a janela cheia)
+ * analisa as últimas SPEC_FFT_N
+ * @return true se out recebeu o resumo de uma nova janela
+ */
+bool spec_push(spec_t *sp, const mpu_sample_t *s, spec_record_t *out) {
+    if (sp->count % SPEC_HOP == 0)
+        sp->t_block[(sp->count / SPEC_HOP) % (SPEC_FFT_N / SPEC_HOP)] = s->t_us;
+    sp->ring[sp->count % SPEC_FFT_N] = s->accel[SPEC_AXIS];
+    sp->count++;
+
+    if (sp->count < SPEC_FFT_N || sp->count % SPEC_HOP != 0)
+        return false;
+    analyze(sp, out);
+    return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * ================================================================================
+ * ESPECTRO DE VIBRAÇÃO EM JANELAS
+ * ================================================================================
+ *
+ * Descrição: FFT real em ponto fixo (Q15, radix-2) sobre janelas de Hann de um
+ *            eixo do acelerômetro, calculada à medida que as amostras chegam.
+ *            Cada janela vira um registro compacto com RMS, frequência de pico
+ *            e RMS por faixa de frequência, gravado no lugar (ou ao lado) das
+ *            amostras brutas.
+ * ================================================================================
+ */
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acquisition.h"
+
+// Tamanho da janela da FFT (potência de 2)
+#ifndef SPEC_FFT_N
+#define SPEC_FFT_N 256
+#endif
+
+// Amostras novas entre janelas consecutivas (N/2 = 50% de sobreposição)
+#ifndef SPEC_HOP
+#define SPEC_HOP (SPEC_FFT_N / 2)
+#endif
+
+// Faixas de mesma largura entre o primeiro bin e Nyquist
+#ifndef SPEC_BANDS
+#define SPEC_BANDS 8
+#endif
+
+// Eixo analisado: 0 = X, 1 = Y, 2 = Z
+#ifndef SPEC_AXIS
+#define SPEC_AXIS 2
+#endif
+
+#define SPEC_MAGIC      "MPUS"
+#define SPEC_VERSION    1
+#define SPEC_WINDOW_HANN 1
+
+/**
+ * Cabeçalho do arquivo de espectro (64 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "MPUS"
+    uint8_t  version;           // SPEC_VERSION
+    uint8_t  header_size;       // sizeof(spec_header_t)
+    uint8_t  record_size;       // sizeof(spec_record_t)
+    uint8_t  axis;              // Eixo do acelerômetro analisado
+    uint16_t fft_n;             // Amostras por janela
+    uint16_t hop;               // Amostras entre janelas
+    uint8_t  bands;             // Faixas por registro
+    uint8_t  window;            // SPEC_WINDOW_HANN
+    uint16_t reserved0;
+    uint32_t sample_rate_hz;    // Taxa de amostragem configurada
+    uint32_t start_us;          // Instante de referência (time_us_32)
+    float    unit_mg;           // Valor de um LSB dos campos de RMS, em mg
+    float    unit_hz;           // Valor de um LSB de peak, em Hz
+    char     firmware[16];      // Versão do firmware que gravou o arquivo
+    uint8_t  reserved[16];
+} spec_header_t;
+
+/**
+ * Resumo de uma janela
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t t_us;              // Instante da primeira amostra da janela
+    uint16_t rms;               // RMS sem a média (valor médio), em unit_mg
+    uint16_t peak;              // Frequência do maior pico, em unit_hz
+    uint16_t band[SPEC_BANDS];  // RMS por faixa, em unit_mg
+} spec_record_t;
+
+_Static_assert(sizeof(spec_header_t) == 64, "cabeçalho deve ter 64 bytes");
+
+/**
+ * Estado da análise: últimas SPEC_FFT_N amostras do eixo e área de trabalho
+ */
+typedef struct {
+    int16_t ring[SPEC_FFT_N];                  // Janela deslizante
+    uint32_t t_block[SPEC_FFT_N / SPEC_HOP];   // Instante do início de cada bloco
+    uint32_t count;                            // Amostras recebidas
+    uint32_t rate_hz;
+    float accel_lsb_per_g;                     // Escala do acelerômetro na faixa em uso
+    int16_t re[SPEC_FFT_N / 2];                // FFT complexa de N/2 pontos
+    int16_t im[SPEC_FFT_N / 2];
+    uint32_t power[SPEC_FFT_N / 2 + 1];        // |X[k]|² na escala da FFT
+    uint32_t windows;                          // Janelas analisadas
+    uint32_t max_us;                           // Maior tempo de cálculo de uma janela
+} spec_t;
+
+void spec_init(spec_t *sp, uint32_t rate_hz, float accel_lsb_per_g);
+void spec_header_init(spec_header_t *h, const spec_t *sp, uint32_t start_us);
+bool spec_push(spec_t *sp, const mpu_sample_t *s, spec_record_t *out);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,108 @@
+/*
+ * ================================================================================
+ * TELEMETRIA BINÁRIA PELA USB
+ * ================================================================================
+ *
+ * Buffer circular de um produtor (consumidor da aquisição, em qualquer
+ * núcleo) e um consumidor (laço principal). O envio só acontece quando o
+ * buffer do terminal (console.h) tem espaço para o quadro inteiro, de modo
+ * que console_write não espera pelo computador.
+ * ================================================================================
+ */
+
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+
+#include "console.h"
+#include "events.h"
+#include "xfer.h"
+
+#define TLM_FRAME_BYTES (XFER_FRAME_OVERHEAD + sizeof(tlm_payload_t))
+
+_Static_assert((TLM_RING_SIZE & (TLM_RING_SIZE - 1)) == 0, "TLM_RING_SIZE deve ser potência de 2");
+
+static mpu_sample_t ring[TLM_RING_SIZE];
+static volatile uint32_t head = 0;         // Escrito só pelo produtor
+static volatile uint32_t tail = 0;         // Escrito só pelo laço principal
+static volatile bool enabled = false;
+
+static uint32_t sent = 0;                  // Quadros enviados
+static uint32_t dropped = 0;               // Descartadas sem terminal (laço principal)
+static volatile uint32_t overflow = 0;     // Descartadas com o buffer cheio (produtor)
+static uint32_t overflow_base = 0;         // overflow ao zerar as estatísticas
+
+/**
+ * Liga ou desliga o envio; descarta o que estava pendente e, ao ligar,
+ * zera as estatísticas
+ */
+void tlm_set_enabled(bool on) {
+    enabled = false;
+    tail = head;
+    if (on) {
+        sent = 0;
+        dropped = 0;
+        overflow_base = overflow;
+    }
+    enabled = on;
+}
+
+bool tlm_is_enabled(void) {
+    return enabled;
+}
+
+/**
+ * Enfileira uma amostra para envio (chamada pelo consumidor da aquisição)
+ */
+void tlm_push(const mpu_sample_t *s) {
+    if (!enabled)
+        return;
+    uint32_t h = head;
+    if (h - tail >= TLM_RING_SIZE) {
+        overflow++;
+        return;
+    }
+    ring[h & (TLM_RING_SIZE - 1)] = *s;
+    __dmb();
+    head = h + 1;
+    if ((h + 1) % TLM_BATCH == 0)
+        evt_post(EVT_TELEMETRY, 0);
+}
+
+/**
+ * Envia as amostras pendentes enquanto houver espaço no buffer da USB
+ * Sem terminal aberto no computador as amostras são apenas descartadas.
+ */
+void tlm_service(void) {
+    if (!enabled)
+        return;
+    uint32_t t = tail, h = head;
+    if (!tud_cdc_connected()) {
+        dropped += h - t;
+        tail = h;
+        return;
+    }
+    while (t != h && console_tx_free() >= TLM_FRAME_BYTES) {
+        const mpu_sample_t *s = &ring[t & (TLM_RING_SIZE - 1)];
+        tlm_payload_t p;
+        p.t_us = s->t_us;
+        memcpy(p.accel, s->accel, sizeof p.accel);
+        memcpy(p.gyro, s->gyro, sizeof p.gyro);
+        p.temp = s->temp;
+        uint32_t seq = s->seq;
+        __dmb();
+        tail = ++t;
+        xfer_send_frame(XFER_FRAME_TELEMETRY, seq, &p, sizeof p);
+        sent++;
+    }
+}
+
+void tlm_print_stats(void) {
+    printf("Telemetria: %lu quadros enviados, %lu descartados\n",
+           (unsigned long)sent, (unsigned long)(dropped + overflow - overflow_base));
+}
@@ -0,0 +1,53 @@
+/*
+ * ================================================================================
+ * TELEMETRIA BINÁRIA PELA USB
+ * ================================================================================
+ *
+ * Descrição: Envia cada amostra adquirida ao computador em quadros 'T' do
+ *            protocolo de xfer.h, na taxa completa de aquisição e em paralelo
+ *            com a gravação no SD. O consumidor do buffer de aquisição apenas
+ *            copia a amostra para um buffer circular; o laço principal
+ *            (núcleo 0) envia o que couber no buffer da USB sem bloquear.
+ *            Quadros que não cabem são descartados e aparecem como lacunas
+ *            no número da amostra (ArquivosDados/PlotaAoVivo.py).
+ * ================================================================================
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acquisition.h"
+
+// Amostras aguardando envio (potência de 2): ~256 ms a 1 kHz
+#ifndef TLM_RING_SIZE
+#define TLM_RING_SIZE 256
+#endif
+
+// Amostras por aviso ao laço principal
+#ifndef TLM_BATCH
+#define TLM_BATCH 8
+#endif
+
+/**
+ * Dados de um quadro de telemetria (18 bytes); o número da amostra vai no
+ * campo offset do cabeçalho do quadro
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t t_us;              // Instante da leitura (time_us_32)
+    int16_t  accel[3];          // Aceleração bruta [x, y, z]
+    int16_t  gyro[3];           // Velocidade angular bruta [x, y, z]
+    int16_t  temp;              // Temperatura bruta
+} tlm_payload_t;
+
+_Static_assert(sizeof(tlm_payload_t) == 18, "quadro de telemetria deve ter 18 bytes");
+
+void tlm_set_enabled(bool on);
+bool tlm_is_enabled(void);
+void tlm_push(const mpu_sample_t *s);
+void tlm_service(void);
+void tlm_print_stats(void);
+
+#endif // TELEMETRY_H
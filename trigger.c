@@ -0,0 +1,168 @@
+/*
+ * ================================================================================
+ * CAPTURA DISPARADA POR LIMIAR (PRÉ/PÓS-GATILHO)
+ * ================================================================================
+ *
+ * O teste de gatilho usa só inteiros: |a|² é comparado com os quadrados dos
+ * limites (1 g ± limiar), sem raiz quadrada. Um novo disparo durante o
+ * pós-gatilho estende o evento, até max_len amostras.
+ * ================================================================================
+ */
+
+#include "trigger.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mpu_log.h"
+
+/**
+ * Configura os tempos e limiares e arma o gatilho
+ * @param accel_g Desvio de |a| em relação a 1 g que dispara o evento
+ * @param gyro_dps Velocidade angular, em qualquer eixo, que dispara o evento
+ * @param accel_lsb_per_g, gyro_lsb_per_dps Escalas da faixa do sensor (mpu6050_t)
+ */
+void trg_init(trg_t *t, uint32_t rate_hz, uint32_t pre_ms, uint32_t post_ms,
+              uint32_t max_ms, float accel_g, float gyro_dps,
+              float accel_lsb_per_g, float gyro_lsb_per_dps) {
+    t->pre_len = (uint32_t)((uint64_t)pre_ms * rate_hz / 1000);
+    if (t->pre_len > TRG_PRE_MAX_SAMPLES) {
+        printf("[AVISO] Pré-gatilho limitado a %u amostras\n", TRG_PRE_MAX_SAMPLES);
+        t->pre_len = TRG_PRE_MAX_SAMPLES;
+    }
+    t->post_len = (uint32_t)((uint64_t)post_ms * rate_hz / 1000);
+    if (!t->post_len) t->post_len = 1;
+    t->max_len = (uint32_t)((uint64_t)max_ms * rate_hz / 1000);
+    if (t->max_len < t->pre_len + t->post_len) t->max_len = t->pre_len + t->post_len;
+
+    t->accel_lsb_per_g = accel_lsb_per_g;
+    t->gyro_lsb_per_dps = gyro_lsb_per_dps;
+    float lo = (1.0f - accel_g) * accel_lsb_per_g;
+    float hi = (1.0f + accel_g) * accel_lsb_per_g;
+    t->accel_lo2 = lo > 0.0f ? (uint32_t)(lo * lo) : 0;
+    t->accel_hi2 = (uint32_t)fminf(hi * hi, 4294967295.0f);
+    t->gyro_lsb = (int32_t)(gyro_dps * gyro_lsb_per_dps);
+
+    t->events = 0;
+    trg_stats_reset(&t->stats);
+    trg_rearm(t);
+}
+
+/**
+ * Encerra qualquer evento em andamento e esvazia o pré-gatilho
+ */
+void trg_rearm(trg_t *t) {
+    t->recording = false;
+    t->pre_head = 0;
+    t->pre_count = 0;
+    t->post_left = 0;
+    t->event_len = 0;
+}
+
+static void stats_update(trg_stats_t *st, const mpu_sample_t *s) {
+    const int16_t *v[2] = {s->accel, s->gyro};
+    for (int i = 0; i < 6; i++) {
+        int16_t x = v[i / 3][i % 3];
+        if (x < st->min[i]) st->min[i] = x;
+        if (x > st->max[i]) st->max[i] = x;
+        st->sum_sq[i] += (int32_t)x * x;
+    }
+    st->count++;
+}
+
+static bool triggered(const trg_t *t, const mpu_sample_t *s) {
+    uint32_t a2 = 0;
+    for (int i = 0; i < 3; i++)
+        a2 += (uint32_t)((int32_t)s->accel[i] * s->accel[i]);
+    if (a2 < t->accel_lo2 || a2 > t->accel_hi2)
+        return true;
+    for (int i = 0; i < 3; i++) {
+        int32_t g = s->gyro[i];
+        if (g > t->gyro_lsb || g < -t->gyro_lsb)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Processa uma amostra; O(1)
+ * No TRG_START o chamador deve esvaziar o pré-gatilho (trg_pop_pre) antes de
+ * gravar a própria amostra.
+ */
+trg_result_t trg_push(trg_t *t, const mpu_sample_t *s) {
+    stats_update(&t->stats, s);
+    bool hit = triggered(t, s);
+
+    if (!t->recording) {
+        if (hit) {
+            t->recording = true;
+            t->post_left = t->post_len;
+            t->event_len = t->pre_count + 1;
+            t->events++;
+            return TRG_START;
+        }
+        if (t->pre_len) {
+            t->pre[t->pre_head] = *s;
+            t->pre_head = (t->pre_head + 1) % t->pre_len;
+            if (t->pre_count < t->pre_len) t->pre_count++;
+        }
+        return TRG_IDLE;
+    }
+
+    t->event_len++;
+    if (hit)
+        t->post_left = t->post_len;
+    if (--t->post_left == 0 || t->event_len >= t->max_len) {
+        trg_rearm(t);
+        return TRG_LAST;
+    }
+    return TRG_RECORD;
+}
+
+/**
+ * Amostra mais antiga do pré-gatilho (NULL se vazio)
+ */
+const mpu_sample_t *trg_oldest_pre(const trg_t *t) {
+    if (!t->pre_count)
+        return NULL;
+    return &t->pre[(t->pre_head + t->pre_len - t->pre_count) % t->pre_len];
+}
+
+/**
+ * Retira o pré-gatilho em ordem cronológica
+ * @return false quando não há mais amostras
+ */
+bool trg_pop_pre(trg_t *t, mpu_sample_t *s) {
+    const mpu_sample_t *oldest = trg_oldest_pre(t);
+    if (!oldest)
+        return false;
+    *s = *oldest;
+    t->pre_count--;
+    return true;
+}
+
+void trg_stats_reset(trg_stats_t *st) {
+    for (int i = 0; i < 6; i++) {
+        st->min[i] = INT16_MAX;
+        st->max[i] = INT16_MIN;
+        st->sum_sq[i] = 0;
+    }
+    st->count = 0;
+}
+
+/**
+ * Exibe mínimo, máximo e RMS por eixo em unidades físicas
+ */
+void trg_stats_print(const trg_t *t) {
+    const trg_stats_t *st = &t->stats;
+    if (!st->count)
+        return;
+    static const char *nomes[6] = {"Ax", "Ay", "Az", "Gx", "Gy", "Gz"};
+    for (int i = 0; i < 6; i++) {
+        float k = i < 3 ? 1.0f / t->accel_lsb_per_g : 1.0f / t->gyro_lsb_per_dps;
+        float rms = sqrtf((float)st->sum_sq[i] / st->count) * k;
+        printf("  %s: min=%8.3f max=%8.3f rms=%8.3f %s\n", nomes[i],
+               st->min[i] * k, st->max[i] * k, rms, i < 3 ? "g" : "°/s");
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * ================================================================================
+ * CAPTURA DISPARADA POR LIMIAR (PRÉ/PÓS-GATILHO)
+ * ================================================================================
+ *
+ * Descrição: Mantém as amostras mais recentes num buffer de pré-gatilho em RAM
+ *            e estatísticas contínuas (mínimo, máximo e RMS por eixo). Quando
+ *            o módulo da aceleração se afasta de 1 g ou algum eixo do
+ *            giroscópio passa do limiar, o evento compreende o pré-gatilho
+ *            e as amostras seguintes até o fim do pós-gatilho.
+ * ================================================================================
+ */
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acquisition.h"
+
+// Capacidade do buffer de pré-gatilho (sizeof(mpu_sample_t) bytes por amostra)
+#ifndef TRG_PRE_MAX_SAMPLES
+#define TRG_PRE_MAX_SAMPLES 1024
+#endif
+
+/**
+ * Estatísticas por eixo desde o último trg_stats_reset
+ * Índices 0..2: acelerômetro X/Y/Z; 3..5: giroscópio X/Y/Z (valores brutos)
+ */
+typedef struct {
+    int16_t min[6];
+    int16_t max[6];
+    int64_t sum_sq[6];
+    uint32_t count;
+} trg_stats_t;
+
+/**
+ * Resultado de trg_push para a amostra entregue
+ */
+typedef enum {
+    TRG_IDLE,              // Armado, amostra guardada no pré-gatilho
+    TRG_START,             // Gatilho: gravar o pré-gatilho e depois a amostra
+    TRG_RECORD,            // Durante o evento: gravar a amostra
+    TRG_LAST               // Última amostra do evento: gravar e fechar
+} trg_result_t;
+
+typedef struct {
+    mpu_sample_t pre[TRG_PRE_MAX_SAMPLES];     // Buffer circular de pré-gatilho
+    uint32_t pre_head;                         // Próxima posição de escrita
+    uint32_t pre_count;                        // Amostras válidas no buffer
+    uint32_t pre_len;                          // Amostras de pré-gatilho
+    uint32_t post_len;                         // Amostras após o último disparo
+    uint32_t max_len;                          // Limite de amostras por evento
+    uint32_t post_left;                        // Restantes no evento atual
+    uint32_t event_len;                        // Amostras do evento atual
+    bool recording;
+    uint32_t accel_lo2, accel_hi2;             // Faixa aceita de |a|², em LSB²
+    int32_t gyro_lsb;                          // Limiar do giroscópio, em LSB
+    float accel_lsb_per_g;                     // Escalas da faixa em uso, para o resumo
+    float gyro_lsb_per_dps;
+    uint32_t events;                           // Eventos disparados
+    trg_stats_t stats;
+} trg_t;
+
+void trg_init(trg_t *t, uint32_t rate_hz, uint32_t pre_ms, uint32_t post_ms,
+              uint32_t max_ms, float accel_g, float gyro_dps,
+              float accel_lsb_per_g, float gyro_lsb_per_dps);
+void trg_rearm(trg_t *t);
+trg_result_t trg_push(trg_t *t, const mpu_sample_t *s);
+bool trg_pop_pre(trg_t *t, mpu_sample_t *s);
+const mpu_sample_t *trg_oldest_pre(const trg_t *t);
+
+void trg_stats_reset(trg_stats_t *st);
+void trg_stats_print(const trg_t *t);
+
+#endif // TRIGGER_H
@@ -0,0 +1,34 @@
+/*
+ * ================================================================================
+ * CONFIGURAÇÃO DO TINYUSB
+ * ================================================================================
+ *
+ * Descrição: Dispositivo composto: CDC para o stdio do SDK (terminal) e
+ *            armazenamento em massa (MSC) para expor o cartão SD ao
+ *            computador (usb_msc.h). Os descritores ficam em usb_descriptors.c.
+ * ================================================================================
+ */
+
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+#define CFG_TUSB_RHPORT0_MODE   OPT_MODE_DEVICE
+#define CFG_TUSB_OS             OPT_OS_PICO
+
+#define CFG_TUD_ENDPOINT0_SIZE  64
+
+// Classes usadas
+#define CFG_TUD_CDC             1
+#define CFG_TUD_MSC             1
+#define CFG_TUD_HID             0
+#define CFG_TUD_MIDI            0
+#define CFG_TUD_VENDOR          0
+
+// Mesmos buffers do stdio USB padrão do SDK
+#define CFG_TUD_CDC_RX_BUFSIZE  256
+#define CFG_TUD_CDC_TX_BUFSIZE  256
+
+// Bytes por chamada de leitura/escrita do MSC: 8 setores por comando ao SD
+#define CFG_TUD_MSC_EP_BUFSIZE  4096
+
+#endif // TUSB_CONFIG_H
@@ -0,0 +1,115 @@
+/*
+ * ================================================================================
+ * DESCRITORES USB (CDC + MSC)
+ * ================================================================================
+ *
+ * Descrição: Substituem os descritores padrão do stdio USB do SDK, que só
+ *            declaram a porta serial. O VID/PID segue a convenção dos
+ *            exemplos do TinyUSB; um produto deve usar um par próprio.
+ * ================================================================================
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/unique_id.h"
+#include "tusb.h"
+
+#define USBD_VID 0xCafe
+#define USBD_PID (0x4000 | (1 << 0) | (1 << 1))    // CDC + MSC
+
+enum {
+    ITF_NUM_CDC = 0,
+    ITF_NUM_CDC_DATA,
+    ITF_NUM_MSC,
+    ITF_NUM_TOTAL
+};
+
+#define EPNUM_CDC_NOTIF 0x81
+#define EPNUM_CDC_OUT   0x02
+#define EPNUM_CDC_IN    0x82
+#define EPNUM_MSC_OUT   0x03
+#define EPNUM_MSC_IN    0x83
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN)
+
+enum {
+    STRID_LANGID = 0,
+    STRID_MANUFACTURER,
+    STRID_PRODUCT,
+    STRID_SERIAL,
+    STRID_CDC,
+    STRID_MSC,
+};
+
+static const tusb_desc_device_t desc_device = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // Classe composta com IAD, exigida pelo CDC
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USBD_VID,
+    .idProduct = USBD_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = STRID_MANUFACTURER,
+    .iProduct = STRID_PRODUCT,
+    .iSerialNumber = STRID_SERIAL,
+    .bNumConfigurations = 1,
+};
+
+static const uint8_t desc_configuration[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 250),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, STRID_CDC, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, 64),
+    TUD_MSC_DESCRIPTOR(ITF_NUM_MSC, STRID_MSC, EPNUM_MSC_OUT, EPNUM_MSC_IN, 64),
+};
+
+static const char *const desc_strings[] = {
+    [STRID_MANUFACTURER] = "BitDogLab",
+    [STRID_PRODUCT] = "MPU6050 Data Logger",
+    [STRID_CDC] = "Terminal",
+    [STRID_MSC] = "Cartao SD",
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&desc_device;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_configuration;
+}
+
+/**
+ * Strings em UTF-16; o número de série é o ID único da flash
+ */
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+    static uint16_t desc_str[1 + 32];
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *str;
+    uint8_t len;
+
+    if (index == STRID_LANGID) {
+        desc_str[1] = 0x0409;   // Inglês (EUA)
+        len = 1;
+    } else {
+        if (index == STRID_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof serial);
+            str = serial;
+        } else if (index < count_of(desc_strings) && desc_strings[index]) {
+            str = desc_strings[index];
+        } else {
+            return NULL;
+        }
+        len = (uint8_t)strlen(str);
+        if (len > 32)
+            len = 32;
+        for (uint8_t i = 0; i < len; i++)
+            desc_str[1 + i] = (uint8_t)str[i];
+    }
+    desc_str[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * len + 2));
+    return desc_str;
+}
@@ -0,0 +1,142 @@
+/*
+ * ================================================================================
+ * MODO USB MASS STORAGE
+ * ================================================================================
+ *
+ * Os callbacks do TinyUSB rodam na tarefa de fundo do stdio USB (interrupção
+ * de menor prioridade), por isso o acesso ao cartão é feito ali mesmo: a
+ * interrupção do DMA do SPI tem prioridade maior e conclui as transferências.
+ * Enquanto o modo está ativo o laço principal não toca no cartão.
+ * ================================================================================
+ */
+
+#include "usb_msc.h"
+
+#include <string.h>
+
+#include "tusb.h"
+
+#define MSC_BLOCK_SIZE 512
+
+static sd_card_t *volatile msc_sd;           // Cartão exportado (NULL: sem mídia)
+static volatile bool msc_changed;            // Avisar troca de mídia ao computador
+static volatile bool msc_ejected;            // Computador ejetou o disco
+
+/**
+ * Passa o cartão ao computador; o cartão já deve estar inicializado e o
+ * FatFs desmontado
+ */
+void msc_attach(sd_card_t *sd) {
+    msc_ejected = false;
+    msc_changed = true;
+    msc_sd = sd;
+}
+
+/**
+ * Retira o cartão do computador; não interrompe uma transferência em curso
+ * porque as escritas de sd_write_blocks() terminam antes de retornar
+ */
+void msc_detach(void) {
+    msc_sd = NULL;
+    msc_changed = true;
+}
+
+bool msc_is_active(void) {
+    return msc_sd != NULL;
+}
+
+/**
+ * @return true uma única vez depois que o computador ejetou o disco
+ */
+bool msc_take_eject(void) {
+    if (!msc_ejected)
+        return false;
+    msc_ejected = false;
+    return true;
+}
+
+// ================================================================================
+// CALLBACKS DO TINYUSB
+// ================================================================================
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16],
+                        uint8_t product_rev[4]) {
+    (void)lun;
+    memcpy(vendor_id, "BitDog  ", 8);
+    memcpy(product_id, "MPU Data Logger ", 16);
+    memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+    if (!msc_sd) {
+        tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);   // Mídia ausente
+        msc_changed = false;
+        return false;
+    }
+    if (msc_changed) {
+        tud_msc_set_sense(lun, SCSI_SENSE_UNIT_ATTENTION, 0x28, 0x00);  // Mídia trocada
+        msc_changed = false;
+        return false;
+    }
+    return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t *block_count, uint16_t *block_size) {
+    (void)lun;
+    sd_card_t *sd = msc_sd;
+    *block_count = sd ? (uint32_t)sd_sectors(sd) : 0;
+    *block_size = MSC_BLOCK_SIZE;
+}
+
+bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject) {
+    (void)lun;
+    (void)power_condition;
+    if (load_eject && !start && msc_sd) {
+        msc_detach();
+        msc_ejected = true;
+    }
+    return true;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer,
+                          uint32_t bufsize) {
+    (void)lun;
+    sd_card_t *sd = msc_sd;
+    if (!sd)
+        return -1;
+    if (sd_read_blocks(sd, buffer, lba + offset / MSC_BLOCK_SIZE, bufsize / MSC_BLOCK_SIZE) !=
+        SD_BLOCK_DEVICE_ERROR_NONE) {
+        tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x11, 0x00);    // Erro de leitura
+        return -1;
+    }
+    return (int32_t)bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer,
+                           uint32_t bufsize) {
+    (void)lun;
+    sd_card_t *sd = msc_sd;
+    if (!sd)
+        return -1;
+    if (sd_write_blocks(sd, buffer, lba + offset / MSC_BLOCK_SIZE, bufsize / MSC_BLOCK_SIZE) !=
+        SD_BLOCK_DEVICE_ERROR_NONE) {
+        tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00);    // Erro de escrita
+        return -1;
+    }
+    return (int32_t)bufsize;
+}
+
+/**
+ * Comandos SCSI não tratados pelo TinyUSB
+ */
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void *buffer, uint16_t bufsize) {
+    (void)buffer;
+    (void)bufsize;
+    switch (scsi_cmd[0]) {
+        case 0x1E:  // PREVENT ALLOW MEDIUM REMOVAL: aceito, o cartão é só lógico
+            return 0;
+        default:
+            tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+            return -1;
+    }
+}
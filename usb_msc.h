@@ -0,0 +1,26 @@
+/*
+ * ================================================================================
+ * MODO USB MASS STORAGE
+ * ================================================================================
+ *
+ * Descrição: Expõe o cartão SD ao computador como um disco removível, com as
+ *            leituras e escritas SCSI levadas direto a sd_read_blocks() e
+ *            sd_write_blocks(). Fora do modo o disco aparece sem mídia; o
+ *            FatFs precisa estar desmontado enquanto o modo estiver ativo,
+ *            pois o computador altera o sistema de arquivos por conta própria.
+ * ================================================================================
+ */
+
+#ifndef USB_MSC_H
+#define USB_MSC_H
+
+#include <stdbool.h>
+
+#include "sd_card.h"
+
+void msc_attach(sd_card_t *sd);
+void msc_detach(void);
+bool msc_is_active(void);
+bool msc_take_eject(void);
+
+#endif // USB_MSC_H
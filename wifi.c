@@ -0,0 +1,420 @@
+/*
+ * ================================================================================
+ * WI-FI (PICO W): TERMINAL REMOTO E ENVIO DE AMOSTRAS POR UDP
+ * ================================================================================
+ *
+ * Usa o pico_cyw43_arch_lwip_threadsafe_background: os callbacks do lwIP rodam
+ * em interrupção no núcleo 0 e as chamadas feitas pelo laço principal ficam
+ * entre cyw43_arch_lwip_begin/end. Nada aqui chama o lwIP a partir do
+ * núcleo 1 ou de dentro do printf: a saída do terminal e as amostras passam
+ * por buffers circulares esvaziados em wifi_poll().
+ * ================================================================================
+ */
+
+#include "wifi.h"
+
+#if USE_WIFI
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/stdio/driver.h"
+#include "pico/unique_id.h"
+#include "hardware/sync.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+
+#include "events.h"
+#include "telemetry.h"
+
+// Buffers do terminal remoto (potências de 2)
+#define CONSOLE_RX_SIZE 256
+#define CONSOLE_TX_SIZE 2048
+
+// Nova tentativa de conexão após falha
+#define WIFI_RETRY_MS 10000
+
+_Static_assert((WIFI_RING_SIZE & (WIFI_RING_SIZE - 1)) == 0, "WIFI_RING_SIZE deve ser potência de 2");
+_Static_assert(WIFI_BATCH <= 255, "WIFI_BATCH deve caber no campo count");
+
+static bool wifi_ok = false;                   // CYW43 iniciado
+static bool link_up = false;                   // Endereço IP obtido
+static uint32_t rate_hz;                       // Taxa informada nos pacotes
+static uint32_t unit_id;
+static absolute_time_t next_check;             // Próxima verificação do enlace
+static absolute_time_t next_retry;
+
+// Terminal TCP (um cliente por vez)
+static struct tcp_pcb *console_client = NULL;
+static uint8_t rx_buf[CONSOLE_RX_SIZE];
+static volatile uint32_t rx_head = 0, rx_tail = 0;
+static uint8_t tx_buf[CONSOLE_TX_SIZE];
+static volatile uint32_t tx_head = 0, tx_tail = 0;
+static uint32_t tx_dropped = 0;
+
+// Envio das amostras por UDP
+static struct udp_pcb *stream_pcb = NULL;
+static ip_addr_t sub_addr;                     // Coletor inscrito
+static u16_t sub_port;
+static volatile bool subscribed = false;
+static volatile bool resync = false;           // Descartar amostras antigas
+static absolute_time_t sub_deadline;
+static absolute_time_t partial_deadline;       // Envio de pacote incompleto
+static mpu_sample_t ring[WIFI_RING_SIZE];
+static volatile uint32_t s_head = 0, s_tail = 0;
+static volatile uint32_t s_dropped = 0;
+static uint32_t pkts_sent = 0, pkt_errors = 0;
+
+// ================================================================================
+// TERMINAL REMOTO: DRIVER DO STDIO
+// ================================================================================
+
+/**
+ * Saída do printf: apenas copia para o buffer (o stdio já serializa as
+ * chamadas dos dois núcleos); o envio é feito em wifi_poll()
+ */
+static void console_out_chars(const char *buf, int len) {
+    if (!console_client)
+        return;
+    for (int i = 0; i < len; i++) {
+        uint32_t h = tx_head;
+        if (h - tx_tail >= CONSOLE_TX_SIZE) {
+            tx_dropped += len - i;
+            break;
+        }
+        tx_buf[h & (CONSOLE_TX_SIZE - 1)] = buf[i];
+        __dmb();
+        tx_head = h + 1;
+    }
+    evt_post(EVT_NET, 0);
+}
+
+static int console_in_chars(char *buf, int len) {
+    int n = 0;
+    while (n < len && rx_tail != rx_head) {
+        buf[n++] = rx_buf[rx_tail & (CONSOLE_RX_SIZE - 1)];
+        rx_tail++;
+    }
+    return n ? n : PICO_ERROR_NO_DATA;
+}
+
+static stdio_driver_t console_driver = {
+    .out_chars = console_out_chars,
+    .in_chars = console_in_chars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+static void console_close(struct tcp_pcb *pcb) {
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK)
+        tcp_abort(pcb);
+    console_client = NULL;
+}
+
+static err_t console_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    (void)arg;
+    (void)err;
+    if (!p) {                                   // Cliente encerrou
+        console_close(pcb);
+        return ERR_OK;
+    }
+    for (struct pbuf *q = p; q; q = q->next) {
+        const uint8_t *d = q->payload;
+        for (u16_t i = 0; i < q->len; i++) {
+            if (rx_head - rx_tail >= CONSOLE_RX_SIZE)
+                break;                          // Terminal não acompanha: descarta
+            rx_buf[rx_head & (CONSOLE_RX_SIZE - 1)] = d[i];
+            __dmb();
+            rx_head++;
+        }
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    evt_post(EVT_RX, 0);
+    return ERR_OK;
+}
+
+static void console_err(void *arg, err_t err) {
+    (void)arg;
+    (void)err;
+    console_client = NULL;                      // O lwIP já liberou o pcb
+}
+
+static err_t console_accept(void *arg, struct tcp_pcb *pcb, err_t err) {
+    (void)arg;
+    if (err != ERR_OK || !pcb)
+        return ERR_VAL;
+    if (console_client) {                       // Já há um terminal remoto
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    rx_tail = rx_head;
+    tx_tail = tx_head;
+    console_client = pcb;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, console_recv);
+    tcp_err(pcb, console_err);
+    static const char msg[] = "\r\nTerminal remoto do Data Logger (g = help)\r\n> ";
+    tcp_write(pcb, msg, sizeof msg - 1, 0);
+    tcp_output(pcb);
+    return ERR_OK;
+}
+
+/**
+ * Envia ao cliente o que couber no buffer de envio do TCP
+ */
+static void console_flush(void) {
+    if (!console_client) {
+        tx_tail = tx_head;
+        return;
+    }
+    bool wrote = false;
+    for (int part = 0; part < 2; part++) {      // Duas partes se der a volta
+        uint32_t n = tx_head - tx_tail;
+        uint32_t ofs = tx_tail & (CONSOLE_TX_SIZE - 1);
+        if (n > CONSOLE_TX_SIZE - ofs)
+            n = CONSOLE_TX_SIZE - ofs;
+        if (n > tcp_sndbuf(console_client))
+            n = tcp_sndbuf(console_client);
+        if (!n || tcp_write(console_client, &tx_buf[ofs], (u16_t)n, TCP_WRITE_FLAG_COPY) != ERR_OK)
+            break;
+        tx_tail += n;
+        wrote = true;
+    }
+    if (wrote)
+        tcp_output(console_client);
+}
+
+// ================================================================================
+// AMOSTRAS POR UDP
+// ================================================================================
+
+/**
+ * Inscrição de um coletor: qualquer datagrama renova; "stop" encerra
+ */
+static void stream_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                        const ip_addr_t *addr, u16_t port) {
+    (void)arg;
+    (void)pcb;
+    bool stop = p->len >= 4 && 0 == memcmp(p->payload, "stop", 4);
+    pbuf_free(p);
+    if (stop) {
+        subscribed = false;
+        return;
+    }
+    if (!subscribed || !ip_addr_cmp(&sub_addr, addr) || sub_port != port)
+        resync = true;
+    ip_addr_copy(sub_addr, *addr);
+    sub_port = port;
+    sub_deadline = make_timeout_time_ms(WIFI_SUBSCRIBE_TIMEOUT_MS);
+    subscribed = true;
+}
+
+/**
+ * Monta e envia um pacote com as próximas n amostras do buffer
+ */
+static void stream_send(uint32_t n) {
+    uint16_t size = sizeof(wifi_pkt_header_t) + n * sizeof(tlm_payload_t);
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, size, PBUF_RAM);
+    if (p) {
+        uint8_t *d = p->payload;
+        wifi_pkt_header_t h = {
+            .magic = WIFI_PKT_MAGIC,
+            .version = WIFI_PKT_VERSION,
+            .count = (uint8_t)n,
+            .sample_size = sizeof(tlm_payload_t),
+            .unit_id = unit_id,
+            .first_seq = ring[s_tail & (WIFI_RING_SIZE - 1)].seq,
+            .sample_rate_hz = rate_hz,
+        };
+        memcpy(d, &h, sizeof h);
+        d += sizeof h;
+        for (uint32_t i = 0; i < n; i++) {
+            const mpu_sample_t *s = &ring[(s_tail + i) & (WIFI_RING_SIZE - 1)];
+            tlm_payload_t t;
+            t.t_us = s->t_us;
+            memcpy(t.accel, s->accel, sizeof t.accel);
+            memcpy(t.gyro, s->gyro, sizeof t.gyro);
+            t.temp = s->temp;
+            memcpy(d, &t, sizeof t);
+            d += sizeof t;
+        }
+    }
+    __dmb();
+    s_tail += n;
+    if (p && udp_sendto(stream_pcb, p, &sub_addr, sub_port) == ERR_OK)
+        pkts_sent++;
+    else
+        pkt_errors++;
+    if (p)
+        pbuf_free(p);
+}
+
+/**
+ * Conta as amostras com números consecutivos a partir de s_tail, até max
+ * Descartes aqui (anel cheio) ou na aquisição (overrun) abrem lacunas na
+ * sequência, e o coletor só conhece first_seq de cada pacote
+ */
+static uint32_t stream_run(uint32_t max) {
+    uint32_t seq = ring[s_tail & (WIFI_RING_SIZE - 1)].seq;
+    uint32_t i = 1;
+    while (i < max && ring[(s_tail + i) & (WIFI_RING_SIZE - 1)].seq == seq + i)
+        i++;
+    return i;
+}
+
+/**
+ * Envia os pacotes completos e, vencido o prazo, o incompleto
+ * Um pacote termina antes de WIFI_BATCH na primeira lacuna da sequência
+ */
+static void stream_flush(void) {
+    if (resync) {
+        resync = false;
+        s_tail = s_head;
+    }
+    if (!subscribed || !link_up)
+        return;
+    uint32_t n;
+    while ((n = s_head - s_tail) > 0) {
+        uint32_t m = stream_run(n < WIFI_BATCH ? n : WIFI_BATCH);
+        if (m < WIFI_BATCH && m == n)
+            break;      // Parcial sem lacuna: espera o prazo
+        stream_send(m);
+    }
+    if (time_reached(partial_deadline)) {
+        if (n)
+            stream_send(n);
+        partial_deadline = make_timeout_time_ms(WIFI_FLUSH_MS);
+    }
+}
+
+// ================================================================================
+// INTERFACE DO MÓDULO
+// ================================================================================
+
+/**
+ * Liga o rádio, inicia a conexão (sem esperar) e abre as portas
+ * @return false se o CYW43 não iniciou
+ */
+bool wifi_init(void) {
+    pico_unique_board_id_t id;
+    pico_get_unique_board_id(&id);
+    memcpy(&unit_id, &id.id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES - 4], sizeof unit_id);
+
+    if (cyw43_arch_init()) {
+        printf("[ERRO] Wi-Fi: falha ao iniciar o CYW43\n");
+        return false;
+    }
+    cyw43_arch_enable_sta_mode();
+    if (cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK))
+        printf("[AVISO] Wi-Fi: não foi possível iniciar a conexão a \"%s\"\n", WIFI_SSID);
+    next_retry = make_timeout_time_ms(WIFI_RETRY_MS);
+
+    cyw43_arch_lwip_begin();
+    struct tcp_pcb *listen = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (listen && tcp_bind(listen, IP_ANY_TYPE, WIFI_CONSOLE_PORT) == ERR_OK) {
+        listen = tcp_listen_with_backlog(listen, 1);
+        tcp_accept(listen, console_accept);
+    } else {
+        printf("[AVISO] Wi-Fi: terminal remoto indisponível\n");
+    }
+    stream_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (stream_pcb && udp_bind(stream_pcb, IP_ANY_TYPE, WIFI_STREAM_PORT) == ERR_OK)
+        udp_recv(stream_pcb, stream_recv, NULL);
+    else
+        printf("[AVISO] Wi-Fi: envio de amostras indisponível\n");
+    cyw43_arch_lwip_end();
+
+    stdio_set_driver_enabled(&console_driver, true);
+    wifi_ok = true;
+    printf("Wi-Fi: conectando a \"%s\"...\n", WIFI_SSID);
+    return true;
+}
+
+/**
+ * Taxa de aquisição informada no cabeçalho dos pacotes; chamar a cada
+ * (re)início da amostragem
+ */
+void wifi_set_sample_rate(uint32_t sample_rate_hz) {
+    rate_hz = sample_rate_hz;
+}
+
+/**
+ * Trabalho do laço principal: estado do enlace, terminal e pacotes
+ */
+void wifi_poll(void) {
+    if (!wifi_ok)
+        return;
+
+    if (time_reached(next_check)) {
+        next_check = make_timeout_time_ms(1000);
+        int st = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        bool up = (st == CYW43_LINK_UP);
+        if (up && !link_up) {
+            printf("Wi-Fi conectado: %s (terminal TCP %d, amostras UDP %d)\n",
+                   ip4addr_ntoa(netif_ip4_addr(netif_list)), WIFI_CONSOLE_PORT, WIFI_STREAM_PORT);
+        } else if (!up && link_up) {
+            printf("[AVISO] Wi-Fi desconectado\n");
+        }
+        link_up = up;
+        if (!up && st <= 0 && time_reached(next_retry)) {
+            // Falha, senha errada ou rede ausente: tenta de novo
+            next_retry = make_timeout_time_ms(WIFI_RETRY_MS);
+            cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK);
+        }
+        if (subscribed && time_reached(sub_deadline)) {
+            subscribed = false;
+            printf("[AVISO] Wi-Fi: coletor sem resposta, envio de amostras encerrado\n");
+        }
+    }
+
+    cyw43_arch_lwip_begin();
+    console_flush();
+    stream_flush();
+    cyw43_arch_lwip_end();
+}
+
+/**
+ * Enfileira uma amostra para o coletor (chamada pelo consumidor da aquisição)
+ */
+void wifi_push(const mpu_sample_t *s) {
+    if (!subscribed)
+        return;
+    uint32_t h = s_head;
+    if (h - s_tail >= WIFI_RING_SIZE) {
+        s_dropped++;
+        return;
+    }
+    ring[h & (WIFI_RING_SIZE - 1)] = *s;
+    __dmb();
+    s_head = h + 1;
+    if ((h + 1) % WIFI_BATCH == 0)
+        evt_post(EVT_NET, 0);
+}
+
+void wifi_print_status(void) {
+    if (!wifi_ok) {
+        printf("Wi-Fi desligado\n");
+        return;
+    }
+    if (link_up)
+        printf("Wi-Fi: %s, IP %s, unidade %08lx\n", WIFI_SSID,
+               ip4addr_ntoa(netif_ip4_addr(netif_list)), (unsigned long)unit_id);
+    else
+        printf("Wi-Fi: %s, sem conexão\n", WIFI_SSID);
+    printf("Terminal remoto: %s (%lu bytes descartados)\n",
+           console_client ? "conectado" : "livre", (unsigned long)tx_dropped);
+    if (subscribed)
+        printf("Coletor: %s:%u\n", ipaddr_ntoa(&sub_addr), sub_port);
+    printf("Pacotes UDP: %lu enviados, %lu falhas, %lu amostras descartadas\n",
+           (unsigned long)pkts_sent, (unsigned long)pkt_errors, (unsigned long)s_dropped);
+}
+
+#endif // USE_WIFI
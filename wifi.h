@@ -0,0 +1,79 @@
+/*
+ * ================================================================================
+ * WI-FI (PICO W): TERMINAL REMOTO E ENVIO DE AMOSTRAS POR UDP
+ * ================================================================================
+ *
+ * Descrição: Conecta à rede configurada na compilação (cmake -DWIFI_SSID=...
+ *            -DWIFI_PASSWORD=...) e oferece:
+ *            - um terminal TCP na porta WIFI_CONSOLE_PORT, registrado como
+ *              driver do stdio: os mesmos comandos e teclas do terminal USB,
+ *              com a mesma saída do printf;
+ *            - envio das amostras por UDP em pacotes do tamanho da MTU para
+ *              quem se inscrever com um datagrama na porta WIFI_STREAM_PORT
+ *              (ArquivosDados/ColetaWiFi.py), identificados pelo ID da placa
+ *              para coletar várias unidades ao mesmo tempo.
+ *            Sem WIFI_SSID o módulo fica vazio e o rádio desligado.
+ * ================================================================================
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "acquisition.h"
+
+#ifndef USE_WIFI
+#define USE_WIFI 0
+#endif
+
+#define WIFI_CONSOLE_PORT 4242
+#define WIFI_STREAM_PORT  4243
+
+// Amostras aguardando envio (potência de 2)
+#ifndef WIFI_RING_SIZE
+#define WIFI_RING_SIZE 512
+#endif
+
+// Amostras por pacote: 20 + 80 x 18 = 1460 bytes, cabe em um quadro Ethernet
+#ifndef WIFI_BATCH
+#define WIFI_BATCH 80
+#endif
+
+// Prazo máximo de uma amostra no buffer antes de sair num pacote parcial
+#ifndef WIFI_FLUSH_MS
+#define WIFI_FLUSH_MS 100
+#endif
+
+// Sem nova inscrição neste prazo o envio para o coletor é encerrado
+#ifndef WIFI_SUBSCRIBE_TIMEOUT_MS
+#define WIFI_SUBSCRIBE_TIMEOUT_MS 10000
+#endif
+
+#define WIFI_PKT_MAGIC   "MPUW"
+#define WIFI_PKT_VERSION 1
+
+/**
+ * Cabeçalho de cada pacote UDP de amostras (20 bytes, little-endian),
+ * seguido de `count` tlm_payload_t (telemetry.h)
+ */
+typedef struct __attribute__((packed)) {
+    char     magic[4];          // "MPUW"
+    uint8_t  version;           // WIFI_PKT_VERSION
+    uint8_t  count;             // Amostras no pacote
+    uint16_t sample_size;       // sizeof(tlm_payload_t)
+    uint32_t unit_id;           // Parte baixa do ID único da placa
+    uint32_t first_seq;         // Número da primeira amostra; as demais são consecutivas
+    uint32_t sample_rate_hz;    // Taxa de aquisição
+} wifi_pkt_header_t;
+
+_Static_assert(sizeof(wifi_pkt_header_t) == 20, "cabeçalho do pacote deve ter 20 bytes");
+
+bool wifi_init(void);
+void wifi_set_sample_rate(uint32_t sample_rate_hz);
+void wifi_poll(void);
+void wifi_push(const mpu_sample_t *s);
+void wifi_print_status(void);
+
+#endif // WIFI_H
@@ -0,0 +1,110 @@
+/*
+ * ================================================================================
+ * TRANSFERÊNCIA BINÁRIA DE ARQUIVOS PELA USB
+ * ================================================================================
+ *
+ * Os quadros entram no buffer do terminal (console_write) sem tradução de
+ * \n, na mesma ordem do printf, e o CRC é por tabela em RAM (~40 MB/s a
+ * 125 MHz), folgado diante dos ~1 MB/s da USB full-speed.
+ * ================================================================================
+ */
+
+#include "xfer.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+
+#include "console.h"
+
+static uint32_t crc_table[256];
+static uint8_t xfer_buf[XFER_BLOCK_SIZE] __attribute__((aligned(4)));
+static FIL xfer_fil;
+
+/**
+ * Atualiza um CRC-32 (polinômio refletido 0xEDB88320, igual a zlib.crc32)
+ * @param crc Valor anterior (0 no início)
+ */
+uint32_t xfer_crc32(uint32_t crc, const void *data, uint32_t len) {
+    if (!crc_table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--)
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/**
+ * Envia um quadro completo (bloqueia até caber no buffer do terminal)
+ */
+void xfer_send_frame(uint8_t type, uint32_t offset, const void *data, uint32_t len) {
+    xfer_frame_t h = {
+        .sync = {XFER_SYNC0, XFER_SYNC1},
+        .type = type,
+        .offset = offset,
+        .len = len,
+    };
+    uint32_t crc = xfer_crc32(0, &h, sizeof h);
+    crc = xfer_crc32(crc, data, len);
+    console_write(&h, sizeof h);
+    if (len)
+        console_write(data, len);
+    console_write(&crc, sizeof crc);
+}
+
+/**
+ * Envia o arquivo a partir do deslocamento informado
+ * O primeiro bloco vai só até o próximo limite de XFER_BLOCK_SIZE, para os
+ * seguintes ficarem alinhados aos setores do arquivo
+ * @return FR_OK também quando o computador cancela ou desconecta
+ */
+FRESULT xfer_send_file(const char *path, uint32_t offset) {
+    FRESULT fr = f_open(&xfer_fil, path, FA_READ);
+    if (fr == FR_OK && offset > f_size(&xfer_fil))
+        fr = FR_INVALID_PARAMETER;
+    if (fr == FR_OK)
+        fr = f_lseek(&xfer_fil, offset);
+    if (fr != FR_OK) {
+        uint32_t code = fr;
+        xfer_send_frame(XFER_FRAME_ERROR, offset, &code, sizeof code);
+        f_close(&xfer_fil);
+        return fr;
+    }
+
+    // Descarta o que o terminal ainda tiver do comando
+    while (getchar_timeout_us(0) != PICO_ERROR_TIMEOUT)
+        ;
+
+    uint32_t size = (uint32_t)f_size(&xfer_fil);
+    xfer_send_frame(XFER_FRAME_START, offset, &size, sizeof size);
+
+    while (offset < size) {
+        if (!stdio_usb_connected() || getchar_timeout_us(0) != PICO_ERROR_TIMEOUT) {
+            f_close(&xfer_fil);
+            return FR_OK;
+        }
+        UINT n = XFER_BLOCK_SIZE - offset % XFER_BLOCK_SIZE;
+        fr = f_read(&xfer_fil, xfer_buf, n, &n);
+        if (fr != FR_OK || n == 0) {
+            uint32_t code = fr != FR_OK ? fr : FR_INT_ERR;
+            xfer_send_frame(XFER_FRAME_ERROR, offset, &code, sizeof code);
+            f_close(&xfer_fil);
+            return fr != FR_OK ? fr : FR_INT_ERR;
+        }
+        xfer_send_frame(XFER_FRAME_DATA, offset, xfer_buf, n);
+        offset += n;
+    }
+
+    xfer_send_frame(XFER_FRAME_END, offset, NULL, 0);
+    console_flush(1000);
+    return f_close(&xfer_fil);
+}
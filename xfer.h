@@ -0,0 +1,65 @@
+/*
+ * ================================================================================
+ * TRANSFERÊNCIA BINÁRIA DE ARQUIVOS PELA USB
+ * ================================================================================
+ *
+ * Descrição: Envia um arquivo do cartão SD pelo stdio USB (CDC) em quadros
+ *            binários com comprimento e CRC-32, sem passar pelo printf.
+ *            Os blocos lidos são múltiplos de setor e alinhados no arquivo,
+ *            para o f_read ler direto do cartão para o buffer. A transferência
+ *            pode recomeçar de qualquer deslocamento; o script
+ *            ArquivosDados/BaixaArquivo.py faz o lado do computador.
+ *
+ * Quadro:    xfer_frame_t | dados[len] | CRC-32 (zlib) de cabeçalho + dados
+ *            'S' início  (offset inicial, dados = tamanho do arquivo, u32)
+ *            'D' dados   (offset do primeiro byte)
+ *            'E' fim     (offset final, sem dados)
+ *            'X' erro    (dados = FRESULT, u32)
+ *            'T' telemetria (offset = número da amostra, ver telemetry.h)
+ *            Qualquer caractere recebido durante o envio cancela a transferência.
+ * ================================================================================
+ */
+
+#ifndef XFER_H
+#define XFER_H
+
+#include <stdint.h>
+
+#include "ff.h"
+
+// Dados por quadro (múltiplo de 512 bytes)
+#ifndef XFER_BLOCK_SIZE
+#define XFER_BLOCK_SIZE 4096
+#endif
+
+#define XFER_SYNC0 0xA5
+#define XFER_SYNC1 0x5A
+
+#define XFER_FRAME_START 'S'
+#define XFER_FRAME_DATA  'D'
+#define XFER_FRAME_END   'E'
+#define XFER_FRAME_ERROR 'X'
+#define XFER_FRAME_TELEMETRY 'T'
+
+// Bytes que um quadro ocupa na USB além dos dados: cabeçalho + CRC
+#define XFER_FRAME_OVERHEAD (sizeof(xfer_frame_t) + 4)
+
+/**
+ * Cabeçalho de quadro (12 bytes, little-endian)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  sync[2];           // XFER_SYNC0, XFER_SYNC1
+    uint8_t  type;              // XFER_FRAME_*
+    uint8_t  reserved;
+    uint32_t offset;            // Posição no arquivo
+    uint32_t len;               // Bytes de dados após o cabeçalho
+} xfer_frame_t;
+
+_Static_assert(sizeof(xfer_frame_t) == 12, "cabeçalho de quadro deve ter 12 bytes");
+_Static_assert(XFER_BLOCK_SIZE % 512 == 0, "XFER_BLOCK_SIZE deve ser múltiplo do setor");
+
+uint32_t xfer_crc32(uint32_t crc, const void *data, uint32_t len);
+void xfer_send_frame(uint8_t type, uint32_t offset, const void *data, uint32_t len);
+FRESULT xfer_send_file(const char *path, uint32_t offset);
+
+#endif // XFER_H